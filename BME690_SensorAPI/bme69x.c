@@ -38,6 +38,7 @@
 
 #include "bme69x.h"
 #include <stdio.h>
+#include <string.h>
 
 /* This internal API is used to read the calibration coefficients */
 static int8_t get_calib_data(struct bme69x_dev *dev);
@@ -45,19 +46,81 @@ static int8_t get_calib_data(struct bme69x_dev *dev);
 /* This internal API is used to read variant ID information register status */
 static int8_t read_variant_id(struct bme69x_dev *dev);
 
+/* This internal API is used to serialise the calibration coefficients of a calibration snapshot */
+static void pack_calib(const struct bme69x_calib_data *calib, uint8_t *buff);
+
+/* This internal API is used to restore the calibration coefficients of a calibration snapshot */
+static void unpack_calib(const uint8_t *buff, struct bme69x_calib_data *calib);
+
+/* This internal API is used to calculate the CRC-16 of a calibration snapshot */
+static uint16_t calc_crc16(const uint8_t *data, uint8_t len);
+
+/* This internal API is used to get the heater resistance code of a temperature, from the lookup table when set */
+static uint8_t get_res_heat(uint16_t temp, const struct bme69x_dev *dev);
+
+/* This internal API is used to read the time base of a scheduler */
+static uint64_t sched_now(const struct bme69x_sched *sched);
+
+/* This internal API is used to schedule the next trigger of a sensor once its measurement is over */
+static void sched_next_period(struct bme69x_sched_sensor *sensor, uint64_t now);
+
+/* This internal API is used to calculate the step and cycle durations of an operation mode from the heater
+ * register values */
+static void calc_timing(uint8_t op_mode,
+                        struct bme69x_conf *conf,
+                        const uint8_t *gas_wait,
+                        uint8_t n_steps,
+                        uint8_t shd_heatr_dur,
+                        uint8_t gas_on,
+                        struct bme69x_timing *timing,
+                        struct bme69x_dev *dev);
+
+/* This internal API is used to calculate the standby time of an ODR setting in microseconds */
+static uint32_t calc_odr_standby(uint8_t odr);
+
+/* This internal API is used to get the datasheet time from the time base to the end of a step of a sequential
+ * profile */
+static uint64_t seq_nominal_end(const struct bme69x_seq *seq, uint32_t step);
+
+/* This internal API is used to convert a datasheet time of a sequential profile into device time */
+static uint64_t seq_time(const struct bme69x_seq *seq, uint64_t nominal_us, uint32_t scale);
+
+/* This internal API is used to narrow the timing scale of a sequential profile with the result of a read */
+static void seq_update_scale(struct bme69x_seq *seq, uint64_t found_us, uint64_t read_us, uint64_t now);
+
+/* This internal API is used to schedule the next read of a sequential profile, when the next three steps are
+ * buffered */
+static void seq_next_read(struct bme69x_seq *seq, uint64_t now);
+
 /* This internal API is used to calculate the gas wait */
 static uint8_t calc_gas_wait(uint16_t dur);
 
+/* This internal API is used to calculate the gas wait in milliseconds from its register value */
+static uint16_t calc_gas_wait_ms(uint8_t gas_wait);
+
+/* This internal API is used to calculate the lowest heater temperature giving a heater resistance code */
+static uint16_t calc_heatr_temp(uint8_t res_heat, const struct bme69x_dev *dev);
+
+/* This internal API is used to encode a duration into the 6 bit value and 2 bit multiplication factor of
+ * the heater duration registers */
+static uint8_t calc_dur_code(uint16_t dur);
+
+/* This internal API is used to decode a heater duration register into the duration in register steps */
+static uint16_t calc_dur_steps(uint8_t dur_code);
+
+/* This internal API is used to get the number of significant bits of a value */
+static uint8_t bit_length(uint16_t value);
+
 #ifndef BME69X_USE_FPU
 
 /* This internal API is used to calculate the temperature in integer */
-static int16_t calc_temperature(uint32_t temp_adc, struct bme69x_dev *dev, uint32_t *t_lin);
+static int16_t calc_temperature(uint32_t temp_adc, const struct bme69x_calib_data *calib, int32_t *t_lin);
 
 /* This internal API is used to calculate the pressure in integer */
-static uint32_t calc_pressure(uint32_t pres_adc, uint32_t t_lin, const struct bme69x_dev *dev);
+static uint32_t calc_pressure(uint32_t pres_adc, int32_t t_lin, const struct bme69x_calib_data *calib);
 
 /* This internal API is used to calculate the humidity in integer */
-static uint32_t calc_humidity(uint16_t hum_adc, int16_t comp_temperature, const struct bme69x_dev *dev);
+static uint32_t calc_humidity(uint16_t hum_adc, int32_t t_lin, const struct bme69x_calib_data *calib);
 
 /* This internal API is used to calculate the gas resistance for BME69x variant */
 static uint32_t calc_gas_resistance(uint16_t gas_res_adc, uint8_t gas_range);
@@ -68,13 +131,13 @@ static uint8_t calc_res_heat(uint16_t temp, const struct bme69x_dev *dev);
 #else
 
 /* This internal API is used to calculate the temperature value in float */
-static float calc_temperature(uint32_t temp_adc, const struct bme69x_dev *dev);
+static float calc_temperature(uint32_t temp_adc, const struct bme69x_calib_data *calib);
 
 /* This internal API is used to calculate the pressure value in float */
-static float calc_pressure(uint32_t pres_adc, float comp_temperature, const struct bme69x_dev *dev);
+static float calc_pressure(uint32_t pres_adc, float comp_temperature, const struct bme69x_calib_data *calib);
 
 /* This internal API is used to calculate the humidity value in float */
-static float calc_humidity(uint16_t hum_adc, float comp_temperature, const struct bme69x_dev *dev);
+static float calc_humidity(uint16_t hum_adc, float comp_temperature, const struct bme69x_calib_data *calib);
 
 /* This internal API is used to calculate the gas for BME69x variant in float */
 static float calc_gas_resistance(uint16_t gas_res_adc, uint8_t gas_range);
@@ -82,14 +145,26 @@ static float calc_gas_resistance(uint16_t gas_res_adc, uint8_t gas_range);
 /* This internal API is used to calculate the heater resistance value using float */
 static uint8_t calc_res_heat(uint16_t temp, const struct bme69x_dev *dev);
 
+/* This internal API is used to scale the calibration coefficients for the floating point compensation */
+static void calc_calib_fpu(struct bme69x_calib_data *calib);
+
 #endif
 
+/* This internal API is used to read and compensate a field once, without waiting for new data */
+static int8_t read_field_data_once(uint8_t index, struct bme69x_data *data, struct bme69x_dev *dev);
+
 /* This internal API is used to read a single data of the sensor */
 static int8_t read_field_data(uint8_t index, struct bme69x_data *data, struct bme69x_dev *dev);
 
 /* This internal API is used to read all data fields of the sensor */
 static int8_t read_all_field_data(struct bme69x_data * const data[], struct bme69x_dev *dev);
 
+/* This internal API is used to decode and compensate data fields in one pass */
+static void compensate_fields(const uint8_t *buff,
+                              uint8_t n_fields,
+                              struct bme69x_data * const data[],
+                              const struct bme69x_calib_data *calib);
+
 /* This internal API is used to switch between SPI memory pages */
 static int8_t set_mem_page(uint8_t reg_addr, struct bme69x_dev *dev);
 
@@ -99,8 +174,47 @@ static int8_t get_mem_page(struct bme69x_dev *dev);
 /* This internal API is used to check the bme69x_dev for null pointers */
 static int8_t null_ptr_check(const struct bme69x_dev *dev);
 
-/* This internal API is used to set heater configurations */
-static int8_t set_conf(const struct bme69x_heatr_conf *conf, uint8_t op_mode, uint8_t *nb_conv, struct bme69x_dev *dev);
+/* This internal API is used to copy a register access into the shadow registers */
+static void shadow_update(uint8_t reg_addr, const uint8_t *reg_data, uint32_t len, struct bme69x_dev *dev);
+
+/* This internal API is used to write only the registers whose shadow differs */
+static int8_t set_regs_changed(const uint8_t *reg_addr, const uint8_t *reg_data, uint32_t len, struct bme69x_dev *dev);
+
+/* This internal API is used to get the operation mode, from the shadow registers when they are conclusive */
+static int8_t get_cur_op_mode(uint8_t *op_mode, struct bme69x_dev *dev);
+
+/* This internal API is used to account a public API call in the bus statistics */
+static uint8_t stats_enter(uint8_t api, struct bme69x_dev *dev);
+
+/* This internal API is used to end the accounting of a public API call */
+static void stats_exit(uint8_t prev_api, struct bme69x_dev *dev);
+
+/* This internal API is used to read the time source when the bus statistics are enabled */
+static uint64_t stats_time_us(const struct bme69x_dev *dev);
+
+/* This internal API is used to take the lock of the device */
+static void dev_lock(const struct bme69x_dev *dev);
+
+/* This internal API is used to give the lock of the device */
+static void dev_unlock(const struct bme69x_dev *dev);
+
+/* This internal API is used to publish the newest sample of the device */
+static void publish_latest(const struct bme69x_data *data, struct bme69x_dev *dev);
+
+/* This internal API is used to account a bus transaction in the bus statistics */
+static void stats_bus(uint8_t is_write, uint32_t len, uint64_t start_us, struct bme69x_dev *dev);
+
+/* This internal API is used to call the delay callback and account the time slept */
+static void dev_delay_us(uint32_t period, struct bme69x_dev *dev);
+
+/* This internal API is used to build the heater register writes of a configuration */
+static int8_t set_conf(const struct bme69x_heatr_conf *conf,
+                       uint8_t op_mode,
+                       uint8_t *nb_conv,
+                       uint8_t *reg_addr,
+                       uint8_t *reg_data,
+                       uint8_t *len,
+                       struct bme69x_dev *dev);
 
 /* This internal API is used to limit the max value of a parameter */
 static int8_t boundary_check(uint8_t *value, uint8_t max, struct bme69x_dev *dev);
@@ -109,6 +223,9 @@ static int8_t boundary_check(uint8_t *value, uint8_t max, struct bme69x_dev *dev
  * shared heater duration */
 static uint8_t calc_heatr_dur_shared(uint16_t dur);
 
+/* This internal API is used to calculate the shared heater duration in milliseconds from its register value */
+static uint16_t calc_heatr_dur_shared_ms(uint8_t heatdurval);
+
 /* This internal API is used to swap two fields */
 static void swap_fields(uint8_t index1, uint8_t index2, struct bme69x_data *field[]);
 
@@ -138,7 +255,20 @@ static int8_t analyze_sensor_data(const struct bme69x_data *data, uint8_t n_meas
 int8_t bme69x_init(struct bme69x_dev *dev)
 {
     int8_t rslt;
+    uint8_t prev_api;
 
+    rslt = null_ptr_check(dev);
+    if (rslt != BME69X_OK)
+    {
+        return rslt;
+    }
+
+    prev_api = stats_enter(BME69X_STATS_API_INIT, dev);
+    dev->shadow_valid = 0;
+    if (dev->heatr_lut)
+    {
+        dev->heatr_lut->valid = 0;
+    }
     (void) bme69x_soft_reset(dev);
 
     rslt = bme69x_get_regs(BME69X_REG_CHIP_ID, &dev->chip_id, 1, dev);
@@ -155,6 +285,13 @@ int8_t bme69x_init(struct bme69x_dev *dev)
                 /* Get the Calibration data */
                 rslt = get_calib_data(dev);
             }
+
+            if (rslt == BME69X_OK)
+            {
+                /* Load the shadow registers, later configuration changes only write the difference */
+                rslt = bme69x_get_regs(BME69X_REG_IDAC_HEAT0, dev->shadow, BME69X_LEN_SHADOW, dev);
+                dev->shadow_valid = (rslt == BME69X_OK);
+            }
         }
         else
         {
@@ -162,6 +299,8 @@ int8_t bme69x_init(struct bme69x_dev *dev)
         }
     }
 
+    stats_exit(prev_api, dev);
+
     return rslt;
 }
 
@@ -174,39 +313,81 @@ int8_t bme69x_set_regs(const uint8_t *reg_addr, const uint8_t *reg_data, uint32_
 
     /* Length of the temporary buffer is 2*(length of register)*/
     uint8_t tmp_buff[BME69X_LEN_INTERLEAVE_BUFF] = { 0 };
-    uint16_t index;
+    uint32_t index;
+    uint32_t done = 0;
+    uint32_t chunk;
+    uint64_t start_us;
+    uint8_t prev_api;
+
+    prev_api = stats_enter(BME69X_STATS_API_REGS, dev);
 
     /* Check for null pointer in the device structure*/
     rslt = null_ptr_check(dev);
     if ((rslt == BME69X_OK) && reg_addr && reg_data)
     {
-        if ((len > 0) && (len <= (BME69X_LEN_INTERLEAVE_BUFF / 2)))
+        if (len > 0)
         {
-            /* Interleave the 2 arrays */
-            for (index = 0; index < len; index++)
+            /* The sensor does not auto-increment on writes, every data byte needs its address.
+             * The buffer holds the whole control block, longer writes are split. On SPI a
+             * transaction also ends where the next register is on the other memory page. */
+            while ((rslt == BME69X_OK) && (done < len))
             {
                 if (dev->intf == BME69X_SPI_INTF)
                 {
                     /* Set the memory page */
-                    rslt = set_mem_page(reg_addr[index], dev);
-                    tmp_buff[(2 * index)] = reg_addr[index] & BME69X_SPI_WR_MSK;
+                    rslt = set_mem_page(reg_addr[done], dev);
                 }
-                else
+
+                /* Interleave the 2 arrays */
+                chunk = 0;
+                while (((done + chunk) < len) && (chunk < (BME69X_LEN_INTERLEAVE_BUFF / 2)))
                 {
-                    tmp_buff[(2 * index)] = reg_addr[index];
+                    index = done + chunk;
+                    if (dev->intf == BME69X_SPI_INTF)
+                    {
+                        if ((reg_addr[index] ^ reg_addr[done]) & BME69X_SPI_RD_MSK)
+                        {
+                            break;
+                        }
+
+                        tmp_buff[(2 * chunk)] = reg_addr[index] & BME69X_SPI_WR_MSK;
+                    }
+                    else
+                    {
+                        tmp_buff[(2 * chunk)] = reg_addr[index];
+                    }
+
+                    tmp_buff[(2 * chunk) + 1] = reg_data[index];
+                    chunk++;
                 }
 
-                tmp_buff[(2 * index) + 1] = reg_data[index];
-            }
+                /* Write the interleaved array */
+                if (rslt == BME69X_OK)
+                {
+                    start_us = stats_time_us(dev);
+                    dev->intf_rslt = dev->write(tmp_buff[0], &tmp_buff[1], (2 * chunk) - 1, dev->intf_ptr);
+                    stats_bus(1, 2 * chunk, start_us, dev);
+                    if (dev->intf_rslt != 0)
+                    {
+                        rslt = BME69X_E_COM_FAIL;
+                    }
+                }
 
-            /* Write the interleaved array */
-            if (rslt == BME69X_OK)
-            {
-                dev->intf_rslt = dev->write(tmp_buff[0], &tmp_buff[1], (2 * len) - 1, dev->intf_ptr);
-                if (dev->intf_rslt != 0)
+                if (rslt == BME69X_OK)
                 {
-                    rslt = BME69X_E_COM_FAIL;
+                    for (index = done; index < (done + chunk); index++)
+                    {
+                        shadow_update(reg_addr[index], &reg_data[index], 1, dev);
+                        if ((dev->intf == BME69X_SPI_INTF) &&
+                            ((reg_addr[index] & BME69X_SPI_WR_MSK) == (BME69X_REG_MEM_PAGE & BME69X_SPI_WR_MSK)))
+                        {
+                            dev->mem_page_reg = reg_data[index];
+                            dev->mem_page = reg_data[index] & BME69X_MEM_PAGE_MSK;
+                        }
+                    }
                 }
+
+                done += chunk;
             }
         }
         else
@@ -219,6 +400,8 @@ int8_t bme69x_set_regs(const uint8_t *reg_addr, const uint8_t *reg_data, uint32_
         rslt = BME69X_E_NULL_PTR;
     }
 
+    stats_exit(prev_api, dev);
+
     return rslt;
 }
 
@@ -228,6 +411,11 @@ int8_t bme69x_set_regs(const uint8_t *reg_addr, const uint8_t *reg_data, uint32_
 int8_t bme69x_get_regs(uint8_t reg_addr, uint8_t *reg_data, uint32_t len, struct bme69x_dev *dev)
 {
     int8_t rslt;
+    uint8_t start_addr = reg_addr;
+    uint64_t start_us;
+    uint8_t prev_api;
+
+    prev_api = stats_enter(BME69X_STATS_API_REGS, dev);
 
     /* Check for null pointer in the device structure*/
     rslt = null_ptr_check(dev);
@@ -243,17 +431,25 @@ int8_t bme69x_get_regs(uint8_t reg_addr, uint8_t *reg_data, uint32_t len, struct
             }
         }
 
+        start_us = stats_time_us(dev);
         dev->intf_rslt = dev->read(reg_addr, reg_data, len, dev->intf_ptr);
+        stats_bus(0, len, start_us, dev);
         if (dev->intf_rslt != 0)
         {
             rslt = BME69X_E_COM_FAIL;
         }
+        else
+        {
+            shadow_update(start_addr, reg_data, len, dev);
+        }
     }
     else
     {
         rslt = BME69X_E_NULL_PTR;
     }
 
+    stats_exit(prev_api, dev);
+
     return rslt;
 }
 
@@ -267,6 +463,9 @@ int8_t bme69x_soft_reset(struct bme69x_dev *dev)
 
     /* 0xb6 is the soft reset command */
     uint8_t soft_rst_cmd = BME69X_SOFT_RESET_CMD;
+    uint8_t prev_api;
+
+    prev_api = stats_enter(BME69X_STATS_API_SOFT_RESET, dev);
 
     /* Check for null pointer in the device structure*/
     rslt = null_ptr_check(dev);
@@ -284,8 +483,11 @@ int8_t bme69x_soft_reset(struct bme69x_dev *dev)
 
             if (rslt == BME69X_OK)
             {
+                /* The reset restores the register defaults */
+                dev->shadow_valid = 0;
+
                 /* Wait for 5ms */
-                dev->delay_us(BME69X_PERIOD_RESET, dev->intf_ptr);
+                dev_delay_us(BME69X_PERIOD_RESET, dev);
 
                 /* After reset get the memory page */
                 if (dev->intf == BME69X_SPI_INTF)
@@ -296,6 +498,8 @@ int8_t bme69x_soft_reset(struct bme69x_dev *dev)
         }
     }
 
+    stats_exit(prev_api, dev);
+
     return rslt;
 }
 
@@ -307,12 +511,15 @@ int8_t bme69x_set_conf(struct bme69x_conf *conf, struct bme69x_dev *dev)
     int8_t rslt;
     uint8_t odr20 = 0, odr3 = 1;
     uint8_t current_op_mode;
+    uint8_t i;
 
     /* Register data starting from BME69X_REG_CTRL_GAS_1(0x71) up to BME69X_REG_CONFIG(0x75) */
     uint8_t reg_array[BME69X_LEN_CONFIG] = { 0x71, 0x72, 0x73, 0x74, 0x75 };
     uint8_t data_array[BME69X_LEN_CONFIG] = { 0 };
+    uint8_t prev_api;
 
-    rslt = bme69x_get_op_mode(&current_op_mode, dev);
+    prev_api = stats_enter(BME69X_STATS_API_SET_CONF, dev);
+    rslt = get_cur_op_mode(&current_op_mode, dev);
     if (rslt == BME69X_OK)
     {
         /* Configure only in the sleep mode */
@@ -325,8 +532,19 @@ int8_t bme69x_set_conf(struct bme69x_conf *conf, struct bme69x_dev *dev)
     }
     else if (rslt == BME69X_OK)
     {
-        /* Read the whole configuration and write it back once later */
-        rslt = bme69x_get_regs(reg_array[0], data_array, BME69X_LEN_CONFIG, dev);
+        /* Start from the current configuration and write back only what changes */
+        if (dev->shadow_valid)
+        {
+            for (i = 0; i < BME69X_LEN_CONFIG; i++)
+            {
+                data_array[i] = dev->shadow[reg_array[i] - BME69X_REG_IDAC_HEAT0];
+            }
+        }
+        else
+        {
+            rslt = bme69x_get_regs(reg_array[0], data_array, BME69X_LEN_CONFIG, dev);
+        }
+
         dev->info_msg = BME69X_OK;
         if (rslt == BME69X_OK)
         {
@@ -372,7 +590,7 @@ int8_t bme69x_set_conf(struct bme69x_conf *conf, struct bme69x_dev *dev)
 
     if (rslt == BME69X_OK)
     {
-        rslt = bme69x_set_regs(reg_array, data_array, BME69X_LEN_CONFIG, dev);
+        rslt = set_regs_changed(reg_array, data_array, BME69X_LEN_CONFIG, dev);
     }
 
     if ((current_op_mode != BME69X_SLEEP_MODE) && (rslt == BME69X_OK))
@@ -380,6 +598,8 @@ int8_t bme69x_set_conf(struct bme69x_conf *conf, struct bme69x_dev *dev)
         rslt = bme69x_set_op_mode(current_op_mode, dev);
     }
 
+    stats_exit(prev_api, dev);
+
     return rslt;
 }
 
@@ -393,8 +613,23 @@ int8_t bme69x_get_conf(struct bme69x_conf *conf, struct bme69x_dev *dev)
     /* starting address of the register array for burst read*/
     uint8_t reg_addr = BME69X_REG_CTRL_GAS_1;
     uint8_t data_array[BME69X_LEN_CONFIG];
+    uint8_t i;
+    uint8_t prev_api;
+
+    prev_api = stats_enter(BME69X_STATS_API_GET_CONF, dev);
+    if ((null_ptr_check(dev) == BME69X_OK) && dev->shadow_valid)
+    {
+        rslt = BME69X_OK;
+        for (i = 0; i < BME69X_LEN_CONFIG; i++)
+        {
+            data_array[i] = dev->shadow[reg_addr + i - BME69X_REG_IDAC_HEAT0];
+        }
+    }
+    else
+    {
+        rslt = bme69x_get_regs(reg_addr, data_array, 5, dev);
+    }
 
-    rslt = bme69x_get_regs(reg_addr, data_array, 5, dev);
     if (!conf)
     {
         rslt = BME69X_E_NULL_PTR;
@@ -415,6 +650,8 @@ int8_t bme69x_get_conf(struct bme69x_conf *conf, struct bme69x_dev *dev)
         }
     }
 
+    stats_exit(prev_api, dev);
+
     return rslt;
 }
 
@@ -427,9 +664,24 @@ int8_t bme69x_set_op_mode(const uint8_t op_mode, struct bme69x_dev *dev)
     uint8_t tmp_pow_mode;
     uint8_t pow_mode = 0;
     uint8_t reg_addr = BME69X_REG_CTRL_MEAS;
+    uint8_t prev_api;
+
+    prev_api = stats_enter(BME69X_STATS_API_SET_OP_MODE, dev);
+    rslt = null_ptr_check(dev);
+    if ((rslt == BME69X_OK) && dev->shadow_valid &&
+        ((dev->shadow[BME69X_REG_CTRL_MEAS - BME69X_REG_IDAC_HEAT0] & BME69X_MODE_MSK) == BME69X_SLEEP_MODE))
+    {
+        /* Sleep was the last mode written, the sensor cannot have left it on its own */
+        tmp_pow_mode = dev->shadow[BME69X_REG_CTRL_MEAS - BME69X_REG_IDAC_HEAT0];
+        pow_mode = BME69X_SLEEP_MODE;
+    }
+    else
+    {
+        pow_mode = BME69X_FORCED_MODE;
+    }
 
     /* Call until in sleep */
-    do
+    while ((pow_mode != BME69X_SLEEP_MODE) && (rslt == BME69X_OK))
     {
         rslt = bme69x_get_regs(BME69X_REG_CTRL_MEAS, &tmp_pow_mode, 1, dev);
         if (rslt == BME69X_OK)
@@ -440,10 +692,10 @@ int8_t bme69x_set_op_mode(const uint8_t op_mode, struct bme69x_dev *dev)
             {
                 tmp_pow_mode &= ~BME69X_MODE_MSK; /* Set to sleep */
                 rslt = bme69x_set_regs(&reg_addr, &tmp_pow_mode, 1, dev);
-                dev->delay_us(BME69X_PERIOD_POLL, dev->intf_ptr);
+                dev_delay_us(BME69X_PERIOD_POLL, dev);
             }
         }
-    } while ((pow_mode != BME69X_SLEEP_MODE) && (rslt == BME69X_OK));
+    }
 
     /* Already in sleep */
     if ((op_mode != BME69X_SLEEP_MODE) && (rslt == BME69X_OK))
@@ -452,6 +704,8 @@ int8_t bme69x_set_op_mode(const uint8_t op_mode, struct bme69x_dev *dev)
         rslt = bme69x_set_regs(&reg_addr, &tmp_pow_mode, 1, dev);
     }
 
+    stats_exit(prev_api, dev);
+
     return rslt;
 }
 
@@ -462,19 +716,25 @@ int8_t bme69x_get_op_mode(uint8_t *op_mode, struct bme69x_dev *dev)
 {
     int8_t rslt;
     uint8_t mode;
+    uint8_t prev_api;
 
+    prev_api = stats_enter(BME69X_STATS_API_GET_OP_MODE, dev);
     if (op_mode)
     {
         rslt = bme69x_get_regs(BME69X_REG_CTRL_MEAS, &mode, 1, dev);
-
-        /* Masking the other register bit info*/
-        *op_mode = mode & BME69X_MODE_MSK;
+        if (rslt == BME69X_OK)
+        {
+            /* Masking the other register bit info*/
+            *op_mode = mode & BME69X_MODE_MSK;
+        }
     }
     else
     {
         rslt = BME69X_E_NULL_PTR;
     }
 
+    stats_exit(prev_api, dev);
+
     return rslt;
 }
 
@@ -537,7 +797,9 @@ int8_t bme69x_get_data(uint8_t op_mode, struct bme69x_data *data, uint8_t *n_dat
     uint8_t i = 0, j = 0, new_fields = 0;
     struct bme69x_data *field_ptr[3] = { 0 };
     struct bme69x_data field_data[3] = { { 0 } };
+    uint8_t prev_api;
 
+    prev_api = stats_enter(BME69X_STATS_API_GET_DATA, dev);
     field_ptr[0] = &field_data[0];
     field_ptr[1] = &field_data[1];
     field_ptr[2] = &field_data[2];
@@ -609,12 +871,136 @@ int8_t bme69x_get_data(uint8_t op_mode, struct bme69x_data *data, uint8_t *n_dat
         {
             *n_data = new_fields;
         }
+
+        /* The new fields are sorted first, oldest to newest */
+        if ((rslt == BME69X_OK) && (dev->latest != NULL))
+        {
+            publish_latest(&data[new_fields - 1], dev);
+        }
+    }
+    else
+    {
+        rslt = BME69X_E_NULL_PTR;
+    }
+
+    stats_exit(prev_api, dev);
+
+    return rslt;
+}
+
+/*
+ * @brief This API copies the newest sample read by bme69x_get_data, without taking the device lock.
+ */
+int8_t bme69x_get_latest(struct bme69x_data *data, uint32_t *count, uint64_t *time_us, const struct bme69x_dev *dev)
+{
+    const struct bme69x_latest *latest;
+    uint32_t n;
+    uint8_t idx;
+
+    if ((data == NULL) || (dev == NULL) || (dev->latest == NULL))
+    {
+        return BME69X_E_NULL_PTR;
+    }
+
+    latest = dev->latest;
+    do
+    {
+        n = latest->count;
+        if (n == 0)
+        {
+            return BME69X_W_NO_NEW_DATA;
+        }
+
+        /* The copy is consistent unless a sample was published meanwhile, the next one may overwrite it */
+        BME69X_MEMORY_BARRIER();
+        idx = (uint8_t)((n - 1) % 2);
+        *data = latest->data[idx];
+        if (time_us != NULL)
+        {
+            *time_us = latest->time_us[idx];
+        }
+
+        BME69X_MEMORY_BARRIER();
+    } while (latest->count != n);
+
+    if (count != NULL)
+    {
+        *count = n;
+    }
+
+    return BME69X_OK;
+}
+
+/*
+ * @brief This API starts a forced mode measurement and returns when its data is expected.
+ */
+int8_t bme69x_trigger_forced(struct bme69x_conf *conf,
+                             const struct bme69x_heatr_conf *heatr_conf,
+                             uint64_t *ready_us,
+                             struct bme69x_dev *dev)
+{
+    int8_t rslt;
+    const struct bme69x_heatr_conf heatr_off = { 0 };
+    struct bme69x_timing timing;
+    uint64_t now = 0;
+    uint8_t prev_api;
+
+    prev_api = stats_enter(BME69X_STATS_API_TRIGGER_FORCED, dev);
+    rslt = null_ptr_check(dev);
+    if ((rslt == BME69X_OK) && (conf != NULL) && (ready_us != NULL))
+    {
+        rslt = bme69x_get_timing(BME69X_FORCED_MODE, conf, heatr_conf ? heatr_conf : &heatr_off, &timing, dev);
+        if (rslt == BME69X_OK)
+        {
+            rslt = bme69x_set_op_mode(BME69X_FORCED_MODE, dev);
+        }
+
+        if (rslt == BME69X_OK)
+        {
+            if (dev->get_time_us != NULL)
+            {
+                now = dev->get_time_us(dev->intf_ptr);
+            }
+
+            *ready_us = now + timing.cycle_us;
+        }
+    }
+    else
+    {
+        rslt = BME69X_E_NULL_PTR;
+    }
+
+    stats_exit(prev_api, dev);
+
+    return rslt;
+}
+
+/*
+ * @brief This API checks once for forced mode data and compensates it when available.
+ */
+int8_t bme69x_try_collect(struct bme69x_data *data, uint8_t *n_data, struct bme69x_dev *dev)
+{
+    int8_t rslt;
+    uint8_t prev_api;
+
+    prev_api = stats_enter(BME69X_STATS_API_TRY_COLLECT, dev);
+    rslt = null_ptr_check(dev);
+    if ((rslt == BME69X_OK) && (data != NULL) && (n_data != NULL))
+    {
+        rslt = read_field_data_once(0, data, dev);
+        *n_data = (rslt == BME69X_OK) ? 1 : 0;
+        if ((rslt == BME69X_OK) && (dev->latest != NULL))
+        {
+            publish_latest(&data[*n_data - 1], dev);
+        }
     }
     else
     {
         rslt = BME69X_E_NULL_PTR;
     }
 
+    stats_exit(prev_api, dev);
+
     return rslt;
 }
 
@@ -627,19 +1013,34 @@ int8_t bme69x_set_heatr_conf(uint8_t op_mode, const struct bme69x_heatr_conf *co
     uint8_t nb_conv = 0;
     uint8_t hctrl, run_gas = 0;
     uint8_t ctrl_gas_data[2];
-    uint8_t ctrl_gas_addr[2] = { BME69X_REG_CTRL_GAS_0, BME69X_REG_CTRL_GAS_1 };
+    uint8_t write_len = 0;
 
+    /* Heater steps, shared heater duration and CTRL_GAS_0/1, written together */
+    uint8_t reg_addr[BME69X_LEN_SHADOW];
+    uint8_t reg_data[BME69X_LEN_SHADOW];
+    uint8_t prev_api;
+
+    prev_api = stats_enter(BME69X_STATS_API_SET_HEATR_CONF, dev);
     if (conf != NULL)
     {
         rslt = bme69x_set_op_mode(BME69X_SLEEP_MODE, dev);
         if (rslt == BME69X_OK)
         {
-            rslt = set_conf(conf, op_mode, &nb_conv, dev);
+            rslt = set_conf(conf, op_mode, &nb_conv, reg_addr, reg_data, &write_len, dev);
         }
 
         if (rslt == BME69X_OK)
         {
-            rslt = bme69x_get_regs(BME69X_REG_CTRL_GAS_0, ctrl_gas_data, 2, dev);
+            if (dev->shadow_valid)
+            {
+                ctrl_gas_data[0] = dev->shadow[BME69X_REG_CTRL_GAS_0 - BME69X_REG_IDAC_HEAT0];
+                ctrl_gas_data[1] = dev->shadow[BME69X_REG_CTRL_GAS_1 - BME69X_REG_IDAC_HEAT0];
+            }
+            else
+            {
+                rslt = bme69x_get_regs(BME69X_REG_CTRL_GAS_0, ctrl_gas_data, 2, dev);
+            }
+
             if (rslt == BME69X_OK)
             {
                 if (conf->enable == BME69X_ENABLE)
@@ -658,7 +1059,12 @@ int8_t bme69x_set_heatr_conf(uint8_t op_mode, const struct bme69x_heatr_conf *co
                 ctrl_gas_data[1] = BME69X_SET_BITS_POS_0(ctrl_gas_data[1], BME69X_NBCONV, nb_conv);
                 ctrl_gas_data[1] = BME69X_SET_BITS(ctrl_gas_data[1], BME69X_RUN_GAS, run_gas);
 
-                rslt = bme69x_set_regs(ctrl_gas_addr, ctrl_gas_data, 2, dev);
+                reg_addr[write_len] = BME69X_REG_CTRL_GAS_0;
+                reg_data[write_len++] = ctrl_gas_data[0];
+                reg_addr[write_len] = BME69X_REG_CTRL_GAS_1;
+                reg_data[write_len++] = ctrl_gas_data[1];
+
+                rslt = set_regs_changed(reg_addr, reg_data, write_len, dev);
             }
         }
     }
@@ -667,45 +1073,101 @@ int8_t bme69x_set_heatr_conf(uint8_t op_mode, const struct bme69x_heatr_conf *co
         rslt = BME69X_E_NULL_PTR;
     }
 
+    stats_exit(prev_api, dev);
+
     return rslt;
 }
 
 /*!
  * @brief This API is used to get the gas configuration of the sensor.
  */
-int8_t bme69x_get_heatr_conf(const struct bme69x_heatr_conf *conf, struct bme69x_dev *dev)
+int8_t bme69x_get_heatr_conf(uint8_t op_mode, struct bme69x_heatr_conf *conf, struct bme69x_dev *dev)
 {
     int8_t rslt = BME69X_OK;
-    uint8_t data_array[10] = { 0 };
+    uint8_t regs[BME69X_LEN_SHADOW] = { 0 };
+    const uint8_t *res_heat = &regs[BME69X_REG_RES_HEAT0 - BME69X_REG_IDAC_HEAT0];
+    const uint8_t *gas_wait = &regs[BME69X_REG_GAS_WAIT0 - BME69X_REG_IDAC_HEAT0];
     uint8_t i;
+    uint8_t prev_api;
 
-    if ((conf != NULL) && (conf->heatr_dur_prof != NULL) && (conf->heatr_temp_prof != NULL))
+    prev_api = stats_enter(BME69X_STATS_API_GET_HEATR_CONF, dev);
+    rslt = null_ptr_check(dev);
+    if ((rslt == BME69X_OK) && (conf != NULL))
+    {
+        if (dev->shadow_valid)
+        {
+            memcpy(regs, dev->shadow, BME69X_LEN_SHADOW);
+        }
+        else
+        {
+            rslt = bme69x_get_regs(BME69X_REG_IDAC_HEAT0, regs, BME69X_LEN_SHADOW, dev);
+        }
+    }
+    else
     {
-        /* FIXME: Add conversion to deg C and ms and add the other parameters */
-        rslt = bme69x_get_regs(BME69X_REG_RES_HEAT0, data_array, 10, dev);
+        rslt = BME69X_E_NULL_PTR;
+    }
 
-        if (rslt == BME69X_OK)
+    if (rslt == BME69X_OK)
+    {
+        if (BME69X_GET_BITS(regs[BME69X_REG_CTRL_GAS_1 - BME69X_REG_IDAC_HEAT0], BME69X_RUN_GAS) ==
+            BME69X_ENABLE_GAS_MEAS)
         {
-            for (i = 0; i < conf->profile_len; i++)
-            {
-                conf->heatr_temp_prof[i] = data_array[i];
-            }
+            conf->enable = BME69X_ENABLE;
+        }
+        else
+        {
+            conf->enable = BME69X_DISABLE;
+        }
+
+        switch (op_mode)
+        {
+            case BME69X_FORCED_MODE:
+                conf->heatr_temp = calc_heatr_temp(res_heat[0], dev);
+                conf->heatr_dur = calc_gas_wait_ms(gas_wait[0]);
+                break;
+            case BME69X_SEQUENTIAL_MODE:
+            case BME69X_PARALLEL_MODE:
+                if ((!conf->heatr_dur_prof) || (!conf->heatr_temp_prof))
+                {
+                    rslt = BME69X_E_NULL_PTR;
+                    break;
+                }
 
-            rslt = bme69x_get_regs(BME69X_REG_GAS_WAIT0, data_array, 10, dev);
+                if (conf->profile_len > 10)
+                {
+                    rslt = BME69X_E_INVALID_LENGTH;
+                    break;
+                }
 
-            if (rslt == BME69X_OK)
-            {
                 for (i = 0; i < conf->profile_len; i++)
                 {
-                    conf->heatr_dur_prof[i] = data_array[i];
+                    conf->heatr_temp_prof[i] = calc_heatr_temp(res_heat[i], dev);
+
+                    /* In parallel mode the steps hold multiples of the shared heater duration */
+                    if (op_mode == BME69X_PARALLEL_MODE)
+                    {
+                        conf->heatr_dur_prof[i] = gas_wait[i];
+                    }
+                    else
+                    {
+                        conf->heatr_dur_prof[i] = calc_gas_wait_ms(gas_wait[i]);
+                    }
+                }
+
+                if (op_mode == BME69X_PARALLEL_MODE)
+                {
+                    conf->shared_heatr_dur =
+                        calc_heatr_dur_shared_ms(regs[BME69X_REG_SHD_HEATR_DUR - BME69X_REG_IDAC_HEAT0]);
                 }
-            }
+
+                break;
+            default:
+                rslt = BME69X_W_DEFINE_OP_MODE;
         }
     }
-    else
-    {
-        rslt = BME69X_E_NULL_PTR;
-    }
+
+    stats_exit(prev_api, dev);
 
     return rslt;
 }
@@ -713,13 +1175,13 @@ int8_t bme69x_get_heatr_conf(const struct bme69x_heatr_conf *conf, struct bme69x
 /*
  * @brief This API performs Self-test of low and high gas variants of BME69X
  */
-int8_t bme69x_selftest_check(const struct bme69x_dev *dev)
+int8_t bme69x_selftest_check(struct bme69x_dev *dev)
 {
     int8_t rslt;
     uint8_t n_fields;
     uint8_t i = 0;
     struct bme69x_data data[BME69X_N_MEAS] = { { 0 } };
-    struct bme69x_dev t_dev;
+    struct bme69x_dev t_dev = { 0 };
     struct bme69x_conf conf;
     struct bme69x_heatr_conf heatr_conf;
 
@@ -727,14 +1189,20 @@ int8_t bme69x_selftest_check(const struct bme69x_dev *dev)
 
     if (rslt == BME69X_OK)
     {
+        /* The copy shares the bus of the device, the lock of the device is held throughout */
+        dev_lock(dev);
+
         /* Copy required parameters from reference bme69x_dev struct */
         t_dev.amb_temp = 25;
         t_dev.read = dev->read;
         t_dev.write = dev->write;
         t_dev.intf = dev->intf;
         t_dev.delay_us = dev->delay_us;
+        t_dev.get_time_us = dev->get_time_us;
         t_dev.intf_ptr = dev->intf_ptr;
+        t_dev.stats = dev->stats;
 
+        (void)stats_enter(BME69X_STATS_API_SELFTEST, &t_dev);
         rslt = bme69x_init(&t_dev);
     }
 
@@ -759,8 +1227,17 @@ int8_t bme69x_selftest_check(const struct bme69x_dev *dev)
                 if (rslt == BME69X_OK)
                 {
                     /* Wait for the measurement to complete */
-                    t_dev.delay_us(BME69X_HEATR_DUR1_DELAY, t_dev.intf_ptr);
+                    dev_delay_us(BME69X_HEATR_DUR1_DELAY, &t_dev);
                     rslt = bme69x_get_data(BME69X_FORCED_MODE, &data[0], &n_fields, &t_dev);
+                    if (rslt == BME69X_OK)
+                    {
+                        /* The sample echoes the shadow, the heater current is checked on the sensor */
+                        rslt = bme69x_get_regs((uint8_t)(BME69X_REG_IDAC_HEAT0 + data[0].gas_index),
+                                               &data[0].idac,
+                                               1,
+                                               &t_dev);
+                    }
+
                     if (rslt == BME69X_OK)
                     {
                         if ((data[0].idac != 0x00) && (data[0].idac != 0xFF) &&
@@ -799,7 +1276,7 @@ int8_t bme69x_selftest_check(const struct bme69x_dev *dev)
                     if (rslt == BME69X_OK)
                     {
                         /* Wait for the measurement to complete */
-                        t_dev.delay_us(BME69X_HEATR_DUR2_DELAY, t_dev.intf_ptr);
+                        dev_delay_us(BME69X_HEATR_DUR2_DELAY, &t_dev);
                         rslt = bme69x_get_data(BME69X_FORCED_MODE, &data[i], &n_fields, &t_dev);
                     }
                 }
@@ -814,37 +1291,893 @@ int8_t bme69x_selftest_check(const struct bme69x_dev *dev)
         }
     }
 
+    if (null_ptr_check(dev) == BME69X_OK)
+    {
+        /* The copy reset and reconfigured the sensor, its register and page caches replace the stale ones */
+        memcpy(dev->shadow, t_dev.shadow, BME69X_LEN_SHADOW);
+        dev->shadow_valid = t_dev.shadow_valid;
+        dev->mem_page = t_dev.mem_page;
+        dev->mem_page_reg = t_dev.mem_page_reg;
+        dev_unlock(dev);
+    }
+
     return rslt;
 }
 
-/*****************************INTERNAL APIs***********************************************/
-#ifndef BME69X_USE_FPU
-
-/* @brief This internal API is used to calculate the temperature value. */
-static int16_t calc_temperature(uint32_t temp_adc, struct bme69x_dev *dev, uint32_t *t_lin)
+/*
+ * @brief This API copies the bus transaction statistics
+ */
+int8_t bme69x_get_stats(struct bme69x_stats *stats, const struct bme69x_dev *dev)
 {
-    int64_t partial_data1;
-    int64_t partial_data2;
-    int64_t partial_data3;
+    int8_t rslt = BME69X_OK;
+
+    if ((stats == NULL) || (dev == NULL) || (dev->stats == NULL))
+    {
+        rslt = BME69X_E_NULL_PTR;
+    }
+    else
+    {
+        dev_lock(dev);
+        *stats = *dev->stats;
+        dev_unlock(dev);
+    }
+
+    return rslt;
+}
+
+/*
+ * @brief This API clears the bus transaction statistics
+ */
+int8_t bme69x_reset_stats(struct bme69x_dev *dev)
+{
+    int8_t rslt = BME69X_OK;
+
+    if ((dev == NULL) || (dev->stats == NULL))
+    {
+        rslt = BME69X_E_NULL_PTR;
+    }
+    else
+    {
+        dev_lock(dev);
+        memset(dev->stats, 0, sizeof(*dev->stats));
+        dev_unlock(dev);
+    }
+
+    return rslt;
+}
+
+/*
+ * @brief This API compensates raw field records captured off-line, in blocks of
+ * BME69X_COMP_BLOCK records.
+ */
+int8_t bme69x_compensate_records(const uint8_t *records,
+                                 uint32_t n_records,
+                                 const struct bme69x_calib_data *calib,
+                                 struct bme69x_data *data)
+{
+    int8_t rslt = BME69X_OK;
+    struct bme69x_data *field_ptr[BME69X_COMP_BLOCK];
+    uint32_t done = 0;
+    uint8_t n_block;
+    uint8_t i;
+
+    if ((records == NULL) || (calib == NULL) || (data == NULL))
+    {
+        rslt = BME69X_E_NULL_PTR;
+    }
+
+    while ((rslt == BME69X_OK) && (done < n_records))
+    {
+        n_block = (n_records - done > BME69X_COMP_BLOCK) ? BME69X_COMP_BLOCK : (uint8_t)(n_records - done);
+        for (i = 0; i < n_block; i++)
+        {
+            field_ptr[i] = &data[done + i];
+
+            /* The heater set-point is not part of a record */
+            field_ptr[i]->idac = 0;
+            field_ptr[i]->res_heat = 0;
+            field_ptr[i]->gas_wait = 0;
+        }
+
+        compensate_fields(&records[done * BME69X_LEN_FIELD], n_block, field_ptr, calib);
+        done += n_block;
+    }
+
+    return rslt;
+}
+
+/*
+ * @brief This API reads the unique ID of the sensor.
+ */
+int8_t bme69x_get_unique_id(uint32_t *unique_id, struct bme69x_dev *dev)
+{
+    int8_t rslt;
+    uint8_t reg_data[BME69X_LEN_UNIQUE_ID];
+
+    if (unique_id == NULL)
+    {
+        return BME69X_E_NULL_PTR;
+    }
+
+    rslt = bme69x_get_regs(BME69X_REG_UNIQUE_ID, reg_data, BME69X_LEN_UNIQUE_ID, dev);
+    if (rslt == BME69X_OK)
+    {
+        *unique_id = ((uint32_t)reg_data[0] << 24) | ((uint32_t)reg_data[1] << 16) | ((uint32_t)reg_data[2] << 8) |
+                     (uint32_t)reg_data[3];
+    }
+
+    return rslt;
+}
+
+/*
+ * @brief This API saves the identity and calibration of an initialised sensor
+ * into a calibration snapshot.
+ */
+int8_t bme69x_export_calib(uint8_t *blob, struct bme69x_dev *dev)
+{
+    int8_t rslt;
+    uint32_t unique_id = 0;
+    uint16_t crc;
+
+    if ((blob == NULL) || (dev == NULL))
+    {
+        return BME69X_E_NULL_PTR;
+    }
+
+    if (dev->chip_id != BME69X_CHIP_ID)
+    {
+        return BME69X_E_DEV_NOT_FOUND;
+    }
+
+    rslt = bme69x_get_unique_id(&unique_id, dev);
+    if (rslt == BME69X_OK)
+    {
+        blob[0] = BME69X_CALIB_BLOB_VERSION;
+        blob[1] = dev->chip_id;
+        blob[2] = (uint8_t)dev->variant_id;
+        blob[3] = (uint8_t)(unique_id >> 24);
+        blob[4] = (uint8_t)(unique_id >> 16);
+        blob[5] = (uint8_t)(unique_id >> 8);
+        blob[6] = (uint8_t)unique_id;
+        pack_calib(&dev->calib, &blob[7]);
+
+        crc = calc_crc16(blob, BME69X_LEN_CALIB_BLOB - 2);
+        blob[BME69X_LEN_CALIB_BLOB - 2] = (uint8_t)(crc >> 8);
+        blob[BME69X_LEN_CALIB_BLOB - 1] = (uint8_t)crc;
+    }
+
+    return rslt;
+}
+
+/*
+ * @brief This API initialises the device from a calibration snapshot instead
+ * of the soft reset and calibration reads of bme69x_init.
+ */
+int8_t bme69x_import_calib(const uint8_t *blob, struct bme69x_dev *dev)
+{
+    int8_t rslt;
+    uint32_t unique_id = 0;
+    uint8_t prev_api;
+
+    rslt = null_ptr_check(dev);
+    if ((rslt != BME69X_OK) || (blob == NULL))
+    {
+        return BME69X_E_NULL_PTR;
+    }
+
+    prev_api = stats_enter(BME69X_STATS_API_IMPORT_CALIB, dev);
+    dev->shadow_valid = 0;
+    if (dev->heatr_lut)
+    {
+        dev->heatr_lut->valid = 0;
+    }
+
+    if ((blob[0] != BME69X_CALIB_BLOB_VERSION) || (blob[1] != BME69X_CHIP_ID) ||
+        (calc_crc16(blob, BME69X_LEN_CALIB_BLOB - 2) !=
+         BME69X_CONCAT_BYTES(blob[BME69X_LEN_CALIB_BLOB - 2], blob[BME69X_LEN_CALIB_BLOB - 1])))
+    {
+        rslt = BME69X_E_CALIB_BLOB;
+    }
+
+    /* The sensor may be on either SPI memory page, whatever the page cache of dev holds */
+    if ((rslt == BME69X_OK) && (dev->intf == BME69X_SPI_INTF))
+    {
+        rslt = get_mem_page(dev);
+    }
+
+    if (rslt == BME69X_OK)
+    {
+        /* The unique ID tells whether the snapshot was taken from this very sensor */
+        rslt = bme69x_get_unique_id(&unique_id, dev);
+        if ((rslt == BME69X_OK) &&
+            (unique_id != (((uint32_t)blob[3] << 24) | ((uint32_t)blob[4] << 16) | ((uint32_t)blob[5] << 8) |
+                           (uint32_t)blob[6])))
+        {
+            rslt = BME69X_E_DEV_NOT_FOUND;
+        }
+    }
+
+    if (rslt == BME69X_OK)
+    {
+        dev->chip_id = blob[1];
+        dev->variant_id = blob[2];
+        unpack_calib(&blob[7], &dev->calib);
+
+        /* Load the shadow registers, later configuration changes only write the difference */
+        rslt = bme69x_get_regs(BME69X_REG_IDAC_HEAT0, dev->shadow, BME69X_LEN_SHADOW, dev);
+        dev->shadow_valid = (rslt == BME69X_OK);
+    }
+
+    stats_exit(prev_api, dev);
+
+    return rslt;
+}
+
+/*
+ * @brief This API saves the identity, calibration and control registers of the
+ * device into a state snapshot, without bus traffic.
+ */
+int8_t bme69x_export_state(uint8_t *state, const struct bme69x_dev *dev)
+{
+    uint16_t crc;
+
+    if ((state == NULL) || (dev == NULL))
+    {
+        return BME69X_E_NULL_PTR;
+    }
+
+    dev_lock(dev);
+    if ((dev->chip_id != BME69X_CHIP_ID) || !dev->shadow_valid)
+    {
+        dev_unlock(dev);
+
+        return BME69X_E_DEV_NOT_FOUND;
+    }
+
+    state[0] = BME69X_STATE_BLOB_VERSION;
+    state[1] = dev->chip_id;
+    state[2] = (uint8_t)dev->variant_id;
+    pack_calib(&dev->calib, &state[3]);
+    memcpy(&state[3 + BME69X_LEN_CALIB_COEFF], dev->shadow, BME69X_LEN_SHADOW);
+    dev_unlock(dev);
+
+    crc = calc_crc16(state, BME69X_LEN_STATE_BLOB - 2);
+    state[BME69X_LEN_STATE_BLOB - 2] = (uint8_t)(crc >> 8);
+    state[BME69X_LEN_STATE_BLOB - 1] = (uint8_t)crc;
+
+    return BME69X_OK;
+}
+
+/*
+ * @brief This API restores the device from a state snapshot, checking the
+ * sensor with a single chip id read.
+ */
+int8_t bme69x_resume(const uint8_t *state, struct bme69x_dev *dev)
+{
+    int8_t rslt;
+    uint8_t chip_id = 0;
+    uint8_t prev_api;
+
+    rslt = null_ptr_check(dev);
+    if ((rslt != BME69X_OK) || (state == NULL))
+    {
+        return BME69X_E_NULL_PTR;
+    }
+
+    prev_api = stats_enter(BME69X_STATS_API_RESUME, dev);
+    dev->shadow_valid = 0;
+    if (dev->heatr_lut)
+    {
+        dev->heatr_lut->valid = 0;
+    }
+
+    if ((state[0] != BME69X_STATE_BLOB_VERSION) || (state[1] != BME69X_CHIP_ID) ||
+        (calc_crc16(state, BME69X_LEN_STATE_BLOB - 2) !=
+         BME69X_CONCAT_BYTES(state[BME69X_LEN_STATE_BLOB - 2], state[BME69X_LEN_STATE_BLOB - 1])))
+    {
+        rslt = BME69X_E_CALIB_BLOB;
+    }
+
+    /* The sensor may be on either SPI memory page, whatever the page cache of dev holds */
+    if ((rslt == BME69X_OK) && (dev->intf == BME69X_SPI_INTF))
+    {
+        rslt = get_mem_page(dev);
+    }
+
+    if (rslt == BME69X_OK)
+    {
+        rslt = bme69x_get_regs(BME69X_REG_CHIP_ID, &chip_id, 1, dev);
+        if ((rslt == BME69X_OK) && (chip_id != state[1]))
+        {
+            rslt = BME69X_E_DEV_NOT_FOUND;
+        }
+    }
+
+    if (rslt == BME69X_OK)
+    {
+        dev->chip_id = chip_id;
+        dev->variant_id = state[2];
+        unpack_calib(&state[3], &dev->calib);
+
+        /* The sensor kept the registers written before the snapshot */
+        memcpy(dev->shadow, &state[3 + BME69X_LEN_CALIB_COEFF], BME69X_LEN_SHADOW);
+        dev->shadow_valid = 1;
+    }
+
+    stats_exit(prev_api, dev);
+
+    return rslt;
+}
+
+/*
+ * @brief This API calculates the duration of every step and of a whole cycle of an operation mode.
+ */
+int8_t bme69x_get_timing(uint8_t op_mode,
+                         struct bme69x_conf *conf,
+                         const struct bme69x_heatr_conf *heatr_conf,
+                         struct bme69x_timing *timing,
+                         struct bme69x_dev *dev)
+{
+    int8_t rslt;
+    uint8_t gas_wait[10] = { 0 };
+    uint8_t n_steps = 1;
+    uint8_t shd_heatr_dur = 0;
+    uint8_t i;
+
+    rslt = null_ptr_check(dev);
+    if ((rslt == BME69X_OK) && ((conf == NULL) || (heatr_conf == NULL) || (timing == NULL)))
+    {
+        rslt = BME69X_E_NULL_PTR;
+    }
+
+    if (rslt == BME69X_OK)
+    {
+        /* The register values bme69x_set_heatr_conf writes, the sensor runs their rounded durations */
+        switch (op_mode)
+        {
+            case BME69X_FORCED_MODE:
+                gas_wait[0] = calc_gas_wait(heatr_conf->heatr_dur);
+                break;
+            case BME69X_SEQUENTIAL_MODE:
+            case BME69X_PARALLEL_MODE:
+                if ((!heatr_conf->heatr_dur_prof) || (!heatr_conf->heatr_temp_prof))
+                {
+                    rslt = BME69X_E_NULL_PTR;
+                    break;
+                }
+
+                if (heatr_conf->profile_len > 10)
+                {
+                    rslt = BME69X_E_INVALID_LENGTH;
+                    break;
+                }
+
+                for (i = 0; i < heatr_conf->profile_len; i++)
+                {
+                    if (op_mode == BME69X_PARALLEL_MODE)
+                    {
+                        gas_wait[i] = (uint8_t)heatr_conf->heatr_dur_prof[i];
+                    }
+                    else
+                    {
+                        gas_wait[i] = calc_gas_wait(heatr_conf->heatr_dur_prof[i]);
+                    }
+                }
+
+                n_steps = heatr_conf->profile_len;
+                if (op_mode == BME69X_PARALLEL_MODE)
+                {
+                    shd_heatr_dur = calc_heatr_dur_shared(heatr_conf->shared_heatr_dur);
+                }
+
+                break;
+            default:
+                rslt = BME69X_W_DEFINE_OP_MODE;
+        }
+    }
+
+    if (rslt == BME69X_OK)
+    {
+        calc_timing(op_mode,
+                    conf,
+                    gas_wait,
+                    n_steps,
+                    shd_heatr_dur,
+                    heatr_conf->enable == BME69X_ENABLE,
+                    timing,
+                    dev);
+    }
+
+    return rslt;
+}
+
+/*
+ * @brief This API prepares a scheduler interleaving the forced mode measurements of several sensors.
+ */
+int8_t bme69x_sched_init(struct bme69x_sched *sched,
+                         struct bme69x_sched_sensor *sensors,
+                         uint8_t n_sensors,
+                         bme69x_sched_cb_t cb,
+                         void *cb_arg)
+{
+    int8_t rslt = BME69X_OK;
+    const struct bme69x_heatr_conf heatr_off = { 0 };
+    struct bme69x_sched_sensor *sensor;
+    struct bme69x_timing timing = { { 0 }, 0, 0, 0 };
+    uint64_t now;
+    uint32_t cycle;
+    uint8_t i;
+
+    if ((sched == NULL) || (sensors == NULL) || (cb == NULL))
+    {
+        return BME69X_E_NULL_PTR;
+    }
+
+    if ((n_sensors == 0) || (n_sensors == BME69X_SCHED_ALL))
+    {
+        return BME69X_E_INVALID_LENGTH;
+    }
+
+    for (i = 0; (i < n_sensors) && (rslt == BME69X_OK); i++)
+    {
+        rslt = null_ptr_check(sensors[i].dev);
+        if ((rslt == BME69X_OK) && ((sensors[i].conf == NULL) || (sensors[i].dev->get_time_us == NULL)))
+        {
+            rslt = BME69X_E_NULL_PTR;
+        }
+    }
+
+    if (rslt == BME69X_OK)
+    {
+        sched->sensors = sensors;
+        sched->n_sensors = n_sensors;
+        sched->cb = cb;
+        sched->cb_arg = cb_arg;
+        now = sched_now(sched);
+        sched->start_us = now;
+
+        for (i = 0; i < n_sensors; i++)
+        {
+            sensor = &sensors[i];
+
+            /* Spread the first triggers over the cycle, the longer of the period and the measurement */
+            (void) bme69x_get_timing(BME69X_FORCED_MODE,
+                                     sensor->conf,
+                                     sensor->heatr_conf ? sensor->heatr_conf : &heatr_off,
+                                     &timing,
+                                     sensor->dev);
+            cycle = timing.cycle_us;
+            if (sensor->period_us > cycle)
+            {
+                cycle = sensor->period_us;
+            }
+
+            sensor->state = BME69X_SCHED_IDLE;
+            sensor->trigger_us = now + ((uint64_t)cycle * i) / n_sensors;
+            sensor->next_us = sensor->trigger_us;
+            sensor->ready_us = 0;
+            sensor->samples = 0;
+            sensor->errors = 0;
+            sensor->overruns = 0;
+        }
+    }
+
+    return rslt;
+}
+
+/*
+ * @brief This API reads the sensors whose measurement ended and triggers those whose period started.
+ */
+int8_t bme69x_sched_poll(struct bme69x_sched *sched, uint32_t *wait_us)
+{
+    struct bme69x_sched_sensor *sensor;
+    struct bme69x_data data;
+    uint64_t now;
+    uint64_t next;
+    uint8_t n_data;
+    uint8_t i;
+    int8_t rslt;
+
+    if ((sched == NULL) || (sched->sensors == NULL) || (wait_us == NULL))
+    {
+        return BME69X_E_NULL_PTR;
+    }
+
+    for (i = 0; i < sched->n_sensors; i++)
+    {
+        sensor = &sched->sensors[i];
+        now = sched_now(sched);
+
+        if ((sensor->state == BME69X_SCHED_MEASURING) && (now >= sensor->next_us))
+        {
+            n_data = 0;
+            rslt = bme69x_try_collect(&data, &n_data, sensor->dev);
+            if ((rslt == BME69X_OK) && (n_data != 0))
+            {
+                sensor->samples++;
+                sched->cb(i, &data, now, sched->cb_arg);
+                sched_next_period(sensor, now);
+            }
+            else if ((rslt == BME69X_W_NO_NEW_DATA) && (now < sensor->ready_us + BME69X_SCHED_TIMEOUT_US))
+            {
+                sensor->next_us = now + BME69X_SCHED_RETRY_US;
+            }
+            else
+            {
+                sensor->errors++;
+                sched_next_period(sensor, now);
+            }
+        }
+
+        if ((sensor->state == BME69X_SCHED_IDLE) && (now >= sensor->next_us))
+        {
+            rslt = bme69x_trigger_forced(sensor->conf, sensor->heatr_conf, &sensor->ready_us, sensor->dev);
+            if (rslt == BME69X_OK)
+            {
+                sensor->state = BME69X_SCHED_MEASURING;
+                sensor->next_us = sensor->ready_us;
+            }
+            else
+            {
+                sensor->errors++;
+                sensor->next_us = now + BME69X_SCHED_RETRY_US;
+            }
+        }
+    }
+
+    next = sched->sensors[0].next_us;
+    for (i = 1; i < sched->n_sensors; i++)
+    {
+        if (sched->sensors[i].next_us < next)
+        {
+            next = sched->sensors[i].next_us;
+        }
+    }
+
+    now = sched_now(sched);
+    *wait_us = (next > now) ? (uint32_t)(next - now) : 0;
+
+    return BME69X_OK;
+}
+
+/*
+ * @brief This API polls a scheduler for a duration, sleeping between polls.
+ */
+int8_t bme69x_sched_run(struct bme69x_sched *sched, uint32_t duration_us)
+{
+    int8_t rslt = BME69X_OK;
+    uint64_t end;
+    uint64_t now;
+    uint32_t wait_us = 0;
+
+    if ((sched == NULL) || (sched->sensors == NULL) || (sched->sensors[0].dev->delay_us == NULL))
+    {
+        return BME69X_E_NULL_PTR;
+    }
+
+    end = sched_now(sched) + duration_us;
+    for (now = sched_now(sched); (now < end) && (rslt == BME69X_OK); now = sched_now(sched))
+    {
+        rslt = bme69x_sched_poll(sched, &wait_us);
+        if ((rslt == BME69X_OK) && (wait_us > 0))
+        {
+            now = sched_now(sched);
+            if (now + wait_us > end)
+            {
+                wait_us = (now < end) ? (uint32_t)(end - now) : 0;
+            }
+
+            sched->sensors[0].dev->delay_us(wait_us, sched->sensors[0].dev->intf_ptr);
+        }
+    }
+
+    return rslt;
+}
+
+/*
+ * @brief This API reports the sample rate achieved by one sensor or by all sensors of a scheduler.
+ */
+int8_t bme69x_sched_get_rate(const struct bme69x_sched *sched, uint8_t sensor, uint32_t *rate_mhz)
+{
+    uint64_t samples = 0;
+    uint64_t elapsed;
+    uint8_t i;
+
+    if ((sched == NULL) || (sched->sensors == NULL) || (rate_mhz == NULL))
+    {
+        return BME69X_E_NULL_PTR;
+    }
+
+    if ((sensor >= sched->n_sensors) && (sensor != BME69X_SCHED_ALL))
+    {
+        return BME69X_E_INVALID_LENGTH;
+    }
+
+    for (i = 0; i < sched->n_sensors; i++)
+    {
+        if ((sensor == BME69X_SCHED_ALL) || (sensor == i))
+        {
+            samples += sched->sensors[i].samples;
+        }
+    }
+
+    elapsed = sched_now(sched) - sched->start_us;
+    *rate_mhz = (elapsed > 0) ? (uint32_t)((samples * UINT64_C(1000000000)) / elapsed) : 0;
+
+    return BME69X_OK;
+}
+
+/*
+ * @brief This API starts the heater profile in sequential mode and prepares the engine reading its steps.
+ */
+int8_t bme69x_seq_start(struct bme69x_seq *seq, bme69x_seq_cb_t cb, void *cb_arg, struct bme69x_dev *dev)
+{
+    int8_t rslt;
+    struct bme69x_conf conf;
+    uint8_t regs[BME69X_LEN_SHADOW];
+    uint8_t ctrl_gas_0;
+    uint8_t ctrl_gas_1;
+    uint8_t gas_on;
+
+    if ((seq == NULL) || (cb == NULL))
+    {
+        return BME69X_E_NULL_PTR;
+    }
+
+    rslt = null_ptr_check(dev);
+    if ((rslt != BME69X_OK) || (dev->get_time_us == NULL))
+    {
+        return BME69X_E_NULL_PTR;
+    }
+
+    /* The profile is read and started in one hold of the lock */
+    dev_lock(dev);
+    rslt = bme69x_get_conf(&conf, dev);
+
+    if (rslt == BME69X_OK)
+    {
+        if (dev->shadow_valid)
+        {
+            memcpy(regs, dev->shadow, BME69X_LEN_SHADOW);
+        }
+        else
+        {
+            rslt = bme69x_get_regs(BME69X_REG_IDAC_HEAT0, regs, BME69X_LEN_SHADOW, dev);
+        }
+    }
+
+    if (rslt == BME69X_OK)
+    {
+        /* The profile as programmed */
+        ctrl_gas_0 = regs[BME69X_REG_CTRL_GAS_0 - BME69X_REG_IDAC_HEAT0];
+        ctrl_gas_1 = regs[BME69X_REG_CTRL_GAS_1 - BME69X_REG_IDAC_HEAT0];
+        gas_on = (BME69X_GET_BITS(ctrl_gas_1, BME69X_RUN_GAS) == BME69X_ENABLE_GAS_MEAS) &&
+                 (BME69X_GET_BITS(ctrl_gas_0, BME69X_HCTRL) == BME69X_ENABLE_HEATER);
+        calc_timing(BME69X_SEQUENTIAL_MODE,
+                    &conf,
+                    &regs[BME69X_REG_GAS_WAIT0 - BME69X_REG_IDAC_HEAT0],
+                    BME69X_GET_BITS_POS_0(ctrl_gas_1, BME69X_NBCONV),
+                    0,
+                    gas_on,
+                    &seq->timing,
+                    dev);
+        rslt = bme69x_set_op_mode(BME69X_SEQUENTIAL_MODE, dev);
+    }
+
+    dev_unlock(dev);
+
+    if (rslt == BME69X_OK)
+    {
+        seq->dev = dev;
+        seq->cb = cb;
+        seq->cb_arg = cb_arg;
+        seq->started = 0;
+        seq->last_index = 0;
+        seq->seq = 0;
+        seq->start_us = dev->get_time_us(dev->intf_ptr);
+        seq->nominal_us = 0;
+        seq->scale_lo = (UINT32_C(1) << BME69X_SEQ_SCALE_SHIFT) / 100 * (100 - BME69X_SEQ_TIMING_TOL_PCT);
+        seq->scale_hi = (UINT32_C(1) << BME69X_SEQ_SCALE_SHIFT) / 100 * (100 + BME69X_SEQ_TIMING_TOL_PCT);
+        seq->read_us = seq->start_us;
+        seq->samples = 0;
+        seq->lost = 0;
+        seq->polls = 0;
+        seq->errors = 0;
+        seq_next_read(seq, seq->start_us);
+    }
+
+    return rslt;
+}
+
+/*
+ * @brief This API reads the steps of the sequential profile that ended, once three of them are buffered.
+ */
+int8_t bme69x_seq_poll(struct bme69x_seq *seq, uint32_t *wait_us)
+{
+    struct bme69x_data data[3];
+    struct bme69x_dev *dev;
+    uint64_t nominal[3];
+    uint32_t step[3];
+    uint8_t new_data[3];
+    uint64_t read_us;
+    uint64_t now;
+    uint64_t time_us;
+    uint32_t scale;
+    uint8_t n_data = 0;
+    uint8_t n_new = 0;
+    uint8_t delta;
+    uint8_t i;
+    int8_t rslt;
+
+    if ((seq == NULL) || (seq->dev == NULL) || (wait_us == NULL))
+    {
+        return BME69X_E_NULL_PTR;
+    }
+
+    dev = seq->dev;
+    read_us = dev->get_time_us(dev->intf_ptr);
+    if (read_us >= seq->next_us)
+    {
+        seq->polls++;
+        rslt = bme69x_get_data(BME69X_SEQUENTIAL_MODE, data, &n_data, dev);
+        now = dev->get_time_us(dev->intf_ptr);
+        if ((rslt == BME69X_OK) || (rslt == BME69X_W_NO_NEW_DATA))
+        {
+            /* Number the new steps, the fields come sorted by meas_index, oldest first */
+            for (i = 0; i < n_data; i++)
+            {
+                if (seq->started)
+                {
+                    /* meas_index counts every step the sensor ran, a jump means steps were overwritten */
+                    delta = (uint8_t)(data[i].meas_index - seq->last_index);
+                    if ((delta == 0) || (delta > 128))
+                    {
+                        /* Delivered by an earlier read */
+                        continue;
+                    }
+
+                    delta--;
+                }
+                else
+                {
+                    /* Before the first step only the profile step tells how many were missed */
+                    delta = (uint8_t)((data[i].gas_index + seq->timing.n_steps - (seq->seq % seq->timing.n_steps)) %
+                                      seq->timing.n_steps);
+                }
+
+                for (; delta > 0; delta--)
+                {
+                    seq->nominal_us = seq_nominal_end(seq, seq->seq);
+                    seq->seq++;
+                    seq->lost++;
+                }
+
+                seq->nominal_us = seq_nominal_end(seq, seq->seq);
+                seq->last_index = data[i].meas_index;
+                seq->started = 1;
+                new_data[n_new] = i;
+                nominal[n_new] = seq->nominal_us;
+                step[n_new] = seq->seq;
+                n_new++;
+                seq->seq++;
+            }
+
+            seq_update_scale(seq, (n_new > 0) ? nominal[n_new - 1] : 0, read_us, now);
+
+            /* The datasheet timing unless the reads rule it out. Each step ended after the previous read missed it
+             * and before this one found it */
+            scale = UINT32_C(1) << BME69X_SEQ_SCALE_SHIFT;
+            if ((scale < seq->scale_lo) || (scale > seq->scale_hi))
+            {
+                scale = seq->scale_lo + (seq->scale_hi - seq->scale_lo) / 2;
+            }
+
+            for (i = 0; i < n_new; i++)
+            {
+                time_us = seq_time(seq, nominal[i], scale);
+                if (time_us > now)
+                {
+                    time_us = now;
+                }
+                else if (time_us < seq->read_us)
+                {
+                    time_us = seq->read_us;
+                }
+
+                seq->cb(&data[new_data[i]], step[i], time_us, seq->cb_arg);
+                seq->samples++;
+            }
+
+            seq->read_us = read_us;
+            if (seq->nominal_us >= BME69X_SEQ_REBASE_US)
+            {
+                /* Keep the products of the time scale within 64 bits */
+                seq->start_us = seq_time(seq, seq->nominal_us, scale);
+                seq->nominal_us = 0;
+            }
+        }
+        else
+        {
+            seq->errors++;
+        }
+
+        seq_next_read(seq, now);
+    }
+
+    now = dev->get_time_us(dev->intf_ptr);
+    *wait_us = (seq->next_us > now) ? (uint32_t)(seq->next_us - now) : 0;
+
+    return BME69X_OK;
+}
+
+/*
+ * @brief This API polls the sequential profile engine for a duration, sleeping between polls.
+ */
+int8_t bme69x_seq_run(struct bme69x_seq *seq, uint32_t duration_us)
+{
+    int8_t rslt = BME69X_OK;
+    struct bme69x_dev *dev;
+    uint64_t end;
+    uint64_t now;
+    uint32_t wait_us = 0;
+
+    if ((seq == NULL) || (seq->dev == NULL) || (seq->dev->delay_us == NULL))
+    {
+        return BME69X_E_NULL_PTR;
+    }
+
+    dev = seq->dev;
+    end = dev->get_time_us(dev->intf_ptr) + duration_us;
+    for (now = dev->get_time_us(dev->intf_ptr); (now < end) && (rslt == BME69X_OK);
+         now = dev->get_time_us(dev->intf_ptr))
+    {
+        rslt = bme69x_seq_poll(seq, &wait_us);
+        if ((rslt == BME69X_OK) && (wait_us > 0))
+        {
+            now = dev->get_time_us(dev->intf_ptr);
+            if (now + wait_us > end)
+            {
+                wait_us = (now < end) ? (uint32_t)(end - now) : 0;
+            }
+
+            dev->delay_us(wait_us, dev->intf_ptr);
+        }
+    }
+
+    return rslt;
+}
+
+/*****************************INTERNAL APIs***********************************************/
+#ifndef BME69X_USE_FPU
+
+/* @brief This internal API is used to calculate the temperature value. */
+static int16_t calc_temperature(uint32_t temp_adc, const struct bme69x_calib_data *calib, int32_t *t_lin)
+{
+    int64_t partial_data1;
+    int64_t partial_data2;
+    int64_t partial_data3;
     int64_t partial_data4;
     int64_t partial_data5;
     int64_t partial_data6;
     int64_t tem_comp;
 
-    partial_data1 = (int64_t)(temp_adc - (256U * dev->calib.par_t1));
-    partial_data2 = (int64_t)(partial_data1 * (int64_t)dev->calib.par_t2);
+    /* Signed difference, the ADC reading is below 256 * par_t1 for temperatures under 0 degC */
+    partial_data1 = (int64_t)temp_adc - ((int64_t)calib->par_t1 * 256);
+    partial_data2 = (int64_t)(partial_data1 * (int64_t)calib->par_t2);
     partial_data3 = (int64_t)(partial_data1 * partial_data1);
-    partial_data4 = (int64_t)(partial_data3 * (int64_t)dev->calib.par_t3);
-    partial_data5 = (int64_t)((int64_t)(partial_data2 * 262144UL) + partial_data4);
-    partial_data6 = (int64_t)(partial_data5 / 4294967296ULL);
-    *t_lin = (uint32_t)partial_data6;
-    tem_comp = (int64_t)((partial_data6 * 25U) / 16384UL);
+    partial_data4 = (int64_t)(partial_data3 * (int64_t)calib->par_t3);
+    partial_data5 = (int64_t)((int64_t)(partial_data2 * INT64_C(262144)) + partial_data4);
+
+    /* Signed divisors, an unsigned one would convert a temperature below 0 degC to a huge positive value */
+    partial_data6 = (int64_t)(partial_data5 / INT64_C(4294967296));
+    *t_lin = (int32_t)partial_data6;
+    tem_comp = (int64_t)((partial_data6 * 25) / INT64_C(16384));
 
     return (int16_t)(tem_comp);
 }
 
 /* @brief This internal API is used to calculate the pressure value. */
-static uint32_t calc_pressure(uint32_t pres_adc, uint32_t t_lin, const struct bme69x_dev *dev)
+static uint32_t calc_pressure(uint32_t pres_adc, int32_t t_lin, const struct bme69x_calib_data *calib)
 {
     int64_t partial_data1;
     int64_t partial_data2;
@@ -862,26 +2195,26 @@ static uint32_t calc_pressure(uint32_t pres_adc, uint32_t t_lin, const struct bm
     partial_data1 = t_lin_64 * t_lin_64;
     partial_data2 = partial_data1 / 64;
     partial_data3 = partial_data2 * t_lin_64 / 256;
-    partial_data4 = dev->calib.par_p4 * partial_data3 / 32;
-    partial_data5 = dev->calib.par_p3 * partial_data1 * 16;
-    partial_data6 = dev->calib.par_p2 * t_lin_64 * (1 << 22);
+    partial_data4 = calib->par_p4 * partial_data3 / 32;
+    partial_data5 = calib->par_p3 * partial_data1 * 16;
+    partial_data6 = calib->par_p2 * t_lin_64 * (1 << 22);
 
-    offset = dev->calib.par_p1 * ((int64_t)1 << 47) + partial_data4 + partial_data5 + partial_data6;
-    partial_data2 = (dev->calib.par_p8 * partial_data3) / (1 << 5);
-    partial_data4 = dev->calib.par_p7 * partial_data1 * (1 << 2);
+    offset = calib->par_p1 * ((int64_t)1 << 47) + partial_data4 + partial_data5 + partial_data6;
+    partial_data2 = (calib->par_p8 * partial_data3) / (1 << 5);
+    partial_data4 = calib->par_p7 * partial_data1 * (1 << 2);
 
-    partial_data5 = (dev->calib.par_p6 - 16384) * t_lin_64 * (1 << 21);
-    sensitivity = (dev->calib.par_p5 - 16384) * ((int64_t)1 << 46) + partial_data2 + partial_data4 + partial_data5;
+    partial_data5 = (calib->par_p6 - 16384) * t_lin_64 * (1 << 21);
+    sensitivity = (calib->par_p5 - 16384) * ((int64_t)1 << 46) + partial_data2 + partial_data4 + partial_data5;
     partial_data1 = sensitivity / (1 << 24) * pres_adc;
 
-    partial_data2 = dev->calib.par_p10 * t_lin_64;
-    partial_data3 = partial_data2 + dev->calib.par_p9 * (1 << 16);
+    partial_data2 = calib->par_p10 * t_lin_64;
+    partial_data3 = partial_data2 + calib->par_p9 * (1 << 16);
     partial_data4 = partial_data3 * pres_adc / (1 << 13);
     partial_data5 = (pres_adc * partial_data4 / 10) / (1 << 9);
     partial_data5 = partial_data5 * 10;
-    partial_data6 = pres_adc * pres_adc;
+    partial_data6 = (int64_t)pres_adc * pres_adc;
 
-    partial_data2 = dev->calib.par_p11 * partial_data6 / (1 << 16);
+    partial_data2 = calib->par_p11 * partial_data6 / (1 << 16);
     partial_data3 = partial_data2 * pres_adc / (1 << 7);
     partial_data4 = offset / 4 + partial_data1 + partial_data5 + partial_data3;
 
@@ -891,23 +2224,38 @@ static uint32_t calc_pressure(uint32_t pres_adc, uint32_t t_lin, const struct bm
 }
 
 /* This internal API is used to calculate the humidity in integer */
-static uint32_t calc_humidity(uint16_t hum_adc, int16_t comp_temperature, const struct bme69x_dev *dev)
+static uint32_t calc_humidity(uint16_t hum_adc, int32_t t_lin, const struct bme69x_calib_data *calib)
 {
-    uint32_t hum_comp;
-    int64_t hum_64 = hum_adc;
-    int64_t t_comp = comp_temperature;
-    int64_t t_fine = (t_comp * 256 - 128) / 5;
-    int64_t var_H = t_fine - 76800UL;
+    int64_t hoff;
+    int64_t hsens;
+    int64_t var_H;
+
+    /* t_lin is the temperature x65536, the humidity terms are centred on 15 degC x5120 */
+    var_H = (((int64_t)t_lin * 5) / 64) - 76800;
+
+    /* Offset corrected humidity x256 */
+    hoff = (((int64_t)hum_adc * 16384) - ((int64_t)calib->par_h1 * 1048576) - (calib->par_h2 * var_H)) / 64;
+
+    /* Sensitivity x2^19 */
+    hsens = ((((((var_H * calib->par_h4) / 1024) * ((var_H * calib->par_h3) / 2048 + 32768)) / 1024) +
+              2097152) * calib->par_h5 + 512) / 1024;
 
-    var_H =
-        (((((hum_64 * 16384UL) - (dev->calib.par_h1 * 1048576UL) - (dev->calib.par_h2 * var_H)) + 16384UL) / 32768UL) *
-         ((((((var_H * dev->calib.par_h4) / 1024UL) * ((var_H * dev->calib.par_h3) / 2048UL + 32768UL)) / 1024UL) +
-           2097152ULL) * dev->calib.par_h5 + 8192UL) / 16384UL);
+    /* Linearised relative humidity x2^35 */
+    var_H = hoff * hsens;
+    var_H = var_H - ((((var_H / 1048576) * (var_H / 1048576)) * calib->par_h6) / 16384);
 
-    var_H = var_H - (((((var_H / 32768UL) * (var_H / 32768UL)) / 128UL) * dev->calib.par_h6) / 16UL);
-    hum_comp = (uint32_t)(var_H / 4096UL);
+    /* Saturate to the 0 to 100 %rH output range */
+    var_H = (var_H * 1000) / 34359738368;
+    if (var_H < 0)
+    {
+        var_H = 0;
+    }
+    else if (var_H > 100000)
+    {
+        var_H = 100000;
+    }
 
-    return hum_comp;
+    return (uint32_t)var_H;
 }
 
 /* This internal API is used to calculate the gas resistance */
@@ -920,9 +2268,8 @@ static uint32_t calc_gas_resistance(uint16_t gas_res_adc, uint8_t gas_range)
     var2 *= INT32_C(3);
     var2 = INT32_C(4096) + var2;
 
-    /* multiplying 10000 then dividing then multiplying by 100 instead of multiplying by 1000000 to prevent overflow */
-    calc_gas_res = (UINT32_C(10000) * var1) / (uint32_t)var2;
-    calc_gas_res = calc_gas_res * 100;
+    /* 64 bit intermediate, scaling by 10000 and then 100 lost up to 100 Ohms on the high gas ranges */
+    calc_gas_res = (uint32_t)((UINT64_C(1000000) * var1) / (uint32_t)var2);
 
     return calc_gas_res;
 }
@@ -930,120 +2277,112 @@ static uint32_t calc_gas_resistance(uint16_t gas_res_adc, uint8_t gas_range)
 /* This internal API is used to calculate the heater resistance value using integer */
 static uint8_t calc_res_heat(uint16_t temp, const struct bme69x_dev *dev)
 {
-    uint8_t heatr_res;
-    int32_t var1;
-    int32_t var2;
-    int32_t var3;
-    int32_t var4;
-    int32_t var5;
-    int32_t heatr_res_x100;
+    int64_t var1;
+    int64_t var2;
+    int64_t var3;
+    int64_t var4;
 
     if (temp > 400) /* Cap temperature */
     {
         temp = 400;
     }
 
-    var1 = (((int32_t)dev->amb_temp * dev->calib.par_g3) / 1000U) * 256; /* par_g1 */
-    var2 = (dev->calib.par_g1 + 784) * (((((dev->calib.par_g2 + 154009UL) * temp * 5) / 100) + 3276800ULL) / 10); /* par_g2,
-                                                                                                                   * par_g3 */
-    var3 = var1 + (var2 >> 1);
-    var4 = (var3 / (dev->calib.res_heat_range + 4));
-    var5 = (131 * dev->calib.res_heat_val) + 65536UL;
-    heatr_res_x100 = (int32_t)(((var4 / var5) - 250) * 34);
-    heatr_res = (uint8_t)((heatr_res_x100 + 50) / 100);
+    /*
+     * Same formula as the floating point path, scaled by 1024 * 327680000 so that it is exact:
+     * var1 = 16 * (par_g1 / 16 + 49)
+     * var2 = 327680000 * (par_g2 / 32768 * 0.0005 + 0.00235)
+     */
+    var1 = (int64_t)dev->calib.par_g1 + 784;
+    var2 = ((int64_t)dev->calib.par_g2 * 5) + 770048;
+    var3 = var1 * (327680000 + var2 * temp) * 64 + (int64_t)dev->calib.par_g3 * dev->amb_temp * 327680000;
 
-    return heatr_res;
+    /* 4 / (4 + res_heat_range) / (1 + res_heat_val * 0.002), then 3.4 * (x - 25) truncated like the float path */
+    var4 = (var3 * 2000) / ((int64_t)(4 + dev->calib.res_heat_range) * (500 + dev->calib.res_heat_val));
+
+    return (uint8_t)((34 * (var4 - (int64_t)25 * 335544320000)) / 3355443200000);
 }
 
 #else
 
-/* @brief This internal API is used to calculate the temperature value. */
-static float calc_temperature(uint32_t temp_adc, const struct bme69x_dev *dev)
+/* This internal API is used to scale the calibration coefficients for the floating point compensation */
+static void calc_calib_fpu(struct bme69x_calib_data *calib)
 {
-    int32_t do1, cf;
-    double dtk1, dtk2, temp1, temp2;
-    double calc_temp;
+    struct bme69x_calib_fpu *fpu = &calib->fpu;
 
-    do1 = (int32_t)dev->calib.par_t1 << 8;
-    dtk1 = (double)dev->calib.par_t2 / (double)(1ULL << 30);
-    dtk2 = (double)dev->calib.par_t3 / (double)(1ULL << 48);
+    fpu->do1 = (int32_t)calib->par_t1 << 8;
+    fpu->dtk1 = (double)calib->par_t2 / (double)(1ULL << 30);
+    fpu->dtk2 = (double)calib->par_t3 / (double)(1ULL << 48);
 
-    cf = temp_adc - do1;
-    temp1 = (double)(cf * dtk1);
-    temp2 = (double)cf * (double)cf * dtk2;
+    fpu->o = (double)((uint32_t)calib->par_p1 * (uint32_t)(1ULL << 3));
+    fpu->tk10 = (double)calib->par_p2 / (double)(1ULL << 6);
+    fpu->tk20 = (double)calib->par_p3 / (double)(1ULL << 8);
+    fpu->tk30 = (double)calib->par_p4 / (double)(1ULL << 15);
 
-    calc_temp = temp1 + temp2;
+    fpu->s = ((double)calib->par_p5 - (double)(1ULL << 14)) / (double)(1ULL << 20);
+    fpu->tk1s = ((double)calib->par_p6 - (double)(1ULL << 14)) / (double)(1ULL << 29);
+    fpu->tk2s = (double)calib->par_p7 / (double)(1ULL << 32);
+    fpu->tk3s = (double)calib->par_p8 / (double)(1ULL << 37);
 
-    return (float)calc_temp;
-}
-
-/* @brief This internal API is used to calculate the pressure value. */
-static float calc_pressure(uint32_t pres_adc, float comp_temperature, const struct bme69x_dev *dev)
-{
-    uint32_t o;
-    double tk10, tk20, tk30;
-    double s;
-    double tk1s, tk2s, tk3s;
-    double nls, tknls, nls3;
-    double calc_pres, tmp1, tmp2, tmp3, tmp4;
-
-    o = (uint32_t)dev->calib.par_p1 * (uint32_t)(1ULL << 3);
-    tk10 = (double)dev->calib.par_p2 / (double)(1ULL << 6);
-    tk20 = (double)dev->calib.par_p3 / (double)(1ULL << 8);
-    tk30 = (double)dev->calib.par_p4 / (double)(1ULL << 15);
-
-    s = ((double)dev->calib.par_p5 - (double)(1ULL << 14)) / (double)(1ULL << 20);
-    tk1s = ((double)dev->calib.par_p6 - (double)(1ULL << 14)) / (double)(1ULL << 29);
-    tk2s = (double)dev->calib.par_p7 / (double)(1ULL << 32);
-    tk3s = (double)dev->calib.par_p8 / (double)(1ULL << 37);
-
-    nls = (double)dev->calib.par_p9 / (double)(1ULL << 48);
-    tknls = (double)dev->calib.par_p10 / (double)(1ULL << 48);
+    fpu->nls = (double)calib->par_p9 / (double)(1ULL << 48);
+    fpu->tknls = (double)calib->par_p10 / (double)(1ULL << 48);
 
     /*
      * NLS3 = par_p11 / 2^65
      * 2^65 is exceeding the width of 'double' datatype and hence we splitted into two factors since A^(x+y) = A^x * A^y
      */
-    nls3 = (double)dev->calib.par_p11 / ((double)(1ULL << 35) * (double)(1ULL << 30));
+    fpu->nls3 = (double)calib->par_p11 / ((double)(1ULL << 35) * (double)(1ULL << 30));
+
+    fpu->oh = (double)calib->par_h1 * (double)(1ULL << 6);
+    fpu->sh = (double)calib->par_h5 / (double)(1ULL << 16);
+    fpu->tk10h = (double)calib->par_h2 / (double)(1ULL << 14);
+    fpu->tk1sh = (double)calib->par_h4 / (double)(1ULL << 26);
+    fpu->tk12sh = fpu->tk1sh * ((double)calib->par_h3 / (double)(1ULL << 26));
+    fpu->hlin2 = (double)calib->par_h6 / (double)(1ULL << 19);
+
+    fpu->g1 = (((float)calib->par_g1 / (16.0f)) + 49.0f);
+    fpu->g2 = ((((float)calib->par_g2 / (32768.0f)) * (0.0005f)) + 0.00235f);
+    fpu->g3 = ((float)calib->par_g3 / (1024.0f));
+    fpu->res_heat_scale = (4 / (4 + (float)calib->res_heat_range)) * (1 / (1 + ((float)calib->res_heat_val * 0.002f)));
+}
 
-    tmp1 = (double)o + (tk10 * comp_temperature) + (tk20 * comp_temperature * comp_temperature) +
-           (tk30 * comp_temperature * comp_temperature * comp_temperature);
+/* @brief This internal API is used to calculate the temperature value. */
+static float calc_temperature(uint32_t temp_adc, const struct bme69x_calib_data *calib)
+{
+    const struct bme69x_calib_fpu *fpu = &calib->fpu;
+    double cf;
 
-    tmp2 = (double)pres_adc *
-           ((double)s + (tk1s * comp_temperature) + (tk2s * comp_temperature * comp_temperature) +
-            (tk3s * comp_temperature * comp_temperature * comp_temperature));
+    cf = (double)(int32_t)(temp_adc - (uint32_t)fpu->do1);
+
+    return (float)(cf * (fpu->dtk1 + cf * fpu->dtk2));
+}
 
-    tmp3 = (double)pres_adc * (double)pres_adc * (nls + (tknls * comp_temperature));
-    tmp4 = (double)pres_adc * (double)pres_adc * (double)pres_adc * nls3;
+/* @brief This internal API is used to calculate the pressure value. */
+static float calc_pressure(uint32_t pres_adc, float comp_temperature, const struct bme69x_calib_data *calib)
+{
+    const struct bme69x_calib_fpu *fpu = &calib->fpu;
+    double t = comp_temperature;
+    double p = (double)pres_adc;
+    double offset, sens, nls;
 
-    calc_pres = tmp1 + tmp2 + tmp3 + tmp4;
+    offset = fpu->o + t * (fpu->tk10 + t * (fpu->tk20 + t * fpu->tk30));
+    sens = fpu->s + t * (fpu->tk1s + t * (fpu->tk2s + t * fpu->tk3s));
+    nls = fpu->nls + fpu->tknls * t + fpu->nls3 * p;
 
-    return (float)calc_pres;
+    return (float)(offset + p * (sens + p * nls));
 }
 
-/* This internal API is used to calculate the humidity in integer */
-static float calc_humidity(uint16_t hum_adc, float comp_temperature, const struct bme69x_dev *dev)
+/* This internal API is used to calculate the humidity in float */
+static float calc_humidity(uint16_t hum_adc, float comp_temperature, const struct bme69x_calib_data *calib)
 {
-    double oh, tk10h, sh;
-    double tk1sh, tk2sh, hlin2;
-    double hoff, hsens;
-    double temp_comp, calc_hum, temp_var_1;
-
-    temp_comp = (comp_temperature * 5120) - 76800;
+    const struct bme69x_calib_fpu *fpu = &calib->fpu;
+    double temp_comp, hoff, hsens;
 
-    oh = (double)dev->calib.par_h1 * (double)(1ULL << 6);
-    sh = (double)dev->calib.par_h5 / (double)(1ULL << 16);
-    tk10h = (double)dev->calib.par_h2 / (double)(1ULL << 14);
-    tk1sh = (double)dev->calib.par_h4 / (double)(1ULL << 26);
-    tk2sh = (double)dev->calib.par_h3 / (double)(1ULL << 26);
-    hlin2 = (double)dev->calib.par_h6 / (double)(1ULL << 19);
+    temp_comp = ((double)comp_temperature * 5120) - 76800;
 
-    hoff = (double)hum_adc - (oh + tk10h * temp_comp);
-    hsens = hoff * sh * (1 + (tk1sh * temp_comp) + (tk1sh * tk2sh * temp_comp * temp_comp));
-    temp_var_1 = hsens * (1 - hlin2 * hsens);
-    calc_hum = temp_var_1;
+    hoff = (double)hum_adc - (fpu->oh + fpu->tk10h * temp_comp);
+    hsens = hoff * fpu->sh * (1 + temp_comp * (fpu->tk1sh + fpu->tk12sh * temp_comp));
 
-    return (float)calc_hum;
+    return (float)(hsens * (1 - fpu->hlin2 * hsens));
 }
 
 /* This internal API is used to calculate the gas resistance value for BME69x variant in float */
@@ -1065,38 +2404,207 @@ static float calc_gas_resistance(uint16_t gas_res_adc, uint8_t gas_range)
 /* This internal API is used to calculate the heater resistance value using float */
 static uint8_t calc_res_heat(uint16_t temp, const struct bme69x_dev *dev)
 {
-    float var1;
-    float var2;
-    float var3;
-    float var4;
+    const struct bme69x_calib_fpu *fpu = &dev->calib.fpu;
     float var5;
-    uint8_t res_heat;
 
     if (temp > 400) /* Cap temperature */
     {
         temp = 400;
     }
 
-    var1 = (((float)dev->calib.par_g1 / (16.0f)) + 49.0f);
-    var2 = ((((float)dev->calib.par_g2 / (32768.0f)) * (0.0005f)) + 0.00235f);
-    var3 = ((float)dev->calib.par_g3 / (1024.0f));
-    var4 = (var1 * (1.0f + (var2 * (float)temp)));
-    var5 = (var4 + (var3 * (float)dev->amb_temp));
-    res_heat =
-        (uint8_t)(3.4f *
-                  ((var5 * (4 / (4 + (float)dev->calib.res_heat_range)) *
-                    (1 / (1 + ((float)dev->calib.res_heat_val * 0.002f)))) -
-                   25));
+    var5 = (fpu->g1 * (1.0f + (fpu->g2 * (float)temp))) + (fpu->g3 * (float)dev->amb_temp);
 
-    return res_heat;
+    return (uint8_t)(3.4f * ((var5 * fpu->res_heat_scale) - 25));
 }
 
 #endif
 
+/* This internal API is used to get the heater resistance code of a temperature, from the lookup table when set */
+static uint8_t get_res_heat(uint16_t temp, const struct bme69x_dev *dev)
+{
+    struct bme69x_heatr_lut *lut = dev->heatr_lut;
+    int16_t amb_diff;
+    uint16_t i;
+
+    if (temp > BME69X_HEATR_LUT_MAX_TEMP) /* Cap temperature */
+    {
+        temp = BME69X_HEATR_LUT_MAX_TEMP;
+    }
+
+    if ((lut == NULL) || (temp < BME69X_HEATR_LUT_MIN_TEMP))
+    {
+        return calc_res_heat(temp, dev);
+    }
+
+    amb_diff = (int16_t)dev->amb_temp - lut->amb_temp;
+    if (!lut->valid || (amb_diff > BME69X_HEATR_LUT_AMB_TOL) || (amb_diff < -BME69X_HEATR_LUT_AMB_TOL))
+    {
+        for (i = 0; i < BME69X_HEATR_LUT_LEN; i++)
+        {
+            lut->res_heat[i] = calc_res_heat(BME69X_HEATR_LUT_MIN_TEMP + i, dev);
+        }
+
+        lut->amb_temp = dev->amb_temp;
+        lut->valid = 1;
+    }
+
+    return lut->res_heat[temp - BME69X_HEATR_LUT_MIN_TEMP];
+}
+
+/* This internal API is used to read the time base of a scheduler */
+static uint64_t sched_now(const struct bme69x_sched *sched)
+{
+    const struct bme69x_dev *dev = sched->sensors[0].dev;
+
+    return dev->get_time_us(dev->intf_ptr);
+}
+
+/* This internal API is used to schedule the next trigger of a sensor once its measurement is over */
+static void sched_next_period(struct bme69x_sched_sensor *sensor, uint64_t now)
+{
+    sensor->state = BME69X_SCHED_IDLE;
+    if (sensor->period_us == 0)
+    {
+        sensor->trigger_us = now;
+    }
+    else
+    {
+        /* Keep the phase of the period, restart from now when the measurement ran over it */
+        sensor->trigger_us += sensor->period_us;
+        if (sensor->trigger_us < now)
+        {
+            sensor->overruns++;
+            sensor->trigger_us = now;
+        }
+    }
+
+    sensor->next_us = sensor->trigger_us;
+}
+
+/* This internal API is used to get the datasheet time from the time base to the end of a step of a sequential
+ * profile */
+static uint64_t seq_nominal_end(const struct bme69x_seq *seq, uint32_t step)
+{
+    uint64_t end = seq->nominal_us;
+    uint32_t i;
+
+    for (i = seq->seq; i <= step; i++)
+    {
+        /* The sensor stands by for the ODR time before it runs the profile again */
+        if ((i != 0) && ((i % seq->timing.n_steps) == 0))
+        {
+            end += seq->timing.standby_us;
+        }
+
+        end += seq->timing.step_us[i % seq->timing.n_steps];
+    }
+
+    return end;
+}
+
+/* This internal API is used to convert a datasheet time of a sequential profile into device time */
+static uint64_t seq_time(const struct bme69x_seq *seq, uint64_t nominal_us, uint32_t scale)
+{
+    return seq->start_us + ((nominal_us * scale) >> BME69X_SEQ_SCALE_SHIFT);
+}
+
+/* This internal API is used to narrow the timing scale of a sequential profile with the result of a read */
+static void seq_update_scale(struct bme69x_seq *seq, uint64_t found_us, uint64_t read_us, uint64_t now)
+{
+    uint64_t missing_us = seq_nominal_end(seq, seq->seq);
+    uint32_t hi = seq->scale_hi;
+    uint32_t lo;
+
+    /* The last step found ended before the read finished */
+    if (found_us > 0)
+    {
+        hi = (uint32_t)(((now - seq->start_us) << BME69X_SEQ_SCALE_SHIFT) / found_us);
+    }
+
+    /* The next step had not ended when the read started */
+    lo = (uint32_t)(((read_us - seq->start_us) << BME69X_SEQ_SCALE_SHIFT) / missing_us) + 1;
+
+    if ((hi < seq->scale_lo) || (lo > seq->scale_hi))
+    {
+        /* The timing changed, start again from this read */
+        seq->scale_lo = lo;
+        seq->scale_hi = (found_us > 0) ? hi : lo + lo / 100 * BME69X_SEQ_TIMING_TOL_PCT;
+    }
+    else
+    {
+        seq->scale_lo = (lo > seq->scale_lo) ? lo : seq->scale_lo;
+        seq->scale_hi = (hi < seq->scale_hi) ? hi : seq->scale_hi;
+    }
+}
+
+/* This internal API is used to schedule the next read of a sequential profile, when the next three steps are
+ * buffered */
+static void seq_next_read(struct bme69x_seq *seq, uint64_t now)
+{
+    uint32_t scale = seq->scale_lo + (seq->scale_hi - seq->scale_lo) / 2;
+
+    /* Right after the estimated end of the third step, long before the fourth overwrites the oldest. A read
+     * that finds the third step halves the range of the timing scale from above, one that misses it from below */
+    seq->next_us = seq_time(seq, seq_nominal_end(seq, seq->seq + 2), scale) + BME69X_SEQ_MARGIN_US;
+    if (seq->next_us <= now)
+    {
+        seq->next_us = now + BME69X_SEQ_MARGIN_US;
+    }
+}
+
+/* This internal API is used to calculate the step and cycle durations of an operation mode from the heater
+ * register values */
+static void calc_timing(uint8_t op_mode,
+                        struct bme69x_conf *conf,
+                        const uint8_t *gas_wait,
+                        uint8_t n_steps,
+                        uint8_t shd_heatr_dur,
+                        uint8_t gas_on,
+                        struct bme69x_timing *timing,
+                        struct bme69x_dev *dev)
+{
+    uint32_t tph_dur = bme69x_get_meas_dur(op_mode, conf, dev);
+    uint32_t step_dur;
+    uint8_t i;
+
+    /* A profile length of 0 runs one step */
+    timing->n_steps = ((n_steps == 0) || (n_steps > 10)) ? 1 : n_steps;
+    timing->cycle_us = 0;
+    for (i = 0; i < timing->n_steps; i++)
+    {
+        step_dur = tph_dur;
+        if (gas_on && (op_mode == BME69X_PARALLEL_MODE))
+        {
+            /* The heater holds the step for gas_wait TPHG cycles of shared heater duration each */
+            step_dur += (uint32_t)calc_dur_steps(shd_heatr_dur) * 477;
+            step_dur *= (gas_wait[i] == 0) ? 1 : gas_wait[i];
+        }
+        else if (gas_on)
+        {
+            step_dur += (uint32_t)calc_gas_wait_ms(gas_wait[i]) * 1000;
+        }
+
+        timing->step_us[i] = step_dur;
+        timing->cycle_us += step_dur;
+    }
+
+    /* Only the sequential mode stands by between cycles */
+    timing->standby_us = (op_mode == BME69X_SEQUENTIAL_MODE) ? calc_odr_standby(conf->odr) : 0;
+    timing->cycle_us += timing->standby_us;
+}
+
+/* This internal API is used to calculate the standby time of an ODR setting in microseconds */
+static uint32_t calc_odr_standby(uint8_t odr)
+{
+    /* Standby of BME69X_ODR_0_59_MS to BME69X_ODR_20_MS */
+    static const uint32_t odr_us[8] = { 590, 62500, 125000, 250000, 500000, 1000000, 10000, 20000 };
+
+    return (odr < BME69X_ODR_NONE) ? odr_us[odr] : 0;
+}
+
 /* This internal API is used to calculate the gas wait */
 static uint8_t calc_gas_wait(uint16_t dur)
 {
-    uint8_t factor = 0;
     uint8_t durval;
 
     if (dur >= 0xfc0)
@@ -1105,94 +2613,175 @@ static uint8_t calc_gas_wait(uint16_t dur)
     }
     else
     {
-        while (dur > 0x3F)
+        durval = calc_dur_code(dur);
+    }
+
+    return durval;
+}
+
+/* This internal API is used to calculate the gas wait in milliseconds from its register value */
+static uint16_t calc_gas_wait_ms(uint8_t gas_wait)
+{
+    /* Step size of 1 ms */
+    return calc_dur_steps(gas_wait);
+}
+
+/* This internal API is used to calculate the lowest heater temperature giving a heater resistance code */
+static uint16_t calc_heatr_temp(uint8_t res_heat, const struct bme69x_dev *dev)
+{
+    uint16_t low = 0;
+    uint16_t high = BME69X_HEATR_LUT_MAX_TEMP;
+    uint16_t mid;
+
+    /* The code rises with the temperature, about one step per 4 degC */
+    while (low < high)
+    {
+        mid = (low + high) / 2;
+        if (get_res_heat(mid, dev) < res_heat)
         {
-            dur = dur / 4;
-            factor += 1;
+            low = mid + 1;
         }
+        else
+        {
+            high = mid;
+        }
+    }
+
+    return low;
+}
+
+/* This internal API is used to encode a duration into the 6 bit value and 2 bit multiplication factor of
+ * the heater duration registers */
+static uint8_t calc_dur_code(uint16_t dur)
+{
+    uint8_t factor = 0;
+
+    if (dur > 0x3F)
+    {
+        /* Smallest power of 4 that brings the duration down to 6 bits */
+        factor = (uint8_t)((bit_length(dur) - 5) / 2);
+    }
+
+    return (uint8_t)((dur >> (2 * factor)) + (factor * 64));
+}
+
+/* This internal API is used to decode a heater duration register into the duration in register steps */
+static uint16_t calc_dur_steps(uint8_t dur_code)
+{
+    return (uint16_t)((dur_code & 0x3F) << (2 * (dur_code >> 6)));
+}
+
+/* This internal API is used to get the number of significant bits of a value */
+static uint8_t bit_length(uint16_t value)
+{
+#if defined(__GNUC__)
+    return (value == 0) ? 0 : (uint8_t)(32 - __builtin_clz((uint32_t)value));
+#else
+    uint8_t len = 0;
 
-        durval = (uint8_t)(dur + (factor * 64));
+    while (value)
+    {
+        value >>= 1;
+        len++;
     }
 
-    return durval;
+    return len;
+#endif
 }
 
-/* This internal API is used to read a single data of the sensor */
-static int8_t read_field_data(uint8_t index, struct bme69x_data *data, struct bme69x_dev *dev)
+/* This internal API is used to read and compensate a field once, without waiting for new data */
+static int8_t read_field_data_once(uint8_t index, struct bme69x_data *data, struct bme69x_dev *dev)
 {
-    int8_t rslt = BME69X_OK;
+    int8_t rslt;
     uint8_t buff[BME69X_LEN_FIELD] = { 0 };
-    uint8_t gas_range;
-    uint32_t adc_temp;
-    uint32_t adc_pres;
-    volatile uint16_t adc_hum;
-    uint16_t adc_gas_res;
-    uint8_t tries = 5;
+    uint8_t set_val[BME69X_LEN_HEATR_READBACK] = { 0 }; /* idac, res_heat, gas_wait */
 
-    while ((tries) && (rslt == BME69X_OK))
-    {
-        rslt = bme69x_get_regs(((uint8_t)(BME69X_REG_FIELD0 + (index * BME69X_LEN_FIELD_OFFSET))),
-                               buff,
-                               (uint16_t)BME69X_LEN_FIELD,
-                               dev);
-        if (!data)
-        {
-            rslt = BME69X_E_NULL_PTR;
-            break;
-        }
+    rslt = bme69x_get_regs(((uint8_t)(BME69X_REG_FIELD0 + (index * BME69X_LEN_FIELD_OFFSET))),
+                           buff,
+                           (uint16_t)BME69X_LEN_FIELD,
+                           dev);
 
+    if (rslt == BME69X_OK)
+    {
         data->status = buff[0] & BME69X_NEW_DATA_MSK;
         data->gas_index = buff[0] & BME69X_GAS_INDEX_MSK;
         data->meas_index = buff[1];
-
-        /* read the raw data from the sensor */
-        adc_pres = (uint32_t)(((uint32_t)buff[2] << 16) | ((uint32_t)buff[3] << 8) | ((uint32_t)buff[4]));
-        adc_temp = (uint32_t)(((uint32_t)buff[5] << 16) | ((uint32_t)buff[6] << 8) | ((uint32_t)buff[7]));
-        adc_hum = (uint16_t)(((uint32_t)buff[8] << 8) | (uint32_t)buff[9]);
-        adc_gas_res = ((uint16_t)buff[15] << 2) | ((uint16_t)buff[16] >> 6);
-
-        gas_range = buff[16] & BME69X_GAS_RANGE_MSK;
-
         data->status |= buff[16] & BME69X_GASM_VALID_MSK;
         data->status |= buff[16] & BME69X_HEAT_STAB_MSK;
 
-        if ((data->status & BME69X_NEW_DATA_MSK) && (rslt == BME69X_OK))
+        if (data->status & BME69X_NEW_DATA_MSK)
         {
-            rslt = bme69x_get_regs(BME69X_REG_RES_HEAT0 + data->gas_index, &data->res_heat, 1, dev);
-            if (rslt == BME69X_OK)
+            /* The set-points are echoed from the shadow, they only change through writes of this driver */
+            if (dev->shadow_valid)
             {
-                rslt = bme69x_get_regs(BME69X_REG_IDAC_HEAT0 + data->gas_index, &data->idac, 1, dev);
-            }
+                memcpy(set_val, &dev->shadow[data->gas_index], BME69X_LEN_HEATR_READBACK);
 
-            if (rslt == BME69X_OK)
+                /* A finished forced measurement has put the sensor back to sleep */
+                if (index == 0)
+                {
+                    uint8_t *ctrl_meas = &dev->shadow[BME69X_REG_CTRL_MEAS - BME69X_REG_IDAC_HEAT0];
+                    if ((*ctrl_meas & BME69X_MODE_MSK) == BME69X_FORCED_MODE)
+                    {
+                        *ctrl_meas &= (uint8_t)~BME69X_MODE_MSK;
+                    }
+                }
+            }
+            else
             {
-                rslt = bme69x_get_regs(BME69X_REG_GAS_WAIT0 + data->gas_index, &data->gas_wait, 1, dev);
+                /* idac, res_heat and gas_wait of the step are 10 registers apart, fetch them in one burst */
+                rslt = bme69x_get_regs(BME69X_REG_IDAC_HEAT0 + data->gas_index,
+                                       set_val,
+                                       BME69X_LEN_HEATR_READBACK,
+                                       dev);
             }
 
             if (rslt == BME69X_OK)
             {
-#ifndef BME69X_USE_FPU
-                data->temperature = calc_temperature(adc_temp, dev, &data->t_lin);
-                data->pressure = calc_pressure(adc_pres, data->t_lin, dev);
-#else
-                data->temperature = calc_temperature(adc_temp, dev);
-                data->pressure = calc_pressure(adc_pres, data->temperature, dev);
-#endif
-                data->humidity = calc_humidity(adc_hum, data->temperature, dev);
-                data->gas_resistance = calc_gas_resistance(adc_gas_res, gas_range);
-
-                break;
+                compensate_fields(buff, 1, &data, &dev->calib);
+                data->idac = set_val[0];
+                data->res_heat = set_val[BME69X_REG_RES_HEAT0 - BME69X_REG_IDAC_HEAT0];
+                data->gas_wait = set_val[BME69X_REG_GAS_WAIT0 - BME69X_REG_IDAC_HEAT0];
             }
         }
+        else
+        {
+            rslt = BME69X_W_NO_NEW_DATA;
+        }
+    }
 
-        if (rslt == BME69X_OK)
+    return rslt;
+}
+
+/* This internal API is used to read a single data of the sensor */
+static int8_t read_field_data(uint8_t index, struct bme69x_data *data, struct bme69x_dev *dev)
+{
+    int8_t rslt = BME69X_W_NO_NEW_DATA;
+    uint8_t tries = 5;
+
+    if (!data)
+    {
+        return BME69X_E_NULL_PTR;
+    }
+
+    while (tries)
+    {
+        rslt = read_field_data_once(index, data, dev);
+        if (rslt != BME69X_W_NO_NEW_DATA)
         {
-            dev->delay_us(BME69X_PERIOD_POLL, dev->intf_ptr);
+            break;
         }
 
+        dev_delay_us(BME69X_PERIOD_POLL, dev);
+
         tries--;
     }
 
+    /* Running out of tries is reported through the new data bit of the status */
+    if (rslt == BME69X_W_NO_NEW_DATA)
+    {
+        rslt = BME69X_OK;
+    }
+
     return rslt;
 }
 
@@ -1200,13 +2789,7 @@ static int8_t read_field_data(uint8_t index, struct bme69x_data *data, struct bm
 static int8_t read_all_field_data(struct bme69x_data * const data[], struct bme69x_dev *dev)
 {
     int8_t rslt = BME69X_OK;
-    uint8_t buff[BME69X_LEN_FIELD * 3] = { 0 };
-    uint8_t gas_range;
-    uint32_t adc_temp;
-    uint32_t adc_pres;
-    uint16_t adc_hum;
-    uint16_t adc_gas_res;
-    uint8_t off;
+    uint8_t buff[BME69X_LEN_FIELD * BME69X_N_FIELDS] = { 0 };
     uint8_t set_val[30] = { 0 }; /* idac, res_heat, gas_wait */
     uint8_t i;
 
@@ -1217,54 +2800,136 @@ static int8_t read_all_field_data(struct bme69x_data * const data[], struct bme6
 
     if (rslt == BME69X_OK)
     {
-        rslt = bme69x_get_regs(BME69X_REG_FIELD0, buff, (uint32_t) BME69X_LEN_FIELD * 3, dev);
+        rslt = bme69x_get_regs(BME69X_REG_FIELD0, buff, (uint32_t) BME69X_LEN_FIELD * BME69X_N_FIELDS, dev);
     }
 
     if (rslt == BME69X_OK)
     {
-        rslt = bme69x_get_regs(BME69X_REG_IDAC_HEAT0, set_val, 30, dev);
+        /* Set-points of all steps, echoed from the shadow as in read_field_data_once */
+        if (dev->shadow_valid)
+        {
+            memcpy(set_val, dev->shadow, 30);
+        }
+        else
+        {
+            rslt = bme69x_get_regs(BME69X_REG_IDAC_HEAT0, set_val, 30, dev);
+        }
     }
 
-    for (i = 0; ((i < 3) && (rslt == BME69X_OK)); i++)
+    if (rslt == BME69X_OK)
     {
-        off = (uint8_t)(i * BME69X_LEN_FIELD);
-        data[i]->status = buff[off] & BME69X_NEW_DATA_MSK;
-        data[i]->gas_index = buff[off] & BME69X_GAS_INDEX_MSK;
-        data[i]->meas_index = buff[off + 1];
+        compensate_fields(buff, BME69X_N_FIELDS, data, &dev->calib);
+        for (i = 0; i < BME69X_N_FIELDS; i++)
+        {
+            data[i]->idac = set_val[data[i]->gas_index];
+            data[i]->res_heat = set_val[10 + data[i]->gas_index];
+            data[i]->gas_wait = set_val[20 + data[i]->gas_index];
+        }
+    }
 
-        /* read the raw data from the sensor */
-        adc_pres =
-            (uint32_t)(((uint32_t) buff[off + 2] << 16) | ((uint32_t) buff[off + 3] << 8) | ((uint32_t) buff[off + 4]));
-        adc_temp =
-            (uint32_t)(((uint32_t) buff[off + 5] << 16) | ((uint32_t) buff[off + 6] << 8) | ((uint32_t) buff[off + 7]));
-        adc_hum = (uint16_t) (((uint32_t) buff[off + 8] * 256) | (uint32_t) buff[off + 9]);
-        adc_gas_res = ((uint16_t)buff[off + 15] << 2) | ((uint16_t)buff[off + 16] >> 6);
-        gas_range = buff[off + 16] & BME69X_GAS_RANGE_MSK;
+    return rslt;
+}
 
-        data[i]->status |= buff[off + 16] & BME69X_GASM_VALID_MSK;
-        data[i]->status |= buff[off + 16] & BME69X_HEAT_STAB_MSK;
+/*
+ * This internal API is used to decode and compensate data fields in one pass.
+ *
+ * The ADC values of the fields are unpacked into one array per quantity and every formula then
+ * runs over all fields back to back. Results are kept in local arrays and only stored into data
+ * at the end: the outputs share their types with the calibration coefficients, so earlier stores
+ * through data would force the compiler to reload the coefficients after each of them. Both read
+ * paths come through here, so every calc_* function has a single caller and is inlined.
+ */
+static void compensate_fields(const uint8_t *buff,
+                              uint8_t n_fields,
+                              struct bme69x_data * const data[],
+                              const struct bme69x_calib_data *calib)
+{
+    uint32_t adc_temp[BME69X_COMP_BLOCK];
+    uint32_t adc_pres[BME69X_COMP_BLOCK];
+    uint16_t adc_hum[BME69X_COMP_BLOCK];
+    uint16_t adc_gas_res[BME69X_COMP_BLOCK];
+    uint8_t gas_range[BME69X_COMP_BLOCK];
+#ifndef BME69X_USE_FPU
+    int32_t t_lin[BME69X_COMP_BLOCK];
+    int16_t temperature[BME69X_COMP_BLOCK];
+    uint32_t pressure[BME69X_COMP_BLOCK];
+    uint32_t humidity[BME69X_COMP_BLOCK];
+    uint32_t gas_resistance[BME69X_COMP_BLOCK];
+#else
+    float temperature[BME69X_COMP_BLOCK];
+    float pressure[BME69X_COMP_BLOCK];
+    float humidity[BME69X_COMP_BLOCK];
+    float gas_resistance[BME69X_COMP_BLOCK];
+#endif
+    const uint8_t *field;
+    uint8_t i;
 
-        data[i]->idac = set_val[data[i]->gas_index];
-        data[i]->res_heat = set_val[10 + data[i]->gas_index];
-        data[i]->gas_wait = set_val[20 + data[i]->gas_index];
+    for (i = 0; i < n_fields; i++)
+    {
+        field = &buff[i * BME69X_LEN_FIELD_OFFSET];
+        adc_pres[i] = ((uint32_t)field[2] << 16) | ((uint32_t)field[3] << 8) | (uint32_t)field[4];
+        adc_temp[i] = ((uint32_t)field[5] << 16) | ((uint32_t)field[6] << 8) | (uint32_t)field[7];
+        adc_hum[i] = (uint16_t)(((uint16_t)field[8] << 8) | (uint16_t)field[9]);
+        adc_gas_res[i] = (uint16_t)(((uint16_t)field[15] << 2) | ((uint16_t)field[16] >> 6));
+        gas_range[i] = field[16] & BME69X_GAS_RANGE_MSK;
+    }
 
 #ifndef BME69X_USE_FPU
 
-        /*
-         * Fixed point calculation needs t_lin for pressure calculation
-         * t_lin is calculated during temperature calculation
-         */
-        data[i]->temperature = calc_temperature(adc_temp, dev, &data[i]->t_lin);
-        data[i]->pressure = calc_pressure(adc_pres, data[i]->t_lin, dev);
+    /* Pressure and humidity need t_lin, the fine temperature computed with the temperature */
+    for (i = 0; i < n_fields; i++)
+    {
+        temperature[i] = calc_temperature(adc_temp[i], calib, &t_lin[i]);
+    }
+
+    for (i = 0; i < n_fields; i++)
+    {
+        pressure[i] = calc_pressure(adc_pres[i], t_lin[i], calib);
+    }
+
+    for (i = 0; i < n_fields; i++)
+    {
+        humidity[i] = calc_humidity(adc_hum[i], t_lin[i], calib);
+    }
+
 #else
-        data[i]->temperature = calc_temperature(adc_temp, dev);
-        data[i]->pressure = calc_pressure(adc_pres, data[i]->temperature, dev);
+    for (i = 0; i < n_fields; i++)
+    {
+        temperature[i] = calc_temperature(adc_temp[i], calib);
+    }
+
+    for (i = 0; i < n_fields; i++)
+    {
+        pressure[i] = calc_pressure(adc_pres[i], temperature[i], calib);
+    }
+
+    for (i = 0; i < n_fields; i++)
+    {
+        humidity[i] = calc_humidity(adc_hum[i], temperature[i], calib);
+    }
+
 #endif
-        data[i]->humidity = calc_humidity(adc_hum, data[i]->temperature, dev);
-        data[i]->gas_resistance = calc_gas_resistance(adc_gas_res, gas_range);
+
+    for (i = 0; i < n_fields; i++)
+    {
+        gas_resistance[i] = calc_gas_resistance(adc_gas_res[i], gas_range[i]);
     }
 
-    return rslt;
+    for (i = 0; i < n_fields; i++)
+    {
+        field = &buff[i * BME69X_LEN_FIELD_OFFSET];
+        data[i]->status = (field[0] & BME69X_NEW_DATA_MSK) |
+                          (field[16] & (BME69X_GASM_VALID_MSK | BME69X_HEAT_STAB_MSK));
+        data[i]->gas_index = field[0] & BME69X_GAS_INDEX_MSK;
+        data[i]->meas_index = field[1];
+        data[i]->temperature = temperature[i];
+        data[i]->pressure = pressure[i];
+        data[i]->humidity = humidity[i];
+        data[i]->gas_resistance = gas_resistance[i];
+#ifndef BME69X_USE_FPU
+        data[i]->t_lin = t_lin[i];
+#endif
+    }
 }
 
 /* This internal API is used to switch between SPI memory pages */
@@ -1273,6 +2938,7 @@ static int8_t set_mem_page(uint8_t reg_addr, struct bme69x_dev *dev)
     int8_t rslt;
     uint8_t reg;
     uint8_t mem_page;
+    uint64_t start_us;
 
     /* Check for null pointers in the device structure*/
     rslt = null_ptr_check(dev);
@@ -1289,22 +2955,20 @@ static int8_t set_mem_page(uint8_t reg_addr, struct bme69x_dev *dev)
 
         if (mem_page != dev->mem_page)
         {
-            dev->mem_page = mem_page;
-            dev->intf_rslt = dev->read(BME69X_REG_MEM_PAGE | BME69X_SPI_RD_MSK, &reg, 1, dev->intf_ptr);
+            /* The other bits of the register are kept from its last read or write, no read-back */
+            reg = dev->mem_page_reg & (~BME69X_MEM_PAGE_MSK);
+            reg = reg | (mem_page & BME69X_MEM_PAGE_MSK);
+            start_us = stats_time_us(dev);
+            dev->intf_rslt = dev->write(BME69X_REG_MEM_PAGE & BME69X_SPI_WR_MSK, &reg, 1, dev->intf_ptr);
+            stats_bus(1, 2, start_us, dev);
             if (dev->intf_rslt != 0)
             {
                 rslt = BME69X_E_COM_FAIL;
             }
-
-            if (rslt == BME69X_OK)
+            else
             {
-                reg = reg & (~BME69X_MEM_PAGE_MSK);
-                reg = reg | (dev->mem_page & BME69X_MEM_PAGE_MSK);
-                dev->intf_rslt = dev->write(BME69X_REG_MEM_PAGE & BME69X_SPI_WR_MSK, &reg, 1, dev->intf_ptr);
-                if (dev->intf_rslt != 0)
-                {
-                    rslt = BME69X_E_COM_FAIL;
-                }
+                dev->mem_page = mem_page;
+                dev->mem_page_reg = reg;
             }
         }
     }
@@ -1317,12 +2981,15 @@ static int8_t get_mem_page(struct bme69x_dev *dev)
 {
     int8_t rslt;
     uint8_t reg;
+    uint64_t start_us;
 
     /* Check for null pointer in the device structure*/
     rslt = null_ptr_check(dev);
     if (rslt == BME69X_OK)
     {
+        start_us = stats_time_us(dev);
         dev->intf_rslt = dev->read(BME69X_REG_MEM_PAGE | BME69X_SPI_RD_MSK, &reg, 1, dev->intf_ptr);
+        stats_bus(0, 1, start_us, dev);
         if (dev->intf_rslt != 0)
         {
             rslt = BME69X_E_COM_FAIL;
@@ -1330,6 +2997,7 @@ static int8_t get_mem_page(struct bme69x_dev *dev)
         else
         {
             dev->mem_page = reg & BME69X_MEM_PAGE_MSK;
+            dev->mem_page_reg = reg;
         }
     }
 
@@ -1374,28 +3042,220 @@ static int8_t null_ptr_check(const struct bme69x_dev *dev)
     return rslt;
 }
 
-/* This internal API is used to set heater configurations */
-static int8_t set_conf(const struct bme69x_heatr_conf *conf, uint8_t op_mode, uint8_t *nb_conv, struct bme69x_dev *dev)
+/* This internal API is used to copy a register access into the shadow registers */
+static void shadow_update(uint8_t reg_addr, const uint8_t *reg_data, uint32_t len, struct bme69x_dev *dev)
+{
+    uint32_t addr = reg_addr;
+    uint32_t i;
+
+    for (i = 0; i < len; i++, addr++)
+    {
+        if ((addr >= BME69X_REG_IDAC_HEAT0) && (addr < (uint32_t)(BME69X_REG_IDAC_HEAT0 + BME69X_LEN_SHADOW)))
+        {
+            dev->shadow[addr - BME69X_REG_IDAC_HEAT0] = reg_data[i];
+        }
+    }
+}
+
+/* This internal API is used to write only the registers whose shadow differs */
+static int8_t set_regs_changed(const uint8_t *reg_addr, const uint8_t *reg_data, uint32_t len, struct bme69x_dev *dev)
+{
+    int8_t rslt = BME69X_OK;
+    uint8_t chg_addr[BME69X_LEN_SHADOW];
+    uint8_t chg_data[BME69X_LEN_SHADOW];
+    uint32_t n_chg = 0;
+    uint32_t i;
+
+    for (i = 0; i < len; i++)
+    {
+        if (dev->shadow_valid && (reg_addr[i] >= BME69X_REG_IDAC_HEAT0) &&
+            (reg_addr[i] < (BME69X_REG_IDAC_HEAT0 + BME69X_LEN_SHADOW)) &&
+            (dev->shadow[reg_addr[i] - BME69X_REG_IDAC_HEAT0] == reg_data[i]))
+        {
+            continue;
+        }
+
+        chg_addr[n_chg] = reg_addr[i];
+        chg_data[n_chg++] = reg_data[i];
+    }
+
+    if (n_chg > 0)
+    {
+        rslt = bme69x_set_regs(chg_addr, chg_data, n_chg, dev);
+    }
+
+    return rslt;
+}
+
+/* This internal API is used to get the operation mode, from the shadow registers when they are conclusive */
+static int8_t get_cur_op_mode(uint8_t *op_mode, struct bme69x_dev *dev)
+{
+    int8_t rslt;
+
+    rslt = null_ptr_check(dev);
+    if ((rslt == BME69X_OK) && dev->shadow_valid &&
+        ((dev->shadow[BME69X_REG_CTRL_MEAS - BME69X_REG_IDAC_HEAT0] & BME69X_MODE_MSK) == BME69X_SLEEP_MODE))
+    {
+        *op_mode = BME69X_SLEEP_MODE;
+    }
+    else
+    {
+        /* The sensor leaves forced mode by itself, only the register tells */
+        rslt = bme69x_get_op_mode(op_mode, dev);
+    }
+
+    return rslt;
+}
+
+/* This internal API is used to account a public API call in the bus statistics */
+static uint8_t stats_enter(uint8_t api, struct bme69x_dev *dev)
+{
+    uint8_t prev_api = BME69X_STATS_API_NONE;
+
+    if (dev != NULL)
+    {
+        dev_lock(dev);
+        prev_api = dev->stats_api;
+
+        /* Public APIs called by other public APIs are accounted to the outermost one */
+        if (prev_api == BME69X_STATS_API_NONE)
+        {
+            dev->stats_api = api;
+            if (dev->stats != NULL)
+            {
+                dev->stats->api[api].calls++;
+            }
+        }
+    }
+
+    return prev_api;
+}
+
+/* This internal API is used to end the accounting of a public API call */
+static void stats_exit(uint8_t prev_api, struct bme69x_dev *dev)
+{
+    if (dev != NULL)
+    {
+        dev->stats_api = prev_api;
+        dev_unlock(dev);
+    }
+}
+
+/* This internal API is used to take the lock of the device */
+static void dev_lock(const struct bme69x_dev *dev)
+{
+    if (dev->lock != NULL)
+    {
+        dev->lock(dev->intf_ptr);
+    }
+}
+
+/* This internal API is used to give the lock of the device */
+static void dev_unlock(const struct bme69x_dev *dev)
+{
+    if (dev->unlock != NULL)
+    {
+        dev->unlock(dev->intf_ptr);
+    }
+}
+
+/* This internal API is used to publish the newest sample of the device */
+static void publish_latest(const struct bme69x_data *data, struct bme69x_dev *dev)
+{
+    struct bme69x_latest *latest = dev->latest;
+    uint32_t n = latest->count;
+    uint8_t idx = (uint8_t)(n % 2);
+
+    /* Readers copy data[(n - 1) % 2] until the count moves on */
+    latest->data[idx] = *data;
+    latest->time_us[idx] = (dev->get_time_us != NULL) ? dev->get_time_us(dev->intf_ptr) : 0;
+    BME69X_MEMORY_BARRIER();
+    latest->count = n + 1;
+}
+
+/* This internal API is used to read the time source when the bus statistics are enabled */
+static uint64_t stats_time_us(const struct bme69x_dev *dev)
+{
+    uint64_t now_us = 0;
+
+    if ((dev->stats != NULL) && (dev->get_time_us != NULL))
+    {
+        now_us = dev->get_time_us(dev->intf_ptr);
+    }
+
+    return now_us;
+}
+
+/* This internal API is used to account a bus transaction in the bus statistics */
+static void stats_bus(uint8_t is_write, uint32_t len, uint64_t start_us, struct bme69x_dev *dev)
+{
+    struct bme69x_stats_entry *entry;
+
+    if (dev->stats != NULL)
+    {
+        entry = &dev->stats->api[dev->stats_api];
+        if (is_write)
+        {
+            entry->writes++;
+            entry->bytes_written += len;
+        }
+        else
+        {
+            entry->reads++;
+            entry->bytes_read += len;
+        }
+
+        if (dev->intf_rslt != 0)
+        {
+            entry->errors++;
+        }
+
+        entry->bus_time_us += stats_time_us(dev) - start_us;
+    }
+}
+
+/* This internal API is used to call the delay callback and account the time slept */
+static void dev_delay_us(uint32_t period, struct bme69x_dev *dev)
+{
+    uint64_t start_us = stats_time_us(dev);
+
+    dev->delay_us(period, dev->intf_ptr);
+
+    if (dev->stats != NULL)
+    {
+        if (dev->get_time_us != NULL)
+        {
+            dev->stats->api[dev->stats_api].sleep_time_us += stats_time_us(dev) - start_us;
+        }
+        else
+        {
+            dev->stats->api[dev->stats_api].sleep_time_us += period;
+        }
+    }
+}
+
+/* This internal API is used to build the heater register writes of a configuration */
+static int8_t set_conf(const struct bme69x_heatr_conf *conf,
+                       uint8_t op_mode,
+                       uint8_t *nb_conv,
+                       uint8_t *reg_addr,
+                       uint8_t *reg_data,
+                       uint8_t *len,
+                       struct bme69x_dev *dev)
 {
     int8_t rslt = BME69X_OK;
     uint8_t i;
-    uint8_t shared_dur;
     uint8_t write_len = 0;
-    uint8_t heater_dur_shared_addr = BME69X_REG_SHD_HEATR_DUR;
-    uint8_t rh_reg_addr[10] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
-    uint8_t rh_reg_data[10] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
-    uint8_t gw_reg_addr[10] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
-    uint8_t gw_reg_data[10] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
 
     switch (op_mode)
     {
         case BME69X_FORCED_MODE:
-            rh_reg_addr[0] = BME69X_REG_RES_HEAT0;
-            rh_reg_data[0] = calc_res_heat(conf->heatr_temp, dev);
-            gw_reg_addr[0] = BME69X_REG_GAS_WAIT0;
-            gw_reg_data[0] = calc_gas_wait(conf->heatr_dur);
+            reg_addr[0] = BME69X_REG_RES_HEAT0;
+            reg_data[0] = get_res_heat(conf->heatr_temp, dev);
+            reg_addr[1] = BME69X_REG_GAS_WAIT0;
+            reg_data[1] = calc_gas_wait(conf->heatr_dur);
             (*nb_conv) = 0;
-            write_len = 1;
+            write_len = 2;
             break;
         case BME69X_SEQUENTIAL_MODE:
             if ((!conf->heatr_dur_prof) || (!conf->heatr_temp_prof))
@@ -1404,16 +3264,21 @@ static int8_t set_conf(const struct bme69x_heatr_conf *conf, uint8_t op_mode, ui
                 break;
             }
 
+            if (conf->profile_len > 10)
+            {
+                rslt = BME69X_E_INVALID_LENGTH;
+                break;
+            }
+
             for (i = 0; i < conf->profile_len; i++)
             {
-                rh_reg_addr[i] = BME69X_REG_RES_HEAT0 + i;
-                rh_reg_data[i] = calc_res_heat(conf->heatr_temp_prof[i], dev);
-                gw_reg_addr[i] = BME69X_REG_GAS_WAIT0 + i;
-                gw_reg_data[i] = calc_gas_wait(conf->heatr_dur_prof[i]);
+                reg_addr[write_len] = BME69X_REG_RES_HEAT0 + i;
+                reg_data[write_len++] = get_res_heat(conf->heatr_temp_prof[i], dev);
+                reg_addr[write_len] = BME69X_REG_GAS_WAIT0 + i;
+                reg_data[write_len++] = calc_gas_wait(conf->heatr_dur_prof[i]);
             }
 
             (*nb_conv) = conf->profile_len;
-            write_len = conf->profile_len;
             break;
         case BME69X_PARALLEL_MODE:
             if ((!conf->heatr_dur_prof) || (!conf->heatr_temp_prof))
@@ -1422,6 +3287,12 @@ static int8_t set_conf(const struct bme69x_heatr_conf *conf, uint8_t op_mode, ui
                 break;
             }
 
+            if (conf->profile_len > 10)
+            {
+                rslt = BME69X_E_INVALID_LENGTH;
+                break;
+            }
+
             if (conf->shared_heatr_dur == 0)
             {
                 rslt = BME69X_W_DEFINE_SHD_HEATR_DUR;
@@ -1429,34 +3300,21 @@ static int8_t set_conf(const struct bme69x_heatr_conf *conf, uint8_t op_mode, ui
 
             for (i = 0; i < conf->profile_len; i++)
             {
-                rh_reg_addr[i] = BME69X_REG_RES_HEAT0 + i;
-                rh_reg_data[i] = calc_res_heat(conf->heatr_temp_prof[i], dev);
-                gw_reg_addr[i] = BME69X_REG_GAS_WAIT0 + i;
-                gw_reg_data[i] = (uint8_t) conf->heatr_dur_prof[i];
+                reg_addr[write_len] = BME69X_REG_RES_HEAT0 + i;
+                reg_data[write_len++] = get_res_heat(conf->heatr_temp_prof[i], dev);
+                reg_addr[write_len] = BME69X_REG_GAS_WAIT0 + i;
+                reg_data[write_len++] = (uint8_t) conf->heatr_dur_prof[i];
             }
 
             (*nb_conv) = conf->profile_len;
-            write_len = conf->profile_len;
-            shared_dur = calc_heatr_dur_shared(conf->shared_heatr_dur);
-            if (rslt == BME69X_OK)
-            {
-                rslt = bme69x_set_regs(&heater_dur_shared_addr, &shared_dur, 1, dev);
-            }
-
+            reg_addr[write_len] = BME69X_REG_SHD_HEATR_DUR;
+            reg_data[write_len++] = calc_heatr_dur_shared(conf->shared_heatr_dur);
             break;
         default:
             rslt = BME69X_W_DEFINE_OP_MODE;
     }
 
-    if (rslt == BME69X_OK)
-    {
-        rslt = bme69x_set_regs(rh_reg_addr, rh_reg_data, write_len, dev);
-    }
-
-    if (rslt == BME69X_OK)
-    {
-        rslt = bme69x_set_regs(gw_reg_addr, gw_reg_data, write_len, dev);
-    }
+    *len = write_len;
 
     return rslt;
 }
@@ -1465,7 +3323,6 @@ static int8_t set_conf(const struct bme69x_heatr_conf *conf, uint8_t op_mode, ui
  * shared heater duration */
 static uint8_t calc_heatr_dur_shared(uint16_t dur)
 {
-    uint8_t factor = 0;
     uint8_t heatdurval;
 
     if (dur >= 0x783)
@@ -1475,19 +3332,19 @@ static uint8_t calc_heatr_dur_shared(uint16_t dur)
     else
     {
         /* Step size of 0.477ms */
-        dur = (uint16_t)(((uint32_t)dur * 1000) / 477);
-        while (dur > 0x3F)
-        {
-            dur = dur >> 2;
-            factor += 1;
-        }
-
-        heatdurval = (uint8_t)(dur + (factor * 64));
+        heatdurval = calc_dur_code((uint16_t)(((uint32_t)dur * 1000) / 477));
     }
 
     return heatdurval;
 }
 
+/* This internal API is used to calculate the shared heater duration in milliseconds from its register value */
+static uint16_t calc_heatr_dur_shared_ms(uint8_t heatdurval)
+{
+    /* Step size of 0.477ms, rounded up to the shortest duration giving the register value */
+    return (uint16_t)(((uint32_t)calc_dur_steps(heatdurval) * 477 + 999) / 1000);
+}
+
 /* This internal API is used sort the sensor data */
 static void sort_sensor_data(uint8_t low_index, uint8_t high_index, struct bme69x_data *field[])
 {
@@ -1738,11 +3595,133 @@ static int8_t get_calib_data(struct bme69x_dev *dev)
         dev->calib.res_heat_range = ((coeff_array[BME69X_IDX_RES_HEAT_RANGE] & BME69X_RHRANGE_MSK) >> 4);
         dev->calib.res_heat_val = (int8_t)coeff_array[BME69X_IDX_RES_HEAT_VAL];
         dev->calib.range_sw_err = ((int8_t)(coeff_array[BME69X_IDX_RANGE_SW_ERR] & BME69X_RSERROR_MSK)) / 16;
+
+#ifdef BME69X_USE_FPU
+        calc_calib_fpu(&dev->calib);
+#endif
     }
 
     return rslt;
 }
 
+/* This internal API is used to serialise the calibration coefficients of a calibration snapshot */
+static void pack_calib(const struct bme69x_calib_data *calib, uint8_t *buff)
+{
+    uint8_t i = 0;
+
+    /* Multi-byte coefficients are stored MSB first */
+    buff[i++] = (uint8_t)((uint16_t)calib->par_t1 >> 8);
+    buff[i++] = (uint8_t)calib->par_t1;
+    buff[i++] = (uint8_t)((uint16_t)calib->par_t2 >> 8);
+    buff[i++] = (uint8_t)calib->par_t2;
+    buff[i++] = (uint8_t)calib->par_t3;
+
+    buff[i++] = (uint8_t)((uint16_t)calib->par_p1 >> 8);
+    buff[i++] = (uint8_t)calib->par_p1;
+    buff[i++] = (uint8_t)((uint16_t)calib->par_p2 >> 8);
+    buff[i++] = (uint8_t)calib->par_p2;
+    buff[i++] = (uint8_t)calib->par_p3;
+    buff[i++] = (uint8_t)calib->par_p4;
+    buff[i++] = (uint8_t)((uint16_t)calib->par_p5 >> 8);
+    buff[i++] = (uint8_t)calib->par_p5;
+    buff[i++] = (uint8_t)((uint16_t)calib->par_p6 >> 8);
+    buff[i++] = (uint8_t)calib->par_p6;
+    buff[i++] = (uint8_t)calib->par_p7;
+    buff[i++] = (uint8_t)calib->par_p8;
+    buff[i++] = (uint8_t)((uint16_t)calib->par_p9 >> 8);
+    buff[i++] = (uint8_t)calib->par_p9;
+    buff[i++] = (uint8_t)calib->par_p10;
+    buff[i++] = (uint8_t)calib->par_p11;
+
+    buff[i++] = (uint8_t)((uint16_t)calib->par_h1 >> 8);
+    buff[i++] = (uint8_t)calib->par_h1;
+    buff[i++] = (uint8_t)calib->par_h2;
+    buff[i++] = calib->par_h3;
+    buff[i++] = (uint8_t)calib->par_h4;
+    buff[i++] = (uint8_t)((uint16_t)calib->par_h5 >> 8);
+    buff[i++] = (uint8_t)calib->par_h5;
+    buff[i++] = calib->par_h6;
+
+    buff[i++] = (uint8_t)calib->par_g1;
+    buff[i++] = (uint8_t)((uint16_t)calib->par_g2 >> 8);
+    buff[i++] = (uint8_t)calib->par_g2;
+    buff[i++] = (uint8_t)calib->par_g3;
+
+    buff[i++] = calib->res_heat_range;
+    buff[i++] = (uint8_t)calib->res_heat_val;
+    buff[i] = (uint8_t)calib->range_sw_err;
+}
+
+/* This internal API is used to restore the calibration coefficients of a calibration snapshot */
+static void unpack_calib(const uint8_t *buff, struct bme69x_calib_data *calib)
+{
+    uint8_t i = 0;
+
+    calib->par_t1 = (uint16_t)BME69X_CONCAT_BYTES(buff[i], buff[i + 1]);
+    i += 2;
+    calib->par_t2 = (uint16_t)BME69X_CONCAT_BYTES(buff[i], buff[i + 1]);
+    i += 2;
+    calib->par_t3 = (int8_t)buff[i++];
+
+    calib->par_p1 = (uint16_t)BME69X_CONCAT_BYTES(buff[i], buff[i + 1]);
+    i += 2;
+    calib->par_p2 = (uint16_t)BME69X_CONCAT_BYTES(buff[i], buff[i + 1]);
+    i += 2;
+    calib->par_p3 = (int8_t)buff[i++];
+    calib->par_p4 = (int8_t)buff[i++];
+    calib->par_p5 = (int16_t)BME69X_CONCAT_BYTES(buff[i], buff[i + 1]);
+    i += 2;
+    calib->par_p6 = (int16_t)BME69X_CONCAT_BYTES(buff[i], buff[i + 1]);
+    i += 2;
+    calib->par_p7 = (int8_t)buff[i++];
+    calib->par_p8 = (int8_t)buff[i++];
+    calib->par_p9 = (int16_t)BME69X_CONCAT_BYTES(buff[i], buff[i + 1]);
+    i += 2;
+    calib->par_p10 = (int8_t)buff[i++];
+    calib->par_p11 = (int8_t)buff[i++];
+
+    calib->par_h1 = (int16_t)BME69X_CONCAT_BYTES(buff[i], buff[i + 1]);
+    i += 2;
+    calib->par_h2 = (int8_t)buff[i++];
+    calib->par_h3 = buff[i++];
+    calib->par_h4 = (int8_t)buff[i++];
+    calib->par_h5 = (int16_t)BME69X_CONCAT_BYTES(buff[i], buff[i + 1]);
+    i += 2;
+    calib->par_h6 = buff[i++];
+
+    calib->par_g1 = (int8_t)buff[i++];
+    calib->par_g2 = (int16_t)BME69X_CONCAT_BYTES(buff[i], buff[i + 1]);
+    i += 2;
+    calib->par_g3 = (int8_t)buff[i++];
+
+    calib->res_heat_range = buff[i++];
+    calib->res_heat_val = (int8_t)buff[i++];
+    calib->range_sw_err = (int8_t)buff[i];
+
+#ifdef BME69X_USE_FPU
+    calc_calib_fpu(calib);
+#endif
+}
+
+/* This internal API is used to calculate the CRC-16/CCITT of a calibration snapshot */
+static uint16_t calc_crc16(const uint8_t *data, uint8_t len)
+{
+    uint16_t crc = 0xffff;
+    uint8_t i;
+    uint8_t bit;
+
+    for (i = 0; i < len; i++)
+    {
+        crc ^= (uint16_t)((uint16_t)data[i] << 8);
+        for (bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+
+    return crc;
+}
+
 /* This internal API is used to read variant ID information from the register */
 static int8_t read_variant_id(struct bme69x_dev *dev)
 {
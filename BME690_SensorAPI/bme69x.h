@@ -83,6 +83,9 @@ int8_t bme69x_init(struct bme69x_dev *dev);
  * int8_t bme69x_set_regs(const uint8_t reg_addr, const uint8_t *reg_data, uint32_t len, struct bme69x_dev *dev)
  * \endcode
  * @details This API writes the given data to the register address of the sensor
+ * The sensor takes register address and data pairs, any set of registers up to
+ * BME69X_LEN_INTERLEAVE_BUFF / 2 is written in one transaction and longer writes
+ * are split.
  *
  * @param[in] reg_addr : Register addresses to where the data is to be written
  * @param[in] reg_data : Pointer to data buffer which is to be written
@@ -183,6 +186,8 @@ int8_t bme69x_get_op_mode(uint8_t *op_mode, struct bme69x_dev *dev);
  * uint32_t bme69x_get_meas_dur(const uint8_t op_mode, struct bme69x_conf *conf, struct bme69x_dev *dev);
  * \endcode
  * @details This API is used to get the remaining duration that can be used for heating.
+ * It covers the wake-up and the TPH measurement only, bme69x_get_timing adds the
+ * heating and the standby.
  *
  * @param[in] op_mode : Desired operation mode.
  * @param[in] conf    : Desired sensor configuration.
@@ -192,6 +197,42 @@ int8_t bme69x_get_op_mode(uint8_t *op_mode, struct bme69x_dev *dev);
  */
 uint32_t bme69x_get_meas_dur(const uint8_t op_mode, struct bme69x_conf *conf, struct bme69x_dev *dev);
 
+/*!
+ * \ingroup bme69xApiConfig
+ * \page bme69x_api_bme69x_get_timing bme69x_get_timing
+ * \code
+ * int8_t bme69x_get_timing(uint8_t op_mode, struct bme69x_conf *conf, const struct bme69x_heatr_conf *heatr_conf,
+ *                          struct bme69x_timing *timing, struct bme69x_dev *dev);
+ * \endcode
+ * @details This API calculates how long each step of an operation mode takes,
+ * and a whole cycle of them, for a configuration and a heater configuration.
+ * The heater durations are taken as bme69x_set_heatr_conf encodes them into
+ * the registers, so the result is the time the sensor runs rather than the
+ * time asked for:
+ * - forced mode: one step of wake-up, TPH measurement and heatr_dur.
+ * - sequential mode: profile_len steps of wake-up, TPH measurement and
+ *   heatr_dur_prof, then the standby of the ODR setting.
+ * - parallel mode: profile_len steps of heatr_dur_prof TPHG cycles, each the
+ *   TPH measurement and shared_heatr_dur.
+ * Without the heater a step is the TPH measurement only. The IIR filter does
+ * not change the durations.
+ *
+ * @param[in] op_mode    : BME69X_FORCED_MODE, BME69X_SEQUENTIAL_MODE or BME69X_PARALLEL_MODE
+ * @param[in] conf       : Sensor configuration
+ * @param[in] heatr_conf : Heater configuration of the operation mode
+ * @param[out] timing    : Step and cycle durations
+ * @param[in] dev        : Structure instance of bme69x_dev
+ *
+ * @return Result of API execution status
+ * @retval 0 -> Success
+ * @retval < 0 -> Fail
+ */
+int8_t bme69x_get_timing(uint8_t op_mode,
+                         struct bme69x_conf *conf,
+                         const struct bme69x_heatr_conf *heatr_conf,
+                         struct bme69x_timing *timing,
+                         struct bme69x_dev *dev);
+
 /**
  * \ingroup bme69x
  * \defgroup bme69xApiData Data Read out
@@ -208,6 +249,11 @@ uint32_t bme69x_get_meas_dur(const uint8_t op_mode, struct bme69x_conf *conf, st
  * from the sensor, compensates the data and store it in the bme69x_data
  * structure instance passed by the user.
  *
+ * res_heat, idac and gas_wait are the set-points of the heater profile step
+ * gas_index. They come from the register shadow of dev, which holds what was
+ * last written, and are only read from the sensor while the shadow is not
+ * valid. They are not measured values.
+ *
  * @param[in]  op_mode : Expected operation mode.
  * @param[out] data    : Structure instance to hold the data.
  * @param[out] n_data  : Number of data instances available.
@@ -219,6 +265,76 @@ uint32_t bme69x_get_meas_dur(const uint8_t op_mode, struct bme69x_conf *conf, st
  */
 int8_t bme69x_get_data(uint8_t op_mode, struct bme69x_data *data, uint8_t *n_data, struct bme69x_dev *dev);
 
+/*!
+ * \ingroup bme69xApiData
+ * \page bme69x_api_bme69x_get_latest bme69x_get_latest
+ * \code
+ * int8_t bme69x_get_latest(struct bme69x_data *data, uint32_t *count, uint64_t *time_us, const struct bme69x_dev *dev);
+ * \endcode
+ * @details This API copies the newest sample bme69x_get_data or
+ * bme69x_try_collect has read, from the bme69x_dev.latest storage. It makes no bus access and does not take the
+ * device lock, so a consumer task never waits for the task reading the sensor.
+ * The copy is retried if a sample is published meanwhile.
+ *
+ * @param[out] data    : Newest sample
+ * @param[out] count   : Samples published so far, to tell a new sample from the last one. Optional
+ * @param[out] time_us : Time the sample was read, from bme69x_dev.get_time_us. Optional
+ * @param[in] dev      : Structure instance of bme69x_dev
+ *
+ * @return Result of API execution status
+ * @retval 0 -> Success
+ * @retval > 0 -> Warning, BME69X_W_NO_NEW_DATA before the first sample
+ * @retval < 0 -> Fail
+ */
+int8_t bme69x_get_latest(struct bme69x_data *data, uint32_t *count, uint64_t *time_us, const struct bme69x_dev *dev);
+
+/*!
+ * \ingroup bme69xApiData
+ * \page bme69x_api_bme69x_trigger_forced bme69x_trigger_forced
+ * \code
+ * int8_t bme69x_trigger_forced(struct bme69x_conf *conf, const struct bme69x_heatr_conf *heatr_conf,
+ *                              uint64_t *ready_us, struct bme69x_dev *dev);
+ * \endcode
+ * @details This API starts a forced mode measurement without waiting for it.
+ * The returned ready time is the measurement duration plus the heating duration,
+ * added to bme69x_dev.get_time_us when a time source is provided.
+ * Collect the data with bme69x_try_collect once that time has passed.
+ *
+ * @param[in]  conf       : Sensor configuration the measurement runs with.
+ * @param[in]  heatr_conf : Heater configuration the measurement runs with, can be NULL.
+ * @param[out] ready_us   : Time in microseconds when the data is expected.
+ * @param[in,out] dev     : Structure instance of bme69x_dev
+ *
+ * @return Result of API execution status
+ * @retval 0 -> Success
+ * @retval < 0 -> Fail
+ */
+int8_t bme69x_trigger_forced(struct bme69x_conf *conf,
+                             const struct bme69x_heatr_conf *heatr_conf,
+                             uint64_t *ready_us,
+                             struct bme69x_dev *dev);
+
+/*!
+ * \ingroup bme69xApiData
+ * \page bme69x_api_bme69x_try_collect bme69x_try_collect
+ * \code
+ * int8_t bme69x_try_collect(struct bme69x_data *data, uint8_t *n_data, struct bme69x_dev *dev);
+ * \endcode
+ * @details This API checks the new data bit of a forced mode measurement once
+ * and reads and compensates the data if it is set. It never sleeps. Collected
+ * data is published to bme69x_dev.latest like that of bme69x_get_data.
+ *
+ * @param[out] data    : Structure instance to hold the data.
+ * @param[out] n_data  : 1 if data was collected, 0 otherwise.
+ * @param[in,out] dev  : Structure instance of bme69x_dev
+ *
+ * @return Result of API execution status
+ * @retval 0 -> Success
+ * @retval BME69X_W_NO_NEW_DATA -> Measurement not finished yet, try again later
+ * @retval < 0 -> Fail
+ */
+int8_t bme69x_try_collect(struct bme69x_data *data, uint8_t *n_data, struct bme69x_dev *dev);
+
 /**
  * \ingroup bme69x
  * \defgroup bme69xApiConfig Configuration
@@ -267,6 +383,9 @@ int8_t bme69x_get_conf(struct bme69x_conf *conf, struct bme69x_dev *dev);
  * int8_t bme69x_set_heatr_conf(uint8_t op_mode, const struct bme69x_heatr_conf *conf, struct bme69x_dev *dev);
  * \endcode
  * @details This API is used to set the gas configuration of the sensor.
+ * When dev->heatr_lut points to caller storage, the heater resistance codes
+ * of 200 to 400 degC are taken from that table. It is filled on first use and
+ * again when dev->amb_temp moves by more than BME69X_HEATR_LUT_AMB_TOL.
  *
  * @param[in] op_mode : Expected operation mode of the sensor.
  * @param[in] conf    : Desired heating configuration.
@@ -282,34 +401,426 @@ int8_t bme69x_set_heatr_conf(uint8_t op_mode, const struct bme69x_heatr_conf *co
  * \ingroup bme69xApiConfig
  * \page bme69x_api_bme69x_get_heatr_conf bme69x_get_heatr_conf
  * \code
- * int8_t bme69x_get_heatr_conf(const struct bme69x_heatr_conf *conf, struct bme69x_dev *dev);
+ * int8_t bme69x_get_heatr_conf(uint8_t op_mode, struct bme69x_heatr_conf *conf, struct bme69x_dev *dev);
  * \endcode
- * @details This API is used to get the gas configuration of the sensor.
+ * @details This API is used to get the gas configuration of the sensor,
+ * decoded the way bme69x_set_heatr_conf takes it for the same operation mode.
+ * Temperatures are in degree Celsius and durations in milliseconds, except the
+ * parallel mode heater steps, which are multiples of shared_heatr_dur. Each
+ * register holds a rounded value, a heater resistance code covers about 4 degC,
+ * and the lowest temperature or duration giving the register value is returned.
+ * The shadow registers are decoded without bus access once the device is
+ * initialized.
  *
- * @param[out] conf   : Current configurations of the gas sensor.
- * @param[in,out] dev : Structure instance of bme69x_dev.
+ * @param[in] op_mode  : Operation mode the configuration was set for.
+ * @param[in,out] conf : Current configurations of the gas sensor. In sequential
+ *                       and parallel mode, profile_len sets the number of steps
+ *                       returned in heatr_temp_prof and heatr_dur_prof.
+ * @param[in,out] dev  : Structure instance of bme69x_dev.
  *
  * @return Result of API execution status
  * @retval 0 -> Success
  * @retval < 0 -> Fail
  */
-int8_t bme69x_get_heatr_conf(const struct bme69x_heatr_conf *conf, struct bme69x_dev *dev);
+int8_t bme69x_get_heatr_conf(uint8_t op_mode, struct bme69x_heatr_conf *conf, struct bme69x_dev *dev);
 
 /*!
  * \ingroup bme69xApiSystem
  * \page bme69x_api_bme69x_selftest_check bme69x_selftest_check
  * \code
- * int8_t bme69x_selftest_check(const struct bme69x_dev *dev);
+ * int8_t bme69x_selftest_check(struct bme69x_dev *dev);
  * \endcode
  * @details This API performs Self-test of low gas variant of BME69X
  *
+ * The self-test soft resets the sensor and leaves it in sleep mode with its own settings.
+ * The register shadow and SPI page of dev are updated to match, set the configuration and
+ * heater profile again before the next measurement.
+ *
  * @param[in, out]   dev  : Structure instance of bme69x_dev
  *
  * @return Result of API execution status
  * @retval 0 -> Success
  * @retval < 0 -> Fail
  */
-int8_t bme69x_selftest_check(const struct bme69x_dev *dev);
+int8_t bme69x_selftest_check(struct bme69x_dev *dev);
+
+/**
+ * \ingroup bme69x
+ * \defgroup bme69xApiStats Statistics
+ * @brief Per-API bus transaction statistics
+ */
+
+/*!
+ * \ingroup bme69xApiStats
+ * \page bme69x_api_bme69x_get_stats bme69x_get_stats
+ * \code
+ * int8_t bme69x_get_stats(struct bme69x_stats *stats, const struct bme69x_dev *dev);
+ * \endcode
+ * @details This API copies the bus transaction statistics gathered since the
+ * last reset. Statistics are only collected when dev->stats points to caller
+ * owned storage; every register read, register write and delay is accounted
+ * to the public API that issued it.
+ *
+ * @param[out] stats : Snapshot of the statistics, indexed by BME69X_STATS_API_*
+ * @param[in] dev    : Structure instance of bme69x_dev
+ *
+ * @return Result of API execution status
+ * @retval 0 -> Success
+ * @retval < 0 -> Fail
+ */
+int8_t bme69x_get_stats(struct bme69x_stats *stats, const struct bme69x_dev *dev);
+
+/*!
+ * \ingroup bme69xApiStats
+ * \page bme69x_api_bme69x_reset_stats bme69x_reset_stats
+ * \code
+ * int8_t bme69x_reset_stats(struct bme69x_dev *dev);
+ * \endcode
+ * @details This API clears the bus transaction statistics.
+ *
+ * @param[in,out] dev : Structure instance of bme69x_dev
+ *
+ * @return Result of API execution status
+ * @retval 0 -> Success
+ * @retval < 0 -> Fail
+ */
+int8_t bme69x_reset_stats(struct bme69x_dev *dev);
+
+/**
+ * \ingroup bme69x
+ * \defgroup bme69xApiBatch Batch compensation
+ * @brief Compensation of raw field records outside of a live sensor
+ */
+
+/*!
+ * \ingroup bme69xApiBatch
+ * \page bme69x_api_bme69x_compensate_records bme69x_compensate_records
+ * \code
+ * int8_t bme69x_compensate_records(const uint8_t *records,
+ *                                  uint32_t n_records,
+ *                                  const struct bme69x_calib_data *calib,
+ *                                  struct bme69x_data *data);
+ * \endcode
+ * @details This API compensates raw field records, for instance logged by an
+ * application and processed later on a host. A record is the BME69X_LEN_FIELD
+ * bytes of one field slot as read from BME69X_REG_FIELD0 onwards, records are
+ * stored back to back. The result is the same as bme69x_get_data would have
+ * returned for the field, except for idac, res_heat and gas_wait which are not
+ * part of a record and are set to 0.
+ *
+ * Records are processed in blocks of BME69X_COMP_BLOCK, with one loop per
+ * quantity over the block. The floating point build of these loops can be
+ * vectorised by the compiler, raise BME69X_COMP_BLOCK for host builds.
+ *
+ * @param[in] records   : n_records raw field records
+ * @param[in] n_records : Number of records
+ * @param[in] calib     : Calibration of the sensor that captured the records,
+ *                        as filled by bme69x_init
+ * @param[out] data     : n_records compensated fields
+ *
+ * @return Result of API execution status
+ * @retval 0 -> Success
+ * @retval < 0 -> Fail
+ */
+int8_t bme69x_compensate_records(const uint8_t *records,
+                                 uint32_t n_records,
+                                 const struct bme69x_calib_data *calib,
+                                 struct bme69x_data *data);
+
+/**
+ * \ingroup bme69x
+ * \defgroup bme69xApiCalib Calibration snapshot
+ * @brief Warm boot without the soft reset and calibration reads of bme69x_init
+ */
+
+/*!
+ * \ingroup bme69xApiCalib
+ * \page bme69x_api_bme69x_get_unique_id bme69x_get_unique_id
+ * \code
+ * int8_t bme69x_get_unique_id(uint32_t *unique_id, struct bme69x_dev *dev);
+ * \endcode
+ * @details This API reads the 32 bit unique ID of the sensor.
+ *
+ * @param[out] unique_id : Unique ID, first register in the most significant byte
+ * @param[in,out] dev    : Structure instance of bme69x_dev
+ *
+ * @return Result of API execution status
+ * @retval 0 -> Success
+ * @retval < 0 -> Fail
+ */
+int8_t bme69x_get_unique_id(uint32_t *unique_id, struct bme69x_dev *dev);
+
+/*!
+ * \ingroup bme69xApiCalib
+ * \page bme69x_api_bme69x_export_calib bme69x_export_calib
+ * \code
+ * int8_t bme69x_export_calib(uint8_t *blob, struct bme69x_dev *dev);
+ * \endcode
+ * @details This API saves the chip ID, variant ID, unique ID and calibration
+ * coefficients of a sensor initialised with bme69x_init into a snapshot of
+ * BME69X_LEN_CALIB_BLOB bytes. The snapshot is versioned, protected by a CRC
+ * and independent of the host endianness and of the floating point setting,
+ * so that it can be kept in NVS or RTC memory.
+ *
+ * @param[out] blob   : BME69X_LEN_CALIB_BLOB bytes of snapshot
+ * @param[in,out] dev : Structure instance of bme69x_dev
+ *
+ * @return Result of API execution status
+ * @retval 0 -> Success
+ * @retval < 0 -> Fail
+ */
+int8_t bme69x_export_calib(uint8_t *blob, struct bme69x_dev *dev);
+
+/*!
+ * \ingroup bme69xApiCalib
+ * \page bme69x_api_bme69x_import_calib bme69x_import_calib
+ * \code
+ * int8_t bme69x_import_calib(const uint8_t *blob, struct bme69x_dev *dev);
+ * \endcode
+ * @details This API initialises the device from a snapshot saved by
+ * bme69x_export_calib, in place of bme69x_init. It only reads the unique ID,
+ * to check that the snapshot belongs to this sensor, and the control
+ * registers. The sensor is not reset and keeps its configuration.
+ *
+ * On BME69X_E_CALIB_BLOB or BME69X_E_DEV_NOT_FOUND, call bme69x_init and
+ * save a new snapshot.
+ *
+ * @param[in] blob    : BME69X_LEN_CALIB_BLOB bytes of snapshot
+ * @param[in,out] dev : Structure instance of bme69x_dev
+ *
+ * @return Result of API execution status
+ * @retval 0 -> Success
+ * @retval BME69X_E_CALIB_BLOB -> Snapshot corrupt or of another layout version
+ * @retval BME69X_E_DEV_NOT_FOUND -> Snapshot of another sensor
+ * @retval < 0 -> Fail
+ */
+int8_t bme69x_import_calib(const uint8_t *blob, struct bme69x_dev *dev);
+
+/*!
+ * \ingroup bme69xApiCalib
+ * \page bme69x_api_bme69x_export_state bme69x_export_state
+ * \code
+ * int8_t bme69x_export_state(uint8_t *state, const struct bme69x_dev *dev);
+ * \endcode
+ * @details This API saves the chip ID, variant ID, calibration coefficients
+ * and the shadowed control registers of an initialised device into a snapshot
+ * of BME69X_LEN_STATE_BLOB bytes, without any bus access. Save it again after
+ * each configuration change, for instance right before the host enters deep
+ * sleep.
+ *
+ * @param[out] state : BME69X_LEN_STATE_BLOB bytes of snapshot
+ * @param[in] dev    : Structure instance of bme69x_dev
+ *
+ * @return Result of API execution status
+ * @retval 0 -> Success
+ * @retval BME69X_E_DEV_NOT_FOUND -> Device not initialised or registers not known
+ * @retval < 0 -> Fail
+ */
+int8_t bme69x_export_state(uint8_t *state, const struct bme69x_dev *dev);
+
+/*!
+ * \ingroup bme69xApiCalib
+ * \page bme69x_api_bme69x_resume bme69x_resume
+ * \code
+ * int8_t bme69x_resume(const uint8_t *state, struct bme69x_dev *dev);
+ * \endcode
+ * @details This API restores a device from a snapshot saved by
+ * bme69x_export_state, in place of bme69x_init, when the host wakes from
+ * deep sleep while the sensor stayed powered. The only bus access is the
+ * chip ID read. The configuration and heater profile are taken as still set
+ * in the sensor, so bme69x_set_op_mode(BME69X_FORCED_MODE) can follow right
+ * away and costs a single register write.
+ *
+ * The chip ID does not tell a sensor that lost power, and its configuration,
+ * from one that did not. Use bme69x_init after a power cycle of the sensor.
+ *
+ * @param[in] state   : BME69X_LEN_STATE_BLOB bytes of snapshot
+ * @param[in,out] dev : Structure instance of bme69x_dev
+ *
+ * @return Result of API execution status
+ * @retval 0 -> Success
+ * @retval BME69X_E_CALIB_BLOB -> Snapshot corrupt or of another layout version
+ * @retval BME69X_E_DEV_NOT_FOUND -> No BME69X answering
+ * @retval < 0 -> Fail
+ */
+int8_t bme69x_resume(const uint8_t *state, struct bme69x_dev *dev);
+
+/**
+ * \ingroup bme69x
+ * \defgroup bme69xApiSched Multi-sensor scheduling
+ * @brief Interleave the forced mode measurements of sensors sharing a bus
+ */
+
+/*!
+ * \ingroup bme69xApiSched
+ * \page bme69x_api_bme69x_sched_init bme69x_sched_init
+ * \code
+ * int8_t bme69x_sched_init(struct bme69x_sched *sched, struct bme69x_sched_sensor *sensors, uint8_t n_sensors,
+ *                          bme69x_sched_cb_t cb, void *cb_arg);
+ * \endcode
+ * @details This API prepares a scheduler running forced mode measurements on
+ * several sensors. A forced mode cycle spends most of its time heating, with
+ * the bus idle. The scheduler triggers each sensor on its own period and reads
+ * it when its measurement ends, so the bus accesses of one sensor fall inside
+ * the heating of the others. The first triggers are spread over the cycle of
+ * each sensor, so that sensors with the same period do not contend for the bus.
+ *
+ * The devices need a get_time_us callback, all on the time base of the first
+ * one, which also provides the delay used by bme69x_sched_run.
+ *
+ * @param[out] sched      : Scheduler
+ * @param[in,out] sensors : Sensors, with dev, conf, heatr_conf and period_us set
+ * @param[in] n_sensors   : Number of sensors, less than BME69X_SCHED_ALL
+ * @param[in] cb          : Called with every sample
+ * @param[in] cb_arg      : Argument of cb
+ *
+ * @return Result of API execution status
+ * @retval 0 -> Success
+ * @retval < 0 -> Fail
+ */
+int8_t bme69x_sched_init(struct bme69x_sched *sched,
+                         struct bme69x_sched_sensor *sensors,
+                         uint8_t n_sensors,
+                         bme69x_sched_cb_t cb,
+                         void *cb_arg);
+
+/*!
+ * \ingroup bme69xApiSched
+ * \page bme69x_api_bme69x_sched_poll bme69x_sched_poll
+ * \code
+ * int8_t bme69x_sched_poll(struct bme69x_sched *sched, uint32_t *wait_us);
+ * \endcode
+ * @details This API reads the sensors whose measurement has ended, delivers
+ * their samples and triggers the sensors whose period has started. It never
+ * sleeps. Call it again after wait_us, with whatever sleep the platform
+ * offers. Failed bus accesses are counted in the errors of the sensor and
+ * retried, they do not stop the other sensors.
+ *
+ * @param[in,out] sched : Scheduler
+ * @param[out] wait_us  : Time until the next sensor needs attention
+ *
+ * @return Result of API execution status
+ * @retval 0 -> Success
+ * @retval < 0 -> Fail
+ */
+int8_t bme69x_sched_poll(struct bme69x_sched *sched, uint32_t *wait_us);
+
+/*!
+ * \ingroup bme69xApiSched
+ * \page bme69x_api_bme69x_sched_run bme69x_sched_run
+ * \code
+ * int8_t bme69x_sched_run(struct bme69x_sched *sched, uint32_t duration_us);
+ * \endcode
+ * @details This API polls the scheduler for duration_us, sleeping between
+ * polls with the delay callback of the first device.
+ *
+ * @param[in,out] sched   : Scheduler
+ * @param[in] duration_us : Time to run for
+ *
+ * @return Result of API execution status
+ * @retval 0 -> Success
+ * @retval < 0 -> Fail
+ */
+int8_t bme69x_sched_run(struct bme69x_sched *sched, uint32_t duration_us);
+
+/*!
+ * \ingroup bme69xApiSched
+ * \page bme69x_api_bme69x_sched_get_rate bme69x_sched_get_rate
+ * \code
+ * int8_t bme69x_sched_get_rate(const struct bme69x_sched *sched, uint8_t sensor, uint32_t *rate_mhz);
+ * \endcode
+ * @details This API reports the sample rate achieved since bme69x_sched_init,
+ * by one sensor or by all of them together.
+ *
+ * @param[in] sched     : Scheduler
+ * @param[in] sensor    : Index of the sensor, or BME69X_SCHED_ALL for the aggregate rate
+ * @param[out] rate_mhz : Samples per 1000 seconds, that is in millihertz
+ *
+ * @return Result of API execution status
+ * @retval 0 -> Success
+ * @retval BME69X_E_INVALID_LENGTH -> No such sensor
+ * @retval < 0 -> Fail
+ */
+int8_t bme69x_sched_get_rate(const struct bme69x_sched *sched, uint8_t sensor, uint32_t *rate_mhz);
+
+/**
+ * \ingroup bme69x
+ * \defgroup bme69xApiSeq Sequential profile engine
+ * @brief Read every step of a sequential mode heater profile just in time
+ */
+
+/*!
+ * \ingroup bme69xApiSeq
+ * \page bme69x_api_bme69x_seq_start bme69x_seq_start
+ * \code
+ * int8_t bme69x_seq_start(struct bme69x_seq *seq, bme69x_seq_cb_t cb, void *cb_arg, struct bme69x_dev *dev);
+ * \endcode
+ * @details This API starts the heater profile set with bme69x_set_conf and
+ * bme69x_set_heatr_conf in sequential mode. It takes the duration of every
+ * step from the TPH oversampling and the heater durations of the profile, and
+ * the standby between two cycles from the ODR setting, from the shadow
+ * registers when they are valid. The sensor holds only three steps, so the
+ * engine reads them when the third has ended and before the fourth ends. A
+ * 10 step profile is then read with 10 reads every three cycles. Each read
+ * also tells whether the sensor runs faster or slower than the datasheet
+ * durations, first assumed within BME69X_SEQ_TIMING_TOL_PCT, and the
+ * following reads are scheduled on the narrowed estimate.
+ *
+ * Start from sleep mode, with no unread parallel or sequential mode data. The
+ * device needs a get_time_us callback. Stop the profile with
+ * bme69x_set_op_mode(BME69X_SLEEP_MODE, ...).
+ *
+ * @param[out] seq   : Profile engine
+ * @param[in] cb     : Called with every step, in order
+ * @param[in] cb_arg : Argument of cb
+ * @param[in,out] dev : Structure instance of bme69x_dev
+ *
+ * @return Result of API execution status
+ * @retval 0 -> Success
+ * @retval < 0 -> Fail
+ */
+int8_t bme69x_seq_start(struct bme69x_seq *seq, bme69x_seq_cb_t cb, void *cb_arg, struct bme69x_dev *dev);
+
+/*!
+ * \ingroup bme69xApiSeq
+ * \page bme69x_api_bme69x_seq_poll bme69x_seq_poll
+ * \code
+ * int8_t bme69x_seq_poll(struct bme69x_seq *seq, uint32_t *wait_us);
+ * \endcode
+ * @details This API reads the data fields when the next read is due and
+ * delivers the new steps in order. Each step gets a number counting from the
+ * first step of the profile, kept across the wraparound of meas_index, and
+ * the time it ended. That time is predicted from the profile, and corrected
+ * when a read finds a step earlier or later than predicted. Steps overwritten
+ * before they were read are counted in lost and skipped in the numbering. It
+ * never sleeps, call it again after wait_us.
+ *
+ * @param[in,out] seq  : Profile engine
+ * @param[out] wait_us : Time until the next read
+ *
+ * @return Result of API execution status
+ * @retval 0 -> Success
+ * @retval < 0 -> Fail
+ */
+int8_t bme69x_seq_poll(struct bme69x_seq *seq, uint32_t *wait_us);
+
+/*!
+ * \ingroup bme69xApiSeq
+ * \page bme69x_api_bme69x_seq_run bme69x_seq_run
+ * \code
+ * int8_t bme69x_seq_run(struct bme69x_seq *seq, uint32_t duration_us);
+ * \endcode
+ * @details This API polls the profile engine for duration_us, sleeping
+ * between reads with the delay callback of the device.
+ *
+ * @param[in,out] seq     : Profile engine
+ * @param[in] duration_us : Time to run for
+ *
+ * @return Result of API execution status
+ * @retval 0 -> Success
+ * @retval < 0 -> Fail
+ */
+int8_t bme69x_seq_run(struct bme69x_seq *seq, uint32_t duration_us);
 
 #ifdef __cplusplus
 }
@@ -132,6 +132,9 @@
 /* Self test fail error */
 #define BME69X_E_SELF_TEST                        INT8_C(-5)
 
+/* Calibration snapshot corrupt, of another layout version or of another chip */
+#define BME69X_E_CALIB_BLOB                       INT8_C(-6)
+
 /* Warnings */
 /* Define a valid operation mode */
 #define BME69X_W_DEFINE_OP_MODE                   INT8_C(1)
@@ -336,11 +339,129 @@
 /* Length between two fields */
 #define BME69X_LEN_FIELD_OFFSET                   UINT8_C(17)
 
+/* Number of data fields */
+#define BME69X_N_FIELDS                           UINT8_C(3)
+
+/*
+ * Number of fields compensated per pass, sizes the stack arrays of the compensation. Host builds
+ * running bme69x_compensate_records on large batches can raise it, up to 255. At least BME69X_N_FIELDS.
+ */
+#ifndef BME69X_COMP_BLOCK
+#define BME69X_COMP_BLOCK                         UINT8_C(8)
+#endif
+
 /* Length of the configuration register */
 #define BME69X_LEN_CONFIG                         UINT8_C(5)
 
-/* Length of the interleaved buffer */
-#define BME69X_LEN_INTERLEAVE_BUFF                UINT8_C(20)
+/* Length of the heater set-point span idac, res_heat and gas_wait of one profile step */
+#define BME69X_LEN_HEATR_READBACK                 UINT8_C(21)
+
+/* Length of the unique ID */
+#define BME69X_LEN_UNIQUE_ID                      UINT8_C(4)
+
+/* Length of the calibration coefficients in a calibration snapshot */
+#define BME69X_LEN_CALIB_COEFF                    UINT8_C(36)
+
+/*
+ * Length of a calibration snapshot: layout version, chip id, variant id, unique id,
+ * calibration coefficients and a CRC-16 over all of them
+ */
+#define BME69X_LEN_CALIB_BLOB                     UINT8_C(45)
+
+/* Layout version of a calibration snapshot */
+#define BME69X_CALIB_BLOB_VERSION                 UINT8_C(1)
+
+/*
+ * Length of a device state snapshot: layout version, chip id, variant id, calibration coefficients,
+ * shadowed control registers and a CRC-16 over all of them
+ */
+#define BME69X_LEN_STATE_BLOB                     UINT8_C(79)
+
+/* Layout version of a device state snapshot */
+#define BME69X_STATE_BLOB_VERSION                 UINT8_C(1)
+
+/* Lowest heater temperature of the heater resistance lookup table, in degree Celsius */
+#define BME69X_HEATR_LUT_MIN_TEMP                 UINT16_C(200)
+
+/* Highest heater temperature of the heater resistance lookup table, the heater cap */
+#define BME69X_HEATR_LUT_MAX_TEMP                 UINT16_C(400)
+
+/* Entries of the heater resistance lookup table, one per degree Celsius */
+#define BME69X_HEATR_LUT_LEN                      UINT16_C(201)
+
+/* Scheduler sensor waiting for its next trigger */
+#define BME69X_SCHED_IDLE                         UINT8_C(0)
+
+/* Scheduler sensor running a forced mode measurement */
+#define BME69X_SCHED_MEASURING                    UINT8_C(1)
+
+/* Interval at which the scheduler polls a measurement not ready at its expected time, in microseconds */
+#define BME69X_SCHED_RETRY_US                     UINT32_C(1000)
+
+/* Time after its expected end the scheduler gives up on a measurement, in microseconds */
+#define BME69X_SCHED_TIMEOUT_US                   UINT32_C(50000)
+
+/* Sensor index selecting all sensors of a scheduler */
+#define BME69X_SCHED_ALL                          UINT8_C(0xFF)
+
+/* Deviation of the sensor timing from the datasheet durations the sequential profile engine starts with, in percent */
+#define BME69X_SEQ_TIMING_TOL_PCT                 UINT32_C(10)
+
+/* Fractional bits of the timing scale of the sequential profile engine */
+#define BME69X_SEQ_SCALE_SHIFT                    UINT8_C(24)
+
+/* Nominal time after which the sequential profile engine moves its time base forward, in microseconds */
+#define BME69X_SEQ_REBASE_US                      UINT64_C(0x100000000)
+
+/* Time after the estimated end of a step at which the sequential profile engine reads it, in microseconds */
+#define BME69X_SEQ_MARGIN_US                      UINT32_C(500)
+
+/*
+ * Change of bme69x_dev.amb_temp, in degree Celsius, the heater resistance lookup table tolerates
+ * before it is regenerated. Each degree moves a code by about a third of a step.
+ */
+#ifndef BME69X_HEATR_LUT_AMB_TOL
+#define BME69X_HEATR_LUT_AMB_TOL                  UINT8_C(2)
+#endif
+
+/*
+ * Full memory barrier ordering the latest sample and its count between tasks or cores. Define it for
+ * compilers other than GCC and Clang.
+ */
+#ifndef BME69X_MEMORY_BARRIER
+#if defined(__GNUC__)
+#define BME69X_MEMORY_BARRIER()                   __sync_synchronize()
+#else
+#define BME69X_MEMORY_BARRIER()
+#endif
+#endif
+
+/* Length of the shadowed control registers from BME69X_REG_IDAC_HEAT0(0x50) up to BME69X_REG_CONFIG(0x75) */
+#define BME69X_LEN_SHADOW                         UINT8_C(38)
+
+/* Length of the interleaved buffer, address and data pairs for the whole shadowed control block */
+#define BME69X_LEN_INTERLEAVE_BUFF                UINT8_C(76)
+
+/* Public API entry points the bus statistics are broken down by */
+#define BME69X_STATS_API_NONE                     UINT8_C(0)
+#define BME69X_STATS_API_REGS                     UINT8_C(1)
+#define BME69X_STATS_API_INIT                     UINT8_C(2)
+#define BME69X_STATS_API_SOFT_RESET               UINT8_C(3)
+#define BME69X_STATS_API_SET_CONF                 UINT8_C(4)
+#define BME69X_STATS_API_GET_CONF                 UINT8_C(5)
+#define BME69X_STATS_API_SET_OP_MODE              UINT8_C(6)
+#define BME69X_STATS_API_GET_OP_MODE              UINT8_C(7)
+#define BME69X_STATS_API_GET_DATA                 UINT8_C(8)
+#define BME69X_STATS_API_SET_HEATR_CONF           UINT8_C(9)
+#define BME69X_STATS_API_GET_HEATR_CONF           UINT8_C(10)
+#define BME69X_STATS_API_TRIGGER_FORCED           UINT8_C(11)
+#define BME69X_STATS_API_TRY_COLLECT              UINT8_C(12)
+#define BME69X_STATS_API_SELFTEST                 UINT8_C(13)
+#define BME69X_STATS_API_IMPORT_CALIB             UINT8_C(14)
+#define BME69X_STATS_API_RESUME                   UINT8_C(15)
+
+/* Number of bus statistics entries */
+#define BME69X_STATS_N_API                        UINT8_C(16)
 
 /* Coefficient index macros */
 
@@ -698,6 +819,26 @@ typedef BME69X_INTF_RET_TYPE (*bme69x_write_fptr_t)(uint8_t reg_addr, const uint
  */
 typedef void (*bme69x_delay_us_fptr_t)(uint32_t period, void *intf_ptr);
 
+/*!
+ * @brief Optional time function pointer which can be mapped to a
+ * monotonic microsecond timer of the user
+ *
+ * @param[in,out] intf_ptr : Void pointer that can enable the linking of descriptors
+ *                           for interface related callbacks
+ * @return Current time in microseconds
+ */
+typedef uint64_t (*bme69x_get_time_us_fptr_t)(void *intf_ptr);
+
+/*!
+ * @brief Optional lock function pointer which can be mapped to a recursive
+ * mutex of the user, taken or given around every public API call. Public APIs
+ * call each other, so the same task takes the lock again while holding it.
+ *
+ * @param[in,out] intf_ptr : Void pointer that can enable the linking of descriptors
+ *                           for interface related callbacks
+ */
+typedef void (*bme69x_lock_fptr_t)(void *intf_ptr);
+
 /*
  * @brief Generic communication function pointer
  * @param[in] dev_id: Place holder to store the id of the device structure
@@ -735,13 +876,13 @@ struct bme69x_data
     /*! Measurement index to track order */
     uint8_t meas_index;
 
-    /*! Heater resistance */
+    /*! Heater resistance set-point of step gas_index, from the register shadow */
     uint8_t res_heat;
 
-    /*! Current DAC */
+    /*! Current DAC set-point of step gas_index, from the register shadow */
     uint8_t idac;
 
-    /*! Gas wait period */
+    /*! Gas wait period of step gas_index, from the register shadow */
     uint8_t gas_wait;
 #ifndef BME69X_USE_FPU
 
@@ -757,8 +898,8 @@ struct bme69x_data
     /*! Gas resistance in Ohms */
     uint32_t gas_resistance;
 
-    /*! Intermediate temperature co-efficient for pressure calculation */
-    uint32_t t_lin;
+    /*! Intermediate temperature co-efficient for pressure and humidity calculation, degree celsius x65536 */
+    int32_t t_lin;
 #else
 
     /*! Temperature in degree celsius */
@@ -767,7 +908,7 @@ struct bme69x_data
     /*! Pressure in Pascal */
     float pressure;
 
-    /*! Humidity in % relative humidity x1000 */
+    /*! Humidity in % relative humidity */
     float humidity;
 
     /*! Gas resistance in Ohms */
@@ -777,6 +918,70 @@ struct bme69x_data
 
 };
 
+/*
+ * @brief Newest sample of a device, published by bme69x_get_data and
+ * bme69x_try_collect and read without the device lock by bme69x_get_latest
+ */
+struct bme69x_latest
+{
+    /*! Two copies, the publisher fills the one that does not hold the newest sample */
+    struct bme69x_data data[2];
+
+    /*! Time of each copy from bme69x_dev.get_time_us, 0 without a time function */
+    uint64_t time_us[2];
+
+    /*! Samples published, the newest is in data[(count - 1) % 2] */
+    volatile uint32_t count;
+};
+
+#ifdef BME69X_USE_FPU
+
+/*
+ * @brief Calibration coefficients scaled for the floating point compensation, so that
+ * every sample is only multiplies and adds. Filled by bme69x_init.
+ */
+struct bme69x_calib_fpu
+{
+    /*! Temperature: par_t1 * 2^8, par_t2 / 2^30, par_t3 / 2^48 */
+    int32_t do1;
+    double dtk1;
+    double dtk2;
+
+    /*! Pressure offset: par_p1 * 2^3, par_p2 / 2^6, par_p3 / 2^8, par_p4 / 2^15 */
+    double o;
+    double tk10;
+    double tk20;
+    double tk30;
+
+    /*! Pressure sensitivity: (par_p5 - 2^14) / 2^20, (par_p6 - 2^14) / 2^29, par_p7 / 2^32, par_p8 / 2^37 */
+    double s;
+    double tk1s;
+    double tk2s;
+    double tk3s;
+
+    /*! Pressure non-linearity: par_p9 / 2^48, par_p10 / 2^48, par_p11 / 2^65 */
+    double nls;
+    double tknls;
+    double nls3;
+
+    /*! Humidity: par_h1 * 2^6, par_h5 / 2^16, par_h2 / 2^14, par_h4 / 2^26, par_h4 * par_h3 / 2^52, par_h6 / 2^19 */
+    double oh;
+    double sh;
+    double tk10h;
+    double tk1sh;
+    double tk12sh;
+    double hlin2;
+
+    /*! Heater: par_g1 / 16 + 49, par_g2 / 2^15 * 0.0005 + 0.00235, par_g3 / 2^10 */
+    float g1;
+    float g2;
+    float g3;
+
+    /*! Heater: 4 / (4 + res_heat_range) / (1 + res_heat_val * 0.002) */
+    float res_heat_scale;
+};
+#endif
+
 struct bme69x_calib_data
 {
     /*! Calibration coefficient for the humidity sensor */
@@ -864,6 +1069,66 @@ struct bme69x_calib_data
 
     /*! Gas resistance range switching error coefficient */
     int8_t range_sw_err;
+#ifdef BME69X_USE_FPU
+
+    /*! Coefficients scaled once for the floating point compensation */
+    struct bme69x_calib_fpu fpu;
+#endif
+};
+
+/*
+ * @brief Bus statistics of one public API entry point
+ */
+struct bme69x_stats_entry
+{
+    /*! Number of calls, public APIs called by another public API count towards the outer one */
+    uint32_t calls;
+
+    /*! Number of read transactions */
+    uint32_t reads;
+
+    /*! Number of write transactions */
+    uint32_t writes;
+
+    /*! Data bytes read */
+    uint32_t bytes_read;
+
+    /*! Register address and data bytes written */
+    uint32_t bytes_written;
+
+    /*! Failed transactions */
+    uint32_t errors;
+
+    /*! Time spent in the read and write callbacks, needs bme69x_dev.get_time_us */
+    uint64_t bus_time_us;
+
+    /*! Time spent in the delay callback, requested periods without bme69x_dev.get_time_us */
+    uint64_t sleep_time_us;
+};
+
+/*
+ * @brief Bus statistics of a device, indexed by BME69X_STATS_API_*
+ */
+struct bme69x_stats
+{
+    /*! Statistics per API entry point */
+    struct bme69x_stats_entry api[BME69X_STATS_N_API];
+};
+
+/*
+ * @brief Heater resistance codes of a device for BME69X_HEATR_LUT_MIN_TEMP to
+ * BME69X_HEATR_LUT_MAX_TEMP, filled by the driver on first use
+ */
+struct bme69x_heatr_lut
+{
+    /*! Register code of every degree Celsius from BME69X_HEATR_LUT_MIN_TEMP */
+    uint8_t res_heat[BME69X_HEATR_LUT_LEN];
+
+    /*! Ambient temperature the codes were calculated for */
+    int8_t amb_temp;
+
+    /*! Set once the codes match the calibration of the device */
+    uint8_t valid;
 };
 
 /*
@@ -954,6 +1219,9 @@ struct bme69x_dev
     /*! Memory page used */
     uint8_t mem_page;
 
+    /*! Last value read from or written to the SPI memory page register */
+    uint8_t mem_page_reg;
+
     /*! Ambient temperature in Degree C*/
     int8_t amb_temp;
 
@@ -969,11 +1237,195 @@ struct bme69x_dev
     /*! Delay function pointer */
     bme69x_delay_us_fptr_t delay_us;
 
+    /*! Time function pointer, optional */
+    bme69x_get_time_us_fptr_t get_time_us;
+
+    /*! Lock function pointers, optional. NULL when only one task uses the device */
+    bme69x_lock_fptr_t lock;
+    bme69x_lock_fptr_t unlock;
+
     /*! To store interface pointer error */
     BME69X_INTF_RET_TYPE intf_rslt;
 
     /*! Store the info messages */
     uint8_t info_msg;
+
+    /*!
+     * Write-through copy of the control registers BME69X_REG_IDAC_HEAT0 to
+     * BME69X_REG_CONFIG, kept in step by bme69x_set_regs and bme69x_get_regs.
+     * The mode bits of CTRL_MEAS hold the last mode written.
+     */
+    uint8_t shadow[BME69X_LEN_SHADOW];
+
+    /*! Set once the shadow registers match the sensor */
+    uint8_t shadow_valid;
+
+    /*! Bus statistics storage of the user, optional. NULL disables the accounting */
+    struct bme69x_stats *stats;
+
+    /*! Public API the bus traffic is currently accounted to */
+    uint8_t stats_api;
+
+    /*! Heater resistance lookup table storage of the user, optional. NULL calculates every code */
+    struct bme69x_heatr_lut *heatr_lut;
+
+    /*! Latest sample storage of the user, optional. NULL does not keep the newest sample */
+    struct bme69x_latest *latest;
+};
+
+/*!
+ * @brief Sample callback of the multi-sensor scheduler
+ *
+ * @param[in] sensor  : Index of the sensor in the scheduler
+ * @param[in] data    : Compensated forced mode data
+ * @param[in] time_us : Time the poll found the measurement due, right before the data was read
+ * @param[in] arg     : Argument given to bme69x_sched_init
+ */
+typedef void (*bme69x_sched_cb_t)(uint8_t sensor, const struct bme69x_data *data, uint64_t time_us, void *arg);
+
+/*
+ * @brief Sensor of a multi-sensor scheduler
+ */
+struct bme69x_sched_sensor
+{
+    /*! Initialised device, its heater configured for forced mode. Set by the user */
+    struct bme69x_dev *dev;
+
+    /*! Configuration the measurements run with. Set by the user */
+    struct bme69x_conf *conf;
+
+    /*! Heater configuration the measurements run with, NULL without gas measurement. Set by the user */
+    const struct bme69x_heatr_conf *heatr_conf;
+
+    /*! Target sampling period in microseconds, 0 for back to back measurements. Set by the user */
+    uint32_t period_us;
+
+    /*! BME69X_SCHED_IDLE or BME69X_SCHED_MEASURING */
+    uint8_t state;
+
+    /*! Time of the next trigger when idle, of the next data poll when measuring */
+    uint64_t next_us;
+
+    /*! Scheduled time of the last trigger, the start of its period */
+    uint64_t trigger_us;
+
+    /*! Expected end of the measurement in progress */
+    uint64_t ready_us;
+
+    /*! Samples delivered */
+    uint32_t samples;
+
+    /*! Failed triggers and reads, and measurements that never completed */
+    uint32_t errors;
+
+    /*! Measurements that did not fit in their period, the next one started late */
+    uint32_t overruns;
+};
+
+/*
+ * @brief Multi-sensor scheduler, interleaving the forced mode measurements of sensors on one bus
+ */
+struct bme69x_sched
+{
+    /*! Sensors scheduled */
+    struct bme69x_sched_sensor *sensors;
+
+    /*! Number of sensors */
+    uint8_t n_sensors;
+
+    /*! Sample callback */
+    bme69x_sched_cb_t cb;
+
+    /*! Argument of the sample callback */
+    void *cb_arg;
+
+    /*! Time the scheduler was started */
+    uint64_t start_us;
+};
+
+/*
+ * @brief Measurement timing of an operation mode, from the register values the sensor runs
+ */
+struct bme69x_timing
+{
+    /*! Duration of each step, wake-up, TPH measurement and heating, in microseconds */
+    uint32_t step_us[10];
+
+    /*! Number of steps of a cycle, 1 in forced mode */
+    uint8_t n_steps;
+
+    /*! Standby after the last step before the next cycle, in microseconds. Sequential mode only */
+    uint32_t standby_us;
+
+    /*! Duration of a whole cycle, the steps and the standby, in microseconds */
+    uint32_t cycle_us;
+};
+
+/*!
+ * @brief Step callback of the sequential profile engine
+ *
+ * @param[in] data    : Compensated data of the step
+ * @param[in] seq     : Number of the step since bme69x_seq_start, its profile step is seq modulo the profile length
+ * @param[in] time_us : End of the step, estimated from the profile and bounded by the reads around it
+ * @param[in] arg     : Argument given to bme69x_seq_start
+ */
+typedef void (*bme69x_seq_cb_t)(const struct bme69x_data *data, uint32_t seq, uint64_t time_us, void *arg);
+
+/*
+ * @brief Sequential mode profile engine, reading every step of a heater profile just in time
+ */
+struct bme69x_seq
+{
+    /*! Device running the profile */
+    struct bme69x_dev *dev;
+
+    /*! Step callback */
+    bme69x_seq_cb_t cb;
+
+    /*! Argument of the step callback */
+    void *cb_arg;
+
+    /*! Datasheet timing of the profile */
+    struct bme69x_timing timing;
+
+    /*! Set once a step has been read, last_index is valid */
+    uint8_t started;
+
+    /*! meas_index of the last step delivered */
+    uint8_t last_index;
+
+    /*! Number of the next step to deliver */
+    uint32_t seq;
+
+    /*! Time base of the predictions */
+    uint64_t start_us;
+
+    /*! Datasheet time from start_us to the end of the step before seq */
+    uint64_t nominal_us;
+
+    /*! Lower bound of the sensor time per datasheet time, in 2^-BME69X_SEQ_SCALE_SHIFT */
+    uint32_t scale_lo;
+
+    /*! Upper bound of the sensor time per datasheet time, in 2^-BME69X_SEQ_SCALE_SHIFT */
+    uint32_t scale_hi;
+
+    /*! Start of the last successful read */
+    uint64_t read_us;
+
+    /*! Time of the next read */
+    uint64_t next_us;
+
+    /*! Steps delivered */
+    uint32_t samples;
+
+    /*! Steps overwritten in the sensor before they were read */
+    uint32_t lost;
+
+    /*! Reads of the data fields */
+    uint32_t polls;
+
+    /*! Failed reads */
+    uint32_t errors;
 };
 
 #endif /* BME69X_DEFS_H_ */
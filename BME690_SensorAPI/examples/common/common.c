@@ -81,6 +81,16 @@ void bme69x_delay_us(uint32_t period, void *intf_ptr)
     coines_delay_usec(period);
 }
 
+/*!
+ * Time base function map to COINES platform
+ */
+uint64_t bme69x_get_time_us(void *intf_ptr)
+{
+    (void)intf_ptr;
+
+    return coines_get_micro_sec();
+}
+
 void bme69x_check_rslt(const char api_name[], int8_t rslt)
 {
     switch (rslt)
@@ -104,6 +114,9 @@ void bme69x_check_rslt(const char api_name[], int8_t rslt)
         case BME69X_E_SELF_TEST:
             printf("API name [%s]  Error [%d] : Self test error\r\n", api_name, rslt);
             break;
+        case BME69X_E_CALIB_BLOB:
+            printf("API name [%s]  Error [%d] : Invalid calibration snapshot\r\n", api_name, rslt);
+            break;
         case BME69X_W_NO_NEW_DATA:
             printf("API name [%s]  Warning [%d] : No new data found\r\n", api_name, rslt);
             break;
@@ -181,6 +194,7 @@ int8_t bme69x_interface_init(struct bme69x_dev *bme, uint8_t intf)
         coines_delay_msec(100);
 
         bme->delay_us = bme69x_delay_us;
+        bme->get_time_us = bme69x_get_time_us;
         bme->intf_ptr = &dev_addr;
         bme->amb_temp = 25; /* The ambient temperature in deg C is used for defining the heater temperature */
     }
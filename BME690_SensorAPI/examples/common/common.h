@@ -94,6 +94,16 @@ BME69X_INTF_RET_TYPE bme69x_spi_write(uint8_t reg_addr, const uint8_t *reg_data,
  */
 void bme69x_delay_us(uint32_t period, void *intf_ptr);
 
+/*!
+ * @brief This function provides the time base used to schedule the reads of some of the APIs.
+ *
+ *  @param[in] intf_ptr     : Interface pointer
+ *
+ *  @return Time in microseconds.
+ *
+ */
+uint64_t bme69x_get_time_us(void *intf_ptr);
+
 /*!
  *  @brief Prints the execution status of the APIs.
  *
@@ -22,17 +22,44 @@
 /*                         Test code                                   */
 /***********************************************************************/
 
+/* Prints every step of the profile with the time it ended */
+static void print_step(const struct bme69x_data *data, uint32_t seq, uint64_t time_us, void *arg)
+{
+    (void)arg;
+
+#ifdef BME69X_USE_FPU
+    printf("%lu,%lu,%.2f,%.2f,%.2f,%.2f,0x%x,%d,%d\n",
+           (long unsigned int)seq + 1,
+           (long unsigned int)(time_us / 1000),
+           data->temperature,
+           data->pressure,
+           data->humidity,
+           data->gas_resistance,
+           data->status,
+           data->gas_index,
+           data->meas_index);
+#else
+    printf("%lu, %lu, %d, %lu, %lu, %lu, 0x%x, %d, %d\n",
+           (long unsigned int)seq + 1,
+           (long unsigned int)(time_us / 1000),
+           (data->temperature),
+           (long unsigned int)data->pressure,
+           (long unsigned int)(data->humidity),
+           (long unsigned int)data->gas_resistance,
+           data->status,
+           data->gas_index,
+           data->meas_index);
+#endif
+}
+
 int main(void)
 {
     struct bme69x_dev bme;
     int8_t rslt;
     struct bme69x_conf conf;
     struct bme69x_heatr_conf heatr_conf;
-    struct bme69x_data data[3];
-    uint32_t del_period;
-    uint32_t time_ms = 0;
-    uint8_t n_fields;
-    uint16_t sample_count = 1;
+    struct bme69x_seq seq;
+    uint32_t wait_us;
 
     /* Heater temperature in degree Celsius */
     uint16_t temp_prof[10] = { 200, 240, 280, 320, 360, 360, 320, 280, 240, 200 };
@@ -71,54 +98,24 @@ int main(void)
     rslt = bme69x_set_heatr_conf(BME69X_SEQUENTIAL_MODE, &heatr_conf, &bme);
     bme69x_check_rslt("bme69x_set_heatr_conf", rslt);
 
-    /* Check if rslt == BME69X_OK, report or handle if otherwise */
-    rslt = bme69x_set_op_mode(BME69X_SEQUENTIAL_MODE, &bme);
-    bme69x_check_rslt("bme69x_set_op_mode", rslt);
-
-    /* Check if rslt == BME69X_OK, report or handle if otherwise */
     printf(
         "Sample, TimeStamp(ms), Temperature(deg C), Pressure(Pa), Humidity(%%), Gas resistance(ohm), Status, Profile index, Measurement index\n");
-    while (sample_count <= SAMPLE_COUNT)
-    {
-        /* Calculate delay period in microseconds */
-        del_period = bme69x_get_meas_dur(BME69X_SEQUENTIAL_MODE, &conf, &bme) + (heatr_conf.heatr_dur_prof[0] * 1000);
-        bme.delay_us(del_period, bme.intf_ptr);
-
-        time_ms = coines_get_millis();
 
-        rslt = bme69x_get_data(BME69X_SEQUENTIAL_MODE, data, &n_fields, &bme);
-        bme69x_check_rslt("bme69x_get_data", rslt);
+    /* Check if rslt == BME69X_OK, report or handle if otherwise */
+    rslt = bme69x_seq_start(&seq, print_step, NULL, &bme);
+    bme69x_check_rslt("bme69x_seq_start", rslt);
 
-        /* Check if rslt == BME69X_OK, report or handle if otherwise */
-        for (uint8_t i = 0; i < n_fields; i++)
-        {
-#ifdef BME69X_USE_FPU
-            printf("%u,%lu,%.2f,%.2f,%.2f,%.2f,0x%x,%d,%d\n",
-                   sample_count,
-                   (long unsigned int)time_ms + (i * (del_period / 2000)),
-                   data[i].temperature,
-                   data[i].pressure,
-                   data[i].humidity,
-                   data[i].gas_resistance,
-                   data[i].status,
-                   data[i].gas_index,
-                   data[i].meas_index);
-#else
-            printf("%u, %lu, %d, %lu, %lu, %lu, 0x%x, %d, %d\n",
-                   sample_count,
-                   (long unsigned int)time_ms + (i * (del_period / 2000)),
-                   (data[i].temperature),
-                   (long unsigned int)data[i].pressure,
-                   (long unsigned int)(data[i].humidity),
-                   (long unsigned int)data[i].gas_resistance,
-                   data[i].status,
-                   data[i].gas_index,
-                   data[i].meas_index);
-#endif
-            sample_count++;
-        }
+    /* The engine reads the steps three at a time, just after the third has ended */
+    while ((rslt == BME69X_OK) && (seq.samples + seq.lost < SAMPLE_COUNT))
+    {
+        rslt = bme69x_seq_poll(&seq, &wait_us);
+        bme69x_check_rslt("bme69x_seq_poll", rslt);
+        bme.delay_us(wait_us, bme.intf_ptr);
     }
 
+    rslt = bme69x_set_op_mode(BME69X_SLEEP_MODE, &bme);
+    bme69x_check_rslt("bme69x_set_op_mode", rslt);
+
     bme69x_coines_deinit();
 
     return 0;
@@ -0,0 +1,222 @@
+#include <stdlib.h>
+#include "bme69x_i2c_async.h"
+
+const static char *TAG = "bme69x_i2c_async";
+
+/**
+ * @brief Queue item, a request resolved to the interface context of its sensor
+ */
+typedef struct {
+    bme69x_i2c_async_op_t op;
+    bme69x_intf_t *intf;                /*!< NULL asks the worker to stop */
+    uint8_t reg_addr;
+    uint8_t *data;
+    uint32_t len;
+    bme69x_i2c_async_cb_t cb;
+    void *cb_arg;
+    bme69x_i2c_async_future_t *future;
+} async_item_t;
+
+/**
+ * @brief Bus worker
+ */
+struct bme69x_i2c_async_bus {
+    QueueHandle_t queue;                /*!< Pending transfers, executed in order */
+    TaskHandle_t task;                  /*!< Worker task */
+    SemaphoreHandle_t stopped;          /*!< Given by the worker when it exits */
+};
+
+static void async_task(void *arg)
+{
+    struct bme69x_i2c_async_bus *bus = (struct bme69x_i2c_async_bus *)arg;
+    async_item_t item;
+    esp_err_t result;
+
+    for (;;) {
+        if (xQueueReceive(bus->queue, &item, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        if (item.intf == NULL) {
+            break;
+        }
+
+        if (item.op == BME69X_I2C_ASYNC_READ) {
+            result = bme69x_i2c_read_bytes(item.intf, item.reg_addr, item.data, item.len);
+        } else {
+            result = bme69x_i2c_write_bytes(item.intf, item.reg_addr, item.data, item.len);
+        }
+
+        if (item.cb) {
+            item.cb(result, item.cb_arg);
+        }
+        if (item.future) {
+            item.future->result = result;
+            xSemaphoreGive(item.future->sem);
+        }
+    }
+
+    xSemaphoreGive(bus->stopped);
+    vTaskDelete(NULL);
+}
+
+static esp_err_t async_queue(struct bme69x_i2c_async_bus *bus, const async_item_t *item, TickType_t timeout)
+{
+    ESP_RETURN_ON_FALSE(xQueueSend(bus->queue, item, timeout) == pdTRUE, ESP_ERR_TIMEOUT, TAG, "request queue full");
+
+    return ESP_OK;
+}
+
+static void async_bus_free(struct bme69x_i2c_async_bus *bus)
+{
+    if (bus->queue) {
+        vQueueDelete(bus->queue);
+    }
+    if (bus->stopped) {
+        vSemaphoreDelete(bus->stopped);
+    }
+    free(bus);
+}
+
+esp_err_t bme69x_i2c_async_bus_create(const bme69x_i2c_async_config_t *config, bme69x_i2c_async_bus_handle_t *bus_ret)
+{
+    esp_err_t ret = ESP_OK;
+
+    ESP_RETURN_ON_FALSE(config && bus_ret && (config->queue_len > 0), ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    struct bme69x_i2c_async_bus *bus = (struct bme69x_i2c_async_bus *)calloc(1, sizeof(struct bme69x_i2c_async_bus));
+    ESP_RETURN_ON_FALSE(bus, ESP_ERR_NO_MEM, TAG, "memory allocation for worker failed");
+
+    bus->queue = xQueueCreate(config->queue_len, sizeof(async_item_t));
+    ESP_GOTO_ON_FALSE(bus->queue, ESP_ERR_NO_MEM, err, TAG, "queue creation failed");
+    bus->stopped = xSemaphoreCreateBinary();
+    ESP_GOTO_ON_FALSE(bus->stopped, ESP_ERR_NO_MEM, err, TAG, "semaphore creation failed");
+    ESP_GOTO_ON_FALSE(xTaskCreatePinnedToCore(async_task, "bme69x_i2c", config->task_stack_size, bus,
+                                              config->task_priority, &bus->task, config->task_core_id) == pdPASS,
+                      ESP_ERR_NO_MEM, err, TAG, "worker task creation failed");
+
+    *bus_ret = bus;
+    return ret;
+
+    err:
+    async_bus_free(bus);
+    return ret;
+}
+
+esp_err_t bme69x_i2c_async_bus_delete(bme69x_i2c_async_bus_handle_t bus)
+{
+    const async_item_t stop = { 0 };
+
+    ESP_RETURN_ON_FALSE(bus, ESP_ERR_INVALID_ARG, TAG, "invalid worker handle");
+
+    /* Queued behind the pending requests, which complete first */
+    (void)xQueueSend(bus->queue, &stop, portMAX_DELAY);
+    (void)xSemaphoreTake(bus->stopped, portMAX_DELAY);
+    async_bus_free(bus);
+
+    return ESP_OK;
+}
+
+esp_err_t bme69x_i2c_async_submit(bme69x_i2c_async_bus_handle_t bus, const bme69x_i2c_async_req_t *req,
+                                  TickType_t timeout)
+{
+    ESP_RETURN_ON_FALSE(bus && req && req->sensor && req->sensor->intf_ptr && req->data && (req->len > 0),
+                        ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    const async_item_t item = {
+        .op = req->op,
+        .intf = (bme69x_intf_t *)req->sensor->intf_ptr,
+        .reg_addr = req->reg_addr,
+        .data = req->data,
+        .len = req->len,
+        .cb = req->cb,
+        .cb_arg = req->cb_arg,
+        .future = req->future,
+    };
+    ESP_RETURN_ON_FALSE(item.intf->i2c_dev, ESP_ERR_INVALID_ARG, TAG, "sensor has no I2C device");
+
+    return async_queue(bus, &item, timeout);
+}
+
+void bme69x_i2c_async_future_init(bme69x_i2c_async_future_t *future)
+{
+    future->sem = xSemaphoreCreateBinaryStatic(&future->sem_buf);
+    future->result = ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t bme69x_i2c_async_future_wait(bme69x_i2c_async_future_t *future, TickType_t timeout)
+{
+    if (xSemaphoreTake(future->sem, timeout) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+
+    return future->result;
+}
+
+void bme69x_i2c_async_future_deinit(bme69x_i2c_async_future_t *future)
+{
+    vSemaphoreDelete(future->sem);
+    future->sem = NULL;
+}
+
+esp_err_t bme69x_i2c_async_attach(bme69x_handle_t handle, bme69x_i2c_async_bus_handle_t bus)
+{
+    ESP_RETURN_ON_FALSE(handle && handle->intf_ptr && bus && (handle->intf == BME69X_I2C_INTF),
+                        ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    ((bme69x_intf_t *)handle->intf_ptr)->async_bus = bus;
+    handle->read = bme69x_i2c_async_read;
+    handle->write = bme69x_i2c_async_write;
+
+    return ESP_OK;
+}
+
+esp_err_t bme69x_i2c_async_detach(bme69x_handle_t handle)
+{
+    ESP_RETURN_ON_FALSE(handle && handle->intf_ptr, ESP_ERR_INVALID_ARG, TAG, "invalid device handle pointer");
+
+    handle->read = bme69x_i2c_read;
+    handle->write = bme69x_i2c_write;
+    ((bme69x_intf_t *)handle->intf_ptr)->async_bus = NULL;
+
+    return ESP_OK;
+}
+
+/*!
+ * Queues one transfer of a sensor and blocks until the worker has done it
+ */
+static BME69X_INTF_RET_TYPE async_transfer(bme69x_i2c_async_op_t op, uint8_t reg_addr, uint8_t *reg_data,
+                                           uint32_t len, void *intf_ptr)
+{
+    bme69x_intf_t *intf_info = (bme69x_intf_t *)intf_ptr;
+    bme69x_i2c_async_future_t future;
+    esp_err_t ret;
+
+    bme69x_i2c_async_future_init(&future);
+
+    const async_item_t item = {
+        .op = op,
+        .intf = intf_info,
+        .reg_addr = reg_addr,
+        .data = reg_data,
+        .len = len,
+        .future = &future,
+    };
+    ret = async_queue(intf_info->async_bus, &item, portMAX_DELAY);
+    if (ret == ESP_OK) {
+        ret = bme69x_i2c_async_future_wait(&future, portMAX_DELAY);
+    }
+    bme69x_i2c_async_future_deinit(&future);
+
+    return (ret == ESP_OK) ? BME69X_INTF_RET_SUCCESS : BME69X_E_COM_FAIL;
+}
+
+BME69X_INTF_RET_TYPE bme69x_i2c_async_read(uint8_t reg_addr, uint8_t *reg_data, uint32_t len, void *intf_ptr)
+{
+    return async_transfer(BME69X_I2C_ASYNC_READ, reg_addr, reg_data, len, intf_ptr);
+}
+
+BME69X_INTF_RET_TYPE bme69x_i2c_async_write(uint8_t reg_addr, const uint8_t *reg_data, uint32_t len, void *intf_ptr)
+{
+    /* The worker only reads from the source of a write */
+    return async_transfer(BME69X_I2C_ASYNC_WRITE, reg_addr, (uint8_t *)reg_data, len, intf_ptr);
+}
@@ -0,0 +1,189 @@
+#ifndef BME69X_I2C_ASYNC_H
+#define BME69X_I2C_ASYNC_H
+
+#include "bme69x_i2c_esp_idf.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /*__cplusplus */
+
+/**
+ * @brief Handle of an asynchronous bus worker
+ */
+typedef struct bme69x_i2c_async_bus *bme69x_i2c_async_bus_handle_t;
+
+/**
+ * @brief Completion callback, called from the worker task
+ *
+ * @param[in] result ESP_OK or the error returned by the I2C transfer
+ * @param[in] arg    cb_arg of the request
+ */
+typedef void (*bme69x_i2c_async_cb_t)(esp_err_t result, void *arg);
+
+/**
+ * @brief Completion object a task can block on
+ *
+ * Initialize with bme69x_i2c_async_future_init and release with bme69x_i2c_async_future_deinit.
+ * Needs no heap and may live on the stack of the waiting task.
+ */
+typedef struct {
+    StaticSemaphore_t sem_buf;  /*!< Storage of sem */
+    SemaphoreHandle_t sem;      /*!< Given by the worker when the transfer is done */
+    esp_err_t result;           /*!< Result of the transfer, valid once sem is given */
+} bme69x_i2c_async_future_t;
+
+/**
+ * @brief Transfer direction of a request
+ */
+typedef enum {
+    BME69X_I2C_ASYNC_READ,      /*!< Burst read of len registers starting at reg_addr */
+    BME69X_I2C_ASYNC_WRITE,     /*!< Write of reg_addr followed by len bytes of data */
+} bme69x_i2c_async_op_t;
+
+/**
+ * @brief Transfer request
+ *
+ * data must stay valid until the request completes. Either or both of cb and future
+ * may be set.
+ */
+typedef struct {
+    bme69x_i2c_async_op_t op;           /*!< Transfer direction */
+    bme69x_handle_t sensor;             /*!< Sensor addressed, created on the worker's bus */
+    uint8_t reg_addr;                   /*!< First register */
+    uint8_t *data;                      /*!< Read destination or write source */
+    uint32_t len;                       /*!< Number of data bytes */
+    bme69x_i2c_async_cb_t cb;           /*!< Optional completion callback */
+    void *cb_arg;                       /*!< Argument of cb */
+    bme69x_i2c_async_future_t *future;  /*!< Optional future completed after cb */
+} bme69x_i2c_async_req_t;
+
+/**
+ * @brief Bus worker configuration
+ */
+typedef struct {
+    uint32_t queue_len;         /*!< Requests that can be pending */
+    uint32_t task_stack_size;   /*!< Stack size of the worker task in bytes */
+    UBaseType_t task_priority;  /*!< Priority of the worker task */
+    BaseType_t task_core_id;    /*!< Core the worker task is pinned to, or tskNO_AFFINITY */
+} bme69x_i2c_async_config_t;
+
+/**
+ * @brief Default worker configuration
+ */
+#define BME69X_I2C_ASYNC_DEFAULT_CONFIG() \
+    {                                     \
+        .queue_len = 16,                  \
+        .task_stack_size = 3072,          \
+        .task_priority = 10,              \
+        .task_core_id = tskNO_AFFINITY,   \
+    }
+
+/**
+ * @brief Create a worker task executing the transfers of one I2C bus in submission order
+ *
+ * @param[in] config Worker configuration
+ * @param[out] bus_ret Pointer to a variable that will hold the worker handle
+ * @return
+ *      - ESP_OK: Worker running
+ *      - ESP_ERR_INVALID_ARG: Invalid arguments were provided
+ *      - ESP_ERR_NO_MEM: Queue or task allocation failed
+ */
+esp_err_t bme69x_i2c_async_bus_create(const bme69x_i2c_async_config_t *config, bme69x_i2c_async_bus_handle_t *bus_ret);
+
+/**
+ * @brief Complete the pending requests, stop the worker and release it
+ *
+ * Sensors still attached to the worker must be detached first.
+ *
+ * @param[in] bus Worker handle
+ * @return
+ *      - ESP_OK: Worker deleted
+ *      - ESP_ERR_INVALID_ARG: Invalid worker handle
+ */
+esp_err_t bme69x_i2c_async_bus_delete(bme69x_i2c_async_bus_handle_t bus);
+
+/**
+ * @brief Queue a transfer and return without waiting for it
+ *
+ * @param[in] bus Worker handle
+ * @param[in] req Request, copied into the queue
+ * @param[in] timeout Ticks to wait for a free queue slot
+ * @return
+ *      - ESP_OK: Request queued
+ *      - ESP_ERR_INVALID_ARG: Invalid arguments were provided
+ *      - ESP_ERR_TIMEOUT: The queue stayed full
+ */
+esp_err_t bme69x_i2c_async_submit(bme69x_i2c_async_bus_handle_t bus, const bme69x_i2c_async_req_t *req,
+                                  TickType_t timeout);
+
+/**
+ * @brief Prepare a future for a request
+ *
+ * @param[out] future Future to initialize
+ */
+void bme69x_i2c_async_future_init(bme69x_i2c_async_future_t *future);
+
+/**
+ * @brief Block until the request of a future is done
+ *
+ * @param[in] future Future passed with the request
+ * @param[in] timeout Ticks to wait
+ * @return
+ *      - Result of the transfer when it completed
+ *      - ESP_ERR_TIMEOUT: The transfer did not complete in time
+ */
+esp_err_t bme69x_i2c_async_future_wait(bme69x_i2c_async_future_t *future, TickType_t timeout);
+
+/**
+ * @brief Release the semaphore of a future
+ *
+ * Call once the request of the future is done, or when it was never submitted. The worker
+ * still gives the semaphore of a request in flight, so not after a timed out wait.
+ *
+ * @param[in] future Future to release
+ */
+void bme69x_i2c_async_future_deinit(bme69x_i2c_async_future_t *future);
+
+/**
+ * @brief Route the bus accesses of a sensor through a worker
+ *
+ * Replaces the read and write callbacks of the device with adapters that queue the
+ * transfer and block the calling task, without spinning, until the worker has done it.
+ * Driver calls on several sensors of one bus can then run in their own tasks while
+ * the worker keeps the bus busy.
+ *
+ * @param[in] handle Handle of the BME69X sensor object
+ * @param[in] bus Worker of the bus the sensor was created on
+ * @return
+ *      - ESP_OK: Sensor attached
+ *      - ESP_ERR_INVALID_ARG: Invalid arguments were provided
+ */
+esp_err_t bme69x_i2c_async_attach(bme69x_handle_t handle, bme69x_i2c_async_bus_handle_t bus);
+
+/**
+ * @brief Restore the direct bus callbacks of a sensor
+ *
+ * @param[in] handle Handle of the BME69X sensor object
+ * @return
+ *      - ESP_OK: Sensor detached
+ *      - ESP_ERR_INVALID_ARG: Invalid handle
+ */
+esp_err_t bme69x_i2c_async_detach(bme69x_handle_t handle);
+
+/**
+ * @brief Read adapter queuing the transfer on the worker of the sensor, for bme69x_dev.read
+ */
+BME69X_INTF_RET_TYPE bme69x_i2c_async_read(uint8_t reg_addr, uint8_t *reg_data, uint32_t len, void *intf_ptr);
+
+/**
+ * @brief Write adapter queuing the transfer on the worker of the sensor, for bme69x_dev.write
+ */
+BME69X_INTF_RET_TYPE bme69x_i2c_async_write(uint8_t reg_addr, const uint8_t *reg_data, uint32_t len, void *intf_ptr);
+
+#ifdef __cplusplus
+}
+#endif /*__cplusplus */
+
+#endif // BME69X_I2C_ASYNC_H
@@ -1,26 +1,163 @@
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <inttypes.h>
 #include "bme69x_i2c_esp_idf.h"
 
 const static char *TAG = "bme69x";
 
-esp_err_t bme69x_sensor_create(const bme69x_i2c_config_t *i2c_conf, bme69x_handle_t *handle_ret)
+/* The device structure is the first member so the handle can be cast back to the enclosing object on delete */
+_Static_assert(offsetof(struct bme69x_sensor, dev) == 0, "dev must be the first member of struct bme69x_sensor");
+
+/**
+ * @brief Link the recursive mutex and the newest sample storage of a sensor, with CONFIG_BME69X_LOCK
+ */
+static void sensor_init_lock(struct bme69x_sensor *sensor)
+{
+#if CONFIG_BME69X_LOCK
+    sensor->intf.lock = xSemaphoreCreateRecursiveMutexStatic(&sensor->lock_buf);
+    sensor->dev.lock = bme69x_lock;
+    sensor->dev.unlock = bme69x_unlock;
+    sensor->dev.latest = &sensor->latest;
+#else
+    (void)sensor;
+#endif
+}
+
+#if CONFIG_BME69X_STATS
+static const char *const stats_api_name[BME69X_STATS_N_API] = {
+    [BME69X_STATS_API_NONE] = "-",
+    [BME69X_STATS_API_REGS] = "get/set_regs",
+    [BME69X_STATS_API_INIT] = "init",
+    [BME69X_STATS_API_SOFT_RESET] = "soft_reset",
+    [BME69X_STATS_API_SET_CONF] = "set_conf",
+    [BME69X_STATS_API_GET_CONF] = "get_conf",
+    [BME69X_STATS_API_SET_OP_MODE] = "set_op_mode",
+    [BME69X_STATS_API_GET_OP_MODE] = "get_op_mode",
+    [BME69X_STATS_API_GET_DATA] = "get_data",
+    [BME69X_STATS_API_SET_HEATR_CONF] = "set_heatr_conf",
+    [BME69X_STATS_API_GET_HEATR_CONF] = "get_heatr_conf",
+    [BME69X_STATS_API_TRIGGER_FORCED] = "trigger_forced",
+    [BME69X_STATS_API_TRY_COLLECT] = "try_collect",
+    [BME69X_STATS_API_SELFTEST] = "selftest",
+    [BME69X_STATS_API_IMPORT_CALIB] = "import_calib",
+    [BME69X_STATS_API_RESUME] = "resume",
+};
+#endif
+
+/**
+ * @brief Create a sensor object on I2C, initialized with bme69x_init or resumed from state when not NULL
+ *
+ * The object is allocated, or placed in storage when not NULL.
+ */
+static esp_err_t sensor_create_i2c(const bme69x_i2c_config_t *i2c_conf, const uint8_t *state,
+                                   struct bme69x_sensor *storage, bme69x_handle_t *handle_ret)
 {
     esp_err_t ret = ESP_OK;
     int8_t rslt;
+    struct bme69x_sensor *sensor = storage;
+
+    ESP_RETURN_ON_FALSE(i2c_conf && handle_ret, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
 
-    struct bme69x_dev *bme = (struct bme69x_dev *)calloc(1, sizeof(struct bme69x_dev));
-    ESP_RETURN_ON_FALSE(bme, ESP_ERR_NO_MEM, TAG, "memory allocation for device handler failed");
+    if (sensor) {
+        memset(sensor, 0, sizeof(struct bme69x_sensor));
+        sensor->in_place = true;
+        sensor->intf.no_heap = true;
+    } else {
+        sensor = (struct bme69x_sensor *)calloc(1, sizeof(struct bme69x_sensor));
+        ESP_RETURN_ON_FALSE(sensor, ESP_ERR_NO_MEM, TAG, "memory allocation for device handler failed");
+    }
+    struct bme69x_dev *bme = &sensor->dev;
 
-    rslt = bme69x_interface_init(bme, BME69X_I2C_INTF, i2c_conf->i2c_addr, i2c_conf->i2c_handle);
+    if (i2c_conf->i2c_dev) {
+        sensor->intf.i2c_dev = i2c_conf->i2c_dev;
+        sensor->intf.i2c_dev_borrowed = true;
+    }
+
+    rslt = bme69x_interface_init(bme, &sensor->intf, BME69X_I2C_INTF, i2c_conf->i2c_addr, i2c_conf->i2c_handle,
+                                 i2c_conf->scl_speed_hz);
     bme69x_check_rslt("bme69x_sensor_create", rslt);
-    ESP_LOGI(TAG, "bme69x_check_rslt done");
 
     ESP_GOTO_ON_FALSE((BME69X_OK == rslt), ESP_ERR_INVALID_STATE, err, TAG, "bme69x_interface_init failed");
 
+#if CONFIG_BME69X_STATS
+    bme->stats = &sensor->stats;
+#endif
+#if CONFIG_BME69X_HEATR_LUT
+    bme->heatr_lut = &sensor->heatr_lut;
+#endif
+    sensor_init_lock(sensor);
+
+    if (state) {
+        rslt = bme69x_resume(state, bme);
+        ESP_GOTO_ON_FALSE((rslt == BME69X_OK), ESP_ERR_INVALID_STATE, err, TAG, "bme69x_resume failed (%d)", rslt);
+    } else {
+        // Initialize BME69X
+        rslt = bme69x_init(bme);
+        ESP_GOTO_ON_FALSE((rslt == BME69X_OK), ESP_ERR_INVALID_STATE, err, TAG, "bme69x_init failed");
+    }
+
+    ESP_LOGI(TAG, " %s %-15s 0x%02x", state ? "Resume" : "Create", "BME69X", i2c_conf->i2c_addr);
+
+    *handle_ret = bme;
+    return ret;
+
+    err:
+    bme69x_sensor_del(bme);
+    return ret;
+}
+
+esp_err_t bme69x_sensor_create(const bme69x_i2c_config_t *i2c_conf, bme69x_handle_t *handle_ret)
+{
+    return sensor_create_i2c(i2c_conf, NULL, NULL, handle_ret);
+}
+
+esp_err_t bme69x_sensor_create_static(const bme69x_i2c_config_t *i2c_conf, bme69x_sensor_storage_t *storage,
+                                      bme69x_handle_t *handle_ret)
+{
+    ESP_RETURN_ON_FALSE(storage, ESP_ERR_INVALID_ARG, TAG, "invalid storage pointer");
+
+    return sensor_create_i2c(i2c_conf, NULL, storage, handle_ret);
+}
+
+esp_err_t bme69x_sensor_resume(const bme69x_i2c_config_t *i2c_conf, const uint8_t *state,
+                               bme69x_handle_t *handle_ret)
+{
+    ESP_RETURN_ON_FALSE(state, ESP_ERR_INVALID_ARG, TAG, "invalid state pointer");
+
+    return sensor_create_i2c(i2c_conf, state, NULL, handle_ret);
+}
+
+esp_err_t bme69x_sensor_create_spi(const bme69x_spi_config_t *spi_conf, bme69x_handle_t *handle_ret)
+{
+    esp_err_t ret = ESP_OK;
+    int8_t rslt;
+
+    ESP_RETURN_ON_FALSE(spi_conf && handle_ret, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    struct bme69x_sensor *sensor = (struct bme69x_sensor *)calloc(1, sizeof(struct bme69x_sensor));
+    ESP_RETURN_ON_FALSE(sensor, ESP_ERR_NO_MEM, TAG, "memory allocation for device handler failed");
+    struct bme69x_dev *bme = &sensor->dev;
+
+    rslt = bme69x_interface_init_spi(bme, &sensor->intf, spi_conf->spi_host, spi_conf->cs_io_num,
+                                     spi_conf->clock_speed_hz);
+    bme69x_check_rslt("bme69x_sensor_create_spi", rslt);
+
+    ESP_GOTO_ON_FALSE((BME69X_OK == rslt), ESP_ERR_INVALID_STATE, err, TAG, "bme69x_interface_init_spi failed");
+
+#if CONFIG_BME69X_STATS
+    bme->stats = &sensor->stats;
+#endif
+#if CONFIG_BME69X_HEATR_LUT
+    bme->heatr_lut = &sensor->heatr_lut;
+#endif
+    sensor_init_lock(sensor);
+
     // Initialize BME69X
     rslt = bme69x_init(bme);
     ESP_GOTO_ON_FALSE((rslt == BME69X_OK), ESP_ERR_INVALID_STATE, err, TAG, "bme69x_init failed");
 
-    ESP_LOGI(TAG, " Create %-15s", "BME69X");
+    ESP_LOGI(TAG, " Create %-15s CS %d", "BME69X", spi_conf->cs_io_num);
 
     *handle_ret = bme;
     return ret;
@@ -31,9 +168,48 @@ esp_err_t bme69x_sensor_create(const bme69x_i2c_config_t *i2c_conf, bme69x_handl
 }
 
 esp_err_t bme69x_sensor_del(bme69x_handle_t handle)
+{
+    esp_err_t ret;
+
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "invalid device handle pointer");
+    struct bme69x_sensor *sensor = (struct bme69x_sensor *)handle;
+
+    ret = bme69x_interface_deinit(&sensor->dev);
+#if CONFIG_BME69X_LOCK
+    if (sensor->intf.lock) {
+        vSemaphoreDelete(sensor->intf.lock);
+    }
+#endif
+    if (!sensor->in_place) {
+        free(sensor);
+    }
+
+    return ret;
+}
+
+esp_err_t bme69x_sensor_log_stats(bme69x_handle_t handle)
 {
     ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "invalid device handle pointer");
-    free(handle);
+
+#if CONFIG_BME69X_STATS
+    struct bme69x_stats stats;
+    int8_t rslt = bme69x_get_stats(&stats, handle);
+    ESP_RETURN_ON_FALSE((rslt == BME69X_OK), ESP_ERR_INVALID_STATE, TAG, "bme69x_get_stats failed");
+
+    ESP_LOGI(TAG, "%-15s %8s %8s %8s %10s %10s %6s %12s %12s", "api", "calls", "reads", "writes",
+             "rd bytes", "wr bytes", "errors", "bus us", "sleep us");
+    for (uint8_t i = 0; i < BME69X_STATS_N_API; i++) {
+        const struct bme69x_stats_entry *e = &stats.api[i];
+        if ((e->calls == 0) && (e->reads == 0) && (e->writes == 0)) {
+            continue;
+        }
+        ESP_LOGI(TAG, "%-15s %8" PRIu32 " %8" PRIu32 " %8" PRIu32 " %10" PRIu32 " %10" PRIu32 " %6" PRIu32 " %12" PRIu64 " %12" PRIu64,
+                 stats_api_name[i], e->calls, e->reads, e->writes, e->bytes_read, e->bytes_written, e->errors,
+                 e->bus_time_us, e->sleep_time_us);
+    }
 
     return ESP_OK;
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
 }
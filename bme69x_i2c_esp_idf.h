@@ -18,10 +18,56 @@
  * the BME69X device.
  */
 typedef struct {
-    i2c_bus_handle_t i2c_handle;    /*!< I2C handle/context used to connect to the BME69X device */
+    bme69x_i2c_bus_handle_t i2c_handle;    /*!< I2C handle/context used to connect to the BME69X device */
     uint8_t i2c_addr;    /*!< I2C address of the BME69X device */
+    uint32_t scl_speed_hz;    /*!< SCL frequency of the BME69X device, 0 for the bus clock (i2c_bus) or CONFIG_BME69X_I2C_SCL_SPEED_HZ (i2c_master) */
+    bme69x_i2c_dev_handle_t i2c_dev;    /*!< Bus device created and deleted by the caller, NULL to create one on i2c_handle */
 } bme69x_i2c_config_t;
 
+/**
+ * @brief BME69X SPI configuration structure
+ *
+ * The bus must have been initialized with spi_bus_initialize. Each sensor is added to it
+ * as a device with its own chip select.
+ */
+typedef struct {
+    spi_host_device_t spi_host;    /*!< SPI bus the BME69X device is connected to */
+    int cs_io_num;    /*!< Chip select GPIO of the BME69X device */
+    uint32_t clock_speed_hz;    /*!< SCK frequency, 0 for CONFIG_BME69X_SPI_CLOCK_HZ */
+} bme69x_spi_config_t;
+
+/**
+ * @brief Sensor object backing a bme69x_handle_t
+ *
+ * The members are private to the component. The structure is public so that sensors can be
+ * created in place, in storage of BME69X_SENSOR_STORAGE_SIZE bytes, see bme69x_sensor_create_static.
+ */
+struct bme69x_sensor {
+    struct bme69x_dev dev;      /*!< Bosch driver device structure, exposed as the handle */
+    bme69x_intf_t intf;         /*!< Interface context linked through dev.intf_ptr */
+#if CONFIG_BME69X_STATS
+    struct bme69x_stats stats;  /*!< Bus transaction statistics linked through dev.stats */
+#endif
+#if CONFIG_BME69X_HEATR_LUT
+    struct bme69x_heatr_lut heatr_lut;  /*!< Heater resistance codes linked through dev.heatr_lut */
+#endif
+#if CONFIG_BME69X_LOCK
+    StaticSemaphore_t lock_buf; /*!< Storage of the recursive mutex linked through intf.lock */
+    struct bme69x_latest latest;    /*!< Newest sample linked through dev.latest */
+#endif
+    bool in_place;              /*!< Created in caller storage, not freed on delete */
+};
+
+/**
+ * @brief Storage of a sensor created in place
+ */
+typedef struct bme69x_sensor bme69x_sensor_storage_t;
+
+/**
+ * @brief Size of the storage of a sensor created in place, for the current configuration
+ */
+#define BME69X_SENSOR_STORAGE_SIZE  sizeof(bme69x_sensor_storage_t)
+
 /**
  * @brief Handle type for BME69X sensor
  *
@@ -34,7 +80,8 @@ typedef struct bme69x_dev *bme69x_handle_t;
  * @brief Create and initialize a BME69X sensor object
  *
  * This function initializes the BME69X sensor and prepares it for use.
- * It configures the I2C interface and creates a handle for further communication.
+ * It creates a dedicated I2C bus device for this sensor and a handle for further
+ * communication. Any number of sensors can be created on one or more buses.
  *
  * @param[in] i2c_conf Pointer to the I2C configuration structure
  * @param[out] handle_ret Pointer to a variable that will hold the created sensor handle
@@ -45,11 +92,71 @@ typedef struct bme69x_dev *bme69x_handle_t;
  */
 esp_err_t bme69x_sensor_create(const bme69x_i2c_config_t *i2c_conf, bme69x_handle_t *handle_ret);
 
+/**
+ * @brief Create and initialize a BME69X sensor object in caller storage
+ *
+ * Same as bme69x_sensor_create, without allocating the sensor object. With i2c_conf->i2c_dev
+ * set to a bus device of the caller, and no esp_timer for the delays, neither create nor delete
+ * allocate memory. The storage must stay valid until bme69x_sensor_del, which leaves it to the caller.
+ *
+ * Timer based delays, BME69X_DELAY_TIMER and the long waits of BME69X_DELAY_HYBRID, sleep whole
+ * ticks and busy wait the rest instead. Each such wait occupies the CPU for up to one tick period,
+ * 1 ms at CONFIG_FREERTOS_HZ 1000, 10 ms at 100. Use BME69X_DELAY_TICK where that matters more
+ * than the accuracy of the wait.
+ *
+ * @param[in] i2c_conf Pointer to the I2C configuration structure
+ * @param[in] storage Storage of the sensor object, for example a static bme69x_sensor_storage_t
+ * @param[out] handle_ret Pointer to a variable that will hold the created sensor handle
+ * @return
+ *      - ESP_OK: Successfully created the sensor object
+ *      - ESP_ERR_INVALID_ARG: Invalid arguments were provided
+ *      - ESP_ERR_INVALID_STATE: Failed to initialize the sensor
+ */
+esp_err_t bme69x_sensor_create_static(const bme69x_i2c_config_t *i2c_conf, bme69x_sensor_storage_t *storage,
+                                      bme69x_handle_t *handle_ret);
+
+/**
+ * @brief Create a BME69X sensor object from a saved state, without resetting the sensor
+ *
+ * Fast wake path for hosts waking from deep sleep while the sensor stayed powered. The
+ * state is a snapshot saved with bme69x_export_state, typically kept in RTC memory. The
+ * only bus access is a chip ID read. The sensor keeps its configuration and heater
+ * profile, so bme69x_set_op_mode(BME69X_FORCED_MODE) can follow right away.
+ *
+ * @param[in] i2c_conf Pointer to the I2C configuration structure
+ * @param[in] state BME69X_LEN_STATE_BLOB bytes of state
+ * @param[out] handle_ret Pointer to a variable that will hold the created sensor handle
+ * @return
+ *      - ESP_OK: Successfully resumed the sensor object
+ *      - ESP_ERR_INVALID_ARG: Invalid arguments were provided
+ *      - ESP_ERR_INVALID_STATE: Invalid state or no sensor answering, use bme69x_sensor_create
+ */
+esp_err_t bme69x_sensor_resume(const bme69x_i2c_config_t *i2c_conf, const uint8_t *state,
+                               bme69x_handle_t *handle_ret);
+
+/**
+ * @brief Create and initialize a BME69X sensor object on SPI
+ *
+ * Same as bme69x_sensor_create for a sensor wired to an SPI bus. The driver switches the
+ * SPI memory page only when consecutive accesses are on different pages.
+ *
+ * @param[in] spi_conf Pointer to the SPI configuration structure
+ * @param[out] handle_ret Pointer to a variable that will hold the created sensor handle
+ * @return
+ *      - ESP_OK: Successfully created the sensor object
+ *      - ESP_ERR_INVALID_ARG: Invalid arguments were provided
+ *      - ESP_ERR_INVALID_STATE: Failed to initialize the sensor
+ */
+esp_err_t bme69x_sensor_create_spi(const bme69x_spi_config_t *spi_conf, bme69x_handle_t *handle_ret);
+
 /**
  * @brief Delete and release a BME69X sensor object
  *
- * This function releases the resources allocated for the BME69X sensor.
- * It should be called when the sensor is no longer needed.
+ * This function releases the resources allocated for the BME69X sensor,
+ * including the I2C bus device created for it by bme69x_sensor_create.
+ * It should be called when the sensor is no longer needed. A bus device
+ * passed in bme69x_i2c_config_t.i2c_dev and the storage of a sensor created
+ * with bme69x_sensor_create_static are left to the caller.
  *
  * @param[in] handle Handle of the BME69X sensor object
  * @return
@@ -59,4 +166,19 @@ esp_err_t bme69x_sensor_create(const bme69x_i2c_config_t *i2c_conf, bme69x_handl
  */
 esp_err_t bme69x_sensor_del(bme69x_handle_t handle);
 
+/**
+ * @brief Log the bus transaction statistics of a BME69X sensor
+ *
+ * Prints one line per driver API that issued bus traffic since creation or the
+ * last bme69x_reset_stats: calls, register reads and writes, bytes, errors,
+ * time spent on the bus and time spent in the delay callback.
+ *
+ * @param[in] handle Handle of the BME69X sensor object
+ * @return
+ *      - ESP_OK: Statistics logged
+ *      - ESP_ERR_INVALID_ARG: Invalid handle was provided
+ *      - ESP_ERR_NOT_SUPPORTED: CONFIG_BME69X_STATS is disabled
+ */
+esp_err_t bme69x_sensor_log_stats(bme69x_handle_t handle);
+
 #endif // BME69X_I2C_ESPIDF_H
\ No newline at end of file
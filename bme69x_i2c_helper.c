@@ -7,24 +7,77 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
+#include "sdkconfig.h"
 #include "bme69x_i2c_helper.h"
+#include "bme69x_spi_trans.h"
 #include "esp_log.h"
-
+#include "esp_rom_sys.h"
 
 /******************************************************************************/
-static i2c_bus_device_handle_t intf_conf;
+/*!                 Macro definitions                                         */
+/*! Length of one FreeRTOS tick in microseconds */
+#define BME69X_TICK_PERIOD_US  ((uint32_t)(1000 * portTICK_PERIOD_MS))
+
+#if defined(CONFIG_BME69X_DELAY_MODE_TICK)
+#define BME69X_DELAY_MODE_DEFAULT  BME69X_DELAY_TICK
+#elif defined(CONFIG_BME69X_DELAY_MODE_TIMER)
+#define BME69X_DELAY_MODE_DEFAULT  BME69X_DELAY_TIMER
+#elif defined(CONFIG_BME69X_DELAY_MODE_SPIN)
+#define BME69X_DELAY_MODE_DEFAULT  BME69X_DELAY_SPIN
+#else
+#define BME69X_DELAY_MODE_DEFAULT  BME69X_DELAY_HYBRID
+#endif
+
+#if CONFIG_BME69X_I2C_BACKEND_I2C_MASTER
+/*! Longest write: register address, then address and data pairs of the whole control block */
+#define BME69X_I2C_WRITE_BUFF_LEN  (1 + BME69X_LEN_INTERLEAVE_BUFF)
+#endif
 
 /******************************************************************************/
 /*!                User interface functions                                   */
 
+esp_err_t bme69x_i2c_read_bytes(bme69x_intf_t *intf_info, uint8_t reg_addr, uint8_t *reg_data, uint32_t len)
+{
+#if CONFIG_BME69X_I2C_BACKEND_I2C_MASTER
+    return i2c_master_transmit_receive(intf_info->i2c_dev, &reg_addr, 1, reg_data, len, CONFIG_BME69X_I2C_TIMEOUT_MS);
+#else
+    return i2c_bus_read_bytes(intf_info->i2c_dev, reg_addr, (uint16_t)len, reg_data);
+#endif
+}
+
+esp_err_t bme69x_i2c_write_bytes(bme69x_intf_t *intf_info, uint8_t reg_addr, const uint8_t *reg_data, uint32_t len)
+{
+#if CONFIG_BME69X_I2C_BACKEND_I2C_MASTER
+    /* One contiguous transmit, the address phase is sent only once */
+    uint8_t buf[BME69X_I2C_WRITE_BUFF_LEN];
+
+    if (len >= sizeof(buf))
+    {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    buf[0] = reg_addr;
+    memcpy(&buf[1], reg_data, len);
+
+    return i2c_master_transmit(intf_info->i2c_dev, buf, len + 1, CONFIG_BME69X_I2C_TIMEOUT_MS);
+#else
+    return i2c_bus_write_bytes(intf_info->i2c_dev, reg_addr, len, reg_data);
+#endif
+}
+
 /*!
  * I2C read function map to COINES platform
  */
 BME69X_INTF_RET_TYPE bme69x_i2c_read(uint8_t reg_addr, uint8_t *reg_data, uint32_t len, void *intf_ptr)
 {
-    i2c_bus_device_handle_t intf_info = (i2c_bus_device_handle_t)intf_ptr;
-    return i2c_bus_read_bytes(intf_info, reg_addr, (uint16_t)len, reg_data);
+    if (bme69x_i2c_read_bytes((bme69x_intf_t *)intf_ptr, reg_addr, reg_data, len) != ESP_OK)
+    {
+        return BME69X_E_COM_FAIL;
+    }
+
+    return BME69X_INTF_RET_SUCCESS;
 }
 
 /*!
@@ -32,8 +85,12 @@ BME69X_INTF_RET_TYPE bme69x_i2c_read(uint8_t reg_addr, uint8_t *reg_data, uint32
  */
 BME69X_INTF_RET_TYPE bme69x_i2c_write(uint8_t reg_addr, const uint8_t *reg_data, uint32_t len, void *intf_ptr)
 {
-    i2c_bus_device_handle_t intf_info = (i2c_bus_device_handle_t)intf_ptr;
-    return i2c_bus_write_bytes(intf_info, reg_addr, len, reg_data);
+    if (bme69x_i2c_write_bytes((bme69x_intf_t *)intf_ptr, reg_addr, reg_data, len) != ESP_OK)
+    {
+        return BME69X_E_COM_FAIL;
+    }
+
+    return BME69X_INTF_RET_SUCCESS;
 }
 
 /*!
@@ -41,7 +98,23 @@ BME69X_INTF_RET_TYPE bme69x_i2c_write(uint8_t reg_addr, const uint8_t *reg_data,
  */
 BME69X_INTF_RET_TYPE bme69x_spi_read(uint8_t reg_addr, uint8_t *reg_data, uint32_t len, void *intf_ptr)
 {
-    return 0; // TODO
+    bme69x_intf_t *intf_info = (bme69x_intf_t *)intf_ptr;
+    spi_transaction_t trans;
+
+    bme69x_spi_read_trans(&trans, reg_addr, reg_data, len);
+
+    /* Polling: the transfers are a few bytes long, cheaper than an interrupt and a context switch */
+    if (spi_device_polling_transmit(intf_info->spi_dev, &trans) != ESP_OK)
+    {
+        return BME69X_E_COM_FAIL;
+    }
+
+    if (trans.flags & SPI_TRANS_USE_RXDATA)
+    {
+        memcpy(reg_data, trans.rx_data, len);
+    }
+
+    return BME69X_INTF_RET_SUCCESS;
 }
 
 /*!
@@ -49,15 +122,219 @@ BME69X_INTF_RET_TYPE bme69x_spi_read(uint8_t reg_addr, uint8_t *reg_data, uint32
  */
 BME69X_INTF_RET_TYPE bme69x_spi_write(uint8_t reg_addr, const uint8_t *reg_data, uint32_t len, void *intf_ptr)
 {
-    return 0; // TODO
+    bme69x_intf_t *intf_info = (bme69x_intf_t *)intf_ptr;
+    spi_transaction_t trans;
+
+    bme69x_spi_write_trans(&trans, reg_addr, reg_data, len);
+
+    if (spi_device_polling_transmit(intf_info->spi_dev, &trans) != ESP_OK)
+    {
+        return BME69X_E_COM_FAIL;
+    }
+
+    return BME69X_INTF_RET_SUCCESS;
+}
+
+/*!
+ * One-shot timer callback, wakes the task waiting in delay_timer_wait
+ */
+static void delay_timer_cb(void *arg)
+{
+    bme69x_intf_t *intf_info = (bme69x_intf_t *)arg;
+
+    (void)xSemaphoreGive(intf_info->delay_sem);
 }
 
 /*!
- * Delay function map to COINES platform
+ * Blocks the calling task until the deadline using the one-shot timer of the sensor
+ */
+static void delay_timer_wait(bme69x_intf_t *intf_info, uint32_t period, int64_t deadline)
+{
+    int64_t remaining;
+
+    if (intf_info->delay_timer == NULL)
+    {
+        const esp_timer_create_args_t timer_args = {
+            .callback = delay_timer_cb,
+            .arg = intf_info,
+            .dispatch_method = ESP_TIMER_TASK,
+            .name = "bme69x_delay",
+        };
+
+        if (esp_timer_create(&timer_args, &intf_info->delay_timer) != ESP_OK)
+        {
+            /* Fall back to a busy wait rather than returning early */
+            esp_rom_delay_us(period);
+
+            return;
+        }
+
+        /* The task notification slot belongs to the application, the timer gives a semaphore of the sensor */
+        intf_info->delay_sem = xSemaphoreCreateBinaryStatic(&intf_info->delay_sem_buf);
+    }
+
+    if (esp_timer_start_once(intf_info->delay_timer, period) != ESP_OK)
+    {
+        esp_rom_delay_us(period);
+
+        return;
+    }
+
+    /*
+     * A callback of an earlier wait that was queued when its timer was stopped gives the semaphore
+     * late and ends the take early, keep waiting until the deadline
+     */
+    do
+    {
+        (void)xSemaphoreTake(intf_info->delay_sem, portMAX_DELAY);
+        remaining = deadline - esp_timer_get_time();
+    } while (remaining >= (int64_t)BME69X_TICK_PERIOD_US);
+
+    if (remaining > 0)
+    {
+        (void)esp_timer_stop(intf_info->delay_timer);
+        esp_rom_delay_us((uint32_t)remaining);
+
+        /* Drop the give of a callback that ran before the stop */
+        (void)xSemaphoreTake(intf_info->delay_sem, 0);
+    }
+}
+
+/*!
+ * Sleeps the whole ticks before the deadline and busy waits the rest, less than a tick, without an esp_timer
+ */
+static void delay_tick_spin(int64_t deadline)
+{
+    int64_t remaining = deadline - esp_timer_get_time();
+
+    /*
+     * vTaskDelay(n) returns between n - 1 and n tick periods later, depending on where in the tick
+     * period it is called. One tick first puts the task on a tick boundary, from which the whole
+     * ticks left are slept exactly.
+     */
+    if (remaining >= BME69X_TICK_PERIOD_US)
+    {
+        vTaskDelay(1);
+        remaining = deadline - esp_timer_get_time();
+        if (remaining >= BME69X_TICK_PERIOD_US)
+        {
+            vTaskDelay((TickType_t)(remaining / BME69X_TICK_PERIOD_US));
+        }
+
+        remaining = deadline - esp_timer_get_time();
+    }
+
+    if (remaining > 0)
+    {
+        esp_rom_delay_us((uint32_t)remaining);
+    }
+}
+
+/*!
+ * Delay function map to the strategy selected for the sensor
  */
 void bme69x_delay_us(uint32_t period, void *intf_ptr)
 {
-    vTaskDelay(period / 1000 / portTICK_PERIOD_MS);
+    bme69x_intf_t *intf_info = (bme69x_intf_t *)intf_ptr;
+    bme69x_delay_mode_t mode = intf_info->delay_mode;
+    int64_t start = esp_timer_get_time();
+    int64_t deadline = start + period;
+    int64_t overshoot;
+
+    if (mode == BME69X_DELAY_HYBRID)
+    {
+        mode = (period < BME69X_TICK_PERIOD_US) ? BME69X_DELAY_SPIN : BME69X_DELAY_TIMER;
+    }
+
+    switch (mode)
+    {
+        case BME69X_DELAY_SPIN:
+            esp_rom_delay_us(period);
+            break;
+        case BME69X_DELAY_TIMER:
+            if (intf_info->no_heap)
+            {
+                delay_tick_spin(deadline);
+            }
+            else
+            {
+                delay_timer_wait(intf_info, period, deadline);
+            }
+
+            break;
+        case BME69X_DELAY_TICK:
+        default:
+            vTaskDelay((TickType_t)((period + BME69X_TICK_PERIOD_US - 1) / BME69X_TICK_PERIOD_US));
+            break;
+    }
+
+    overshoot = esp_timer_get_time() - deadline;
+    if (overshoot < 0)
+    {
+        overshoot = 0;
+    }
+
+    intf_info->delay_stats.count++;
+    intf_info->delay_stats.last_overshoot_us = (uint32_t)overshoot;
+    intf_info->delay_stats.total_overshoot_us += (uint64_t)overshoot;
+    if ((uint32_t)overshoot > intf_info->delay_stats.max_overshoot_us)
+    {
+        intf_info->delay_stats.max_overshoot_us = (uint32_t)overshoot;
+    }
+}
+
+/*!
+ * Time function map to esp_timer
+ */
+uint64_t bme69x_get_time_us(void *intf_ptr)
+{
+    (void)intf_ptr;
+
+    return (uint64_t)esp_timer_get_time();
+}
+
+/*!
+ * Lock function map to the recursive mutex of the sensor
+ */
+void bme69x_lock(void *intf_ptr)
+{
+    (void)xSemaphoreTakeRecursive(((bme69x_intf_t *)intf_ptr)->lock, portMAX_DELAY);
+}
+
+/*!
+ * Unlock function map to the recursive mutex of the sensor
+ */
+void bme69x_unlock(void *intf_ptr)
+{
+    (void)xSemaphoreGiveRecursive(((bme69x_intf_t *)intf_ptr)->lock);
+}
+
+esp_err_t bme69x_delay_set_mode(struct bme69x_dev *bme, bme69x_delay_mode_t mode)
+{
+    ESP_RETURN_ON_FALSE(bme && bme->intf_ptr, ESP_ERR_INVALID_ARG, "BME69X", "invalid device pointer");
+    ESP_RETURN_ON_FALSE(mode <= BME69X_DELAY_HYBRID, ESP_ERR_INVALID_ARG, "BME69X", "invalid delay mode");
+
+    ((bme69x_intf_t *)bme->intf_ptr)->delay_mode = mode;
+
+    return ESP_OK;
+}
+
+esp_err_t bme69x_delay_get_stats(const struct bme69x_dev *bme, bme69x_delay_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(bme && bme->intf_ptr && stats, ESP_ERR_INVALID_ARG, "BME69X", "invalid argument");
+
+    *stats = ((const bme69x_intf_t *)bme->intf_ptr)->delay_stats;
+
+    return ESP_OK;
+}
+
+esp_err_t bme69x_delay_reset_stats(struct bme69x_dev *bme)
+{
+    ESP_RETURN_ON_FALSE(bme && bme->intf_ptr, ESP_ERR_INVALID_ARG, "BME69X", "invalid device pointer");
+
+    memset(&((bme69x_intf_t *)bme->intf_ptr)->delay_stats, 0, sizeof(bme69x_delay_stats_t));
+
+    return ESP_OK;
 }
 
 void bme69x_check_rslt(const char api_name[], int8_t rslt)
@@ -83,6 +360,9 @@ void bme69x_check_rslt(const char api_name[], int8_t rslt)
         case BME69X_E_SELF_TEST:
             printf("API name [%s]  Error [%d] : Self test error\r\n", api_name, rslt);
             break;
+        case BME69X_E_CALIB_BLOB:
+            printf("API name [%s]  Error [%d] : Invalid calibration snapshot\r\n", api_name, rslt);
+            break;
         case BME69X_W_NO_NEW_DATA:
             printf("API name [%s]  Warning [%d] : No new data found\r\n", api_name, rslt);
             break;
@@ -95,6 +375,7 @@ void bme69x_check_rslt(const char api_name[], int8_t rslt)
 /**
  * @brief Function to select the interface between SPI and I2C for BME69X.
  * @param[in] bme      : Structure instance of bme69x_dev
+ * @param[in] intf_ctx : Interface context owned by this sensor
  * @param[in] intf     : Interface selection parameter (BME69X_I2C_INTF or BME69X_SPI_INTF)
  * @param[in] dev_addr : Device address (I2C address or SPI CS pin)
  * @param[in] bus_inst : I2C bus handle (for I2C)
@@ -102,33 +383,67 @@ void bme69x_check_rslt(const char api_name[], int8_t rslt)
  * @retval 0 -> Success
  * @retval < 0 -> Failure Info
  */
-int8_t bme69x_interface_init(struct bme69x_dev *bme, uint8_t intf, uint8_t dev_addr, i2c_bus_handle_t bus_inst)
+int8_t bme69x_interface_init(struct bme69x_dev *bme,
+                             bme69x_intf_t *intf_ctx,
+                             uint8_t intf,
+                             uint8_t dev_addr,
+                             bme69x_i2c_bus_handle_t bus_inst,
+                             uint32_t scl_speed_hz)
 {
     int8_t rslt = BME69X_OK;
 
-    if (bme != NULL)
+    if ((bme != NULL) && (intf_ctx != NULL))
     {
+        bme->intf_ptr = (void *)intf_ctx;
+
         if (intf == BME69X_I2C_INTF)
         {
             bme->intf = BME69X_I2C_INTF;
             bme->read = bme69x_i2c_read;
             bme->write = bme69x_i2c_write;
 
-            i2c_bus_device_handle_t i2c_device_handle = i2c_bus_device_create(bus_inst, dev_addr, 0);
-            if (NULL == i2c_device_handle)
+            if (intf_ctx->i2c_dev_borrowed)
             {
-                ESP_LOGE("BME69X", "i2c_bus_device_create failed");
-                rslt = BME69X_E_NULL_PTR;
+                if (intf_ctx->i2c_dev == NULL)
+                {
+                    ESP_LOGE("BME69X", "no I2C device to borrow");
+                    rslt = BME69X_E_NULL_PTR;
+                }
+            }
+            else
+            {
+#if CONFIG_BME69X_I2C_BACKEND_I2C_MASTER
+                const i2c_device_config_t dev_conf = {
+                    .dev_addr_length = I2C_ADDR_BIT_LEN_7,
+                    .device_address = dev_addr,
+                    .scl_speed_hz = scl_speed_hz ? scl_speed_hz : CONFIG_BME69X_I2C_SCL_SPEED_HZ,
+                };
+
+                if (i2c_master_bus_add_device(bus_inst, &dev_conf, &intf_ctx->i2c_dev) != ESP_OK)
+                {
+                    ESP_LOGE("BME69X", "i2c_master_bus_add_device failed");
+                    intf_ctx->i2c_dev = NULL;
+                    rslt = BME69X_E_NULL_PTR;
+                }
+#else
+
+                /* 0 keeps the clock the bus was created with */
+                i2c_bus_device_handle_t i2c_device_handle = i2c_bus_device_create(bus_inst, dev_addr, scl_speed_hz);
+                if (NULL == i2c_device_handle)
+                {
+                    ESP_LOGE("BME69X", "i2c_bus_device_create failed");
+                    rslt = BME69X_E_NULL_PTR;
+                }
+                intf_ctx->i2c_dev = i2c_device_handle;
+#endif
             }
-            intf_conf = i2c_device_handle;
-            bme->intf_ptr = (void *)intf_conf;
         }
         else if (intf == BME69X_SPI_INTF)
         {
             bme->intf = BME69X_SPI_INTF;
             bme->read = bme69x_spi_read;
             bme->write = bme69x_spi_write;
-            ESP_LOGE("BME69X", "SPI Interface not supported yet");
+            ESP_LOGE("BME69X", "SPI sensors are set up with bme69x_interface_init_spi");
             rslt = BME69X_E_COM_FAIL;
         }
         else
@@ -138,7 +453,9 @@ int8_t bme69x_interface_init(struct bme69x_dev *bme, uint8_t intf, uint8_t dev_a
         }
 
         bme->delay_us = bme69x_delay_us;
+        bme->get_time_us = bme69x_get_time_us;
         bme->amb_temp = 25;
+        intf_ctx->delay_mode = BME69X_DELAY_MODE_DEFAULT;
     }
     else
     {
@@ -148,8 +465,85 @@ int8_t bme69x_interface_init(struct bme69x_dev *bme, uint8_t intf, uint8_t dev_a
     return rslt;
 }
 
-esp_err_t bme69x_i2c_deinit(void)
+int8_t bme69x_interface_init_spi(struct bme69x_dev *bme,
+                                 bme69x_intf_t *intf_ctx,
+                                 spi_host_device_t spi_host,
+                                 int cs_io_num,
+                                 uint32_t clock_speed_hz)
 {
-    ESP_LOGI("BME69X", "bme69x_i2c_deinit");
-    return i2c_bus_device_delete(&intf_conf);
+    int8_t rslt = BME69X_OK;
+
+    if ((bme != NULL) && (intf_ctx != NULL))
+    {
+        const spi_device_interface_config_t dev_conf = {
+            .address_bits = 8,
+            .mode = 0,
+            .clock_speed_hz = clock_speed_hz ? (int)clock_speed_hz : CONFIG_BME69X_SPI_CLOCK_HZ,
+            .spics_io_num = cs_io_num,
+            .queue_size = 1,
+        };
+
+        bme->intf_ptr = (void *)intf_ctx;
+        bme->intf = BME69X_SPI_INTF;
+        bme->read = bme69x_spi_read;
+        bme->write = bme69x_spi_write;
+        bme->delay_us = bme69x_delay_us;
+        bme->get_time_us = bme69x_get_time_us;
+        bme->amb_temp = 25;
+        intf_ctx->delay_mode = BME69X_DELAY_MODE_DEFAULT;
+
+        if (spi_bus_add_device(spi_host, &dev_conf, &intf_ctx->spi_dev) != ESP_OK)
+        {
+            ESP_LOGE("BME69X", "spi_bus_add_device failed");
+            intf_ctx->spi_dev = NULL;
+            rslt = BME69X_E_NULL_PTR;
+        }
+    }
+    else
+    {
+        rslt = BME69X_E_NULL_PTR;
+    }
+
+    return rslt;
+}
+
+esp_err_t bme69x_interface_deinit(struct bme69x_dev *bme)
+{
+    esp_err_t ret = ESP_OK;
+    bme69x_intf_t *intf_ctx;
+
+    ESP_RETURN_ON_FALSE(bme, ESP_ERR_INVALID_ARG, "BME69X", "invalid device pointer");
+    intf_ctx = (bme69x_intf_t *)bme->intf_ptr;
+
+    if ((intf_ctx != NULL) && (intf_ctx->delay_timer != NULL))
+    {
+        (void)esp_timer_stop(intf_ctx->delay_timer);
+        (void)esp_timer_delete(intf_ctx->delay_timer);
+        intf_ctx->delay_timer = NULL;
+        vSemaphoreDelete(intf_ctx->delay_sem);
+        intf_ctx->delay_sem = NULL;
+    }
+
+    if ((intf_ctx != NULL) && intf_ctx->i2c_dev_borrowed)
+    {
+        /* The caller deletes its bus device */
+        intf_ctx->i2c_dev = NULL;
+    }
+    else if ((intf_ctx != NULL) && (intf_ctx->i2c_dev != NULL))
+    {
+#if CONFIG_BME69X_I2C_BACKEND_I2C_MASTER
+        ret = i2c_master_bus_rm_device(intf_ctx->i2c_dev);
+        intf_ctx->i2c_dev = NULL;
+#else
+        ret = i2c_bus_device_delete(&intf_ctx->i2c_dev);
+#endif
+    }
+
+    if ((intf_ctx != NULL) && (intf_ctx->spi_dev != NULL))
+    {
+        ret = spi_bus_remove_device(intf_ctx->spi_dev);
+        intf_ctx->spi_dev = NULL;
+    }
+
+    return ret;
 }
@@ -1,26 +1,126 @@
 #ifndef BME69X_I2C_HELPER_H
 #define BME69X_I2C_HELPER_H
+#include <stdbool.h>
 #include "bme69x.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 #include "esp_log.h"
 #include "esp_check.h"
 
+#include "esp_timer.h"
+
+#include "sdkconfig.h"
+#include "driver/spi_master.h"
+#if CONFIG_BME69X_I2C_BACKEND_I2C_MASTER
+#include "driver/i2c_master.h"
+#else
 #include "i2c_bus.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif /*__cplusplus */
+
+#if CONFIG_BME69X_I2C_BACKEND_I2C_MASTER
+typedef i2c_master_bus_handle_t bme69x_i2c_bus_handle_t;     /*!< Bus the sensors are created on */
+typedef i2c_master_dev_handle_t bme69x_i2c_dev_handle_t;     /*!< Bus device of one sensor */
+#else
+typedef i2c_bus_handle_t bme69x_i2c_bus_handle_t;            /*!< Bus the sensors are created on */
+typedef i2c_bus_device_handle_t bme69x_i2c_dev_handle_t;     /*!< Bus device of one sensor */
+#endif
+
+/*!
+ * @brief Strategies available to bme69x_delay_us
+ */
+typedef enum {
+    BME69X_DELAY_TICK,      /*!< vTaskDelay, rounded up to whole ticks */
+    BME69X_DELAY_TIMER,     /*!< esp_timer one-shot waking the task through a semaphore of the sensor */
+    BME69X_DELAY_SPIN,      /*!< esp_rom_delay_us busy wait */
+    BME69X_DELAY_HYBRID,    /*!< Busy wait below one tick period, esp_timer one-shot above */
+} bme69x_delay_mode_t;
+
+/*!
+ * @brief Accuracy statistics of the delays requested by the driver
+ */
+typedef struct {
+    uint32_t count;                 /*!< Number of delays performed */
+    uint32_t last_overshoot_us;     /*!< Time waited beyond the request by the last delay */
+    uint32_t max_overshoot_us;      /*!< Largest overshoot seen */
+    uint64_t total_overshoot_us;    /*!< Sum of all overshoots, divide by count for the mean */
+} bme69x_delay_stats_t;
+
+/*!
+ * @brief Per-device interface context
+ *
+ * One instance exists per sensor and is linked through bme69x_dev.intf_ptr, so
+ * several sensors on one or more buses never share interface state.
+ */
+typedef struct {
+    bme69x_i2c_dev_handle_t i2c_dev;    /*!< I2C bus device owned by this sensor */
+    spi_device_handle_t spi_dev;        /*!< SPI device owned by this sensor */
+    bme69x_delay_mode_t delay_mode;     /*!< Strategy used by bme69x_delay_us */
+    esp_timer_handle_t delay_timer;     /*!< One-shot timer, created on first timer based delay */
+    SemaphoreHandle_t delay_sem;        /*!< Given by delay_timer only, created with it */
+    StaticSemaphore_t delay_sem_buf;    /*!< Storage of delay_sem */
+    bme69x_delay_stats_t delay_stats;   /*!< Delay accuracy statistics */
+    bool i2c_dev_borrowed;              /*!< i2c_dev belongs to the caller, it is neither created nor deleted */
+    bool no_heap;                       /*!< Timer based delays sleep ticks and busy wait instead of an esp_timer */
+    struct bme69x_i2c_async_bus *async_bus; /*!< Worker the bus accesses go through, see bme69x_i2c_async_attach */
+    SemaphoreHandle_t lock;             /*!< Recursive mutex of bme69x_lock, NULL when the sensor is not shared */
+} bme69x_intf_t;
 
 /*!
  *  @brief Function to init the interface with I2C.
  *
+ *  With intf_ctx->i2c_dev_borrowed set, intf_ctx->i2c_dev is used as it is and no bus device is
+ *  created on bus_inst.
+ *
  *  @param[in] bme      : Structure instance of bme69x_dev
+ *  @param[in] intf_ctx : Interface context owned by this sensor, linked as bme->intf_ptr
  *  @param[in] intf     : Interface selection parameter
  *  @param[in] dev_addr : Device address (I2C address or SPI CS pin)
  *  @param[in] bus_inst : I2C bus handle (for I2C)
+ *  @param[in] scl_speed_hz : SCL frequency of the sensor, 0 for the default of the backend
+ *
+ *  @return Status of execution
+ *  @retval 0 -> Success
+ *  @retval < 0 -> Failure Info
+ */
+int8_t bme69x_interface_init(struct bme69x_dev *bme,
+                             bme69x_intf_t *intf_ctx,
+                             uint8_t intf,
+                             uint8_t dev_addr,
+                             bme69x_i2c_bus_handle_t bus_inst,
+                             uint32_t scl_speed_hz);
+
+/*!
+ *  @brief Function to init the interface with SPI.
+ *
+ *  @param[in] bme            : Structure instance of bme69x_dev
+ *  @param[in] intf_ctx       : Interface context owned by this sensor, linked as bme->intf_ptr
+ *  @param[in] spi_host       : SPI bus, initialized with spi_bus_initialize
+ *  @param[in] cs_io_num      : Chip select GPIO of the sensor
+ *  @param[in] clock_speed_hz : SCK frequency, 0 for CONFIG_BME69X_SPI_CLOCK_HZ
  *
  *  @return Status of execution
  *  @retval 0 -> Success
  *  @retval < 0 -> Failure Info
  */
-int8_t bme69x_interface_init(struct bme69x_dev *bme, uint8_t intf, uint8_t dev_addr, i2c_bus_handle_t bus_inst);
+int8_t bme69x_interface_init_spi(struct bme69x_dev *bme,
+                                 bme69x_intf_t *intf_ctx,
+                                 spi_host_device_t spi_host,
+                                 int cs_io_num,
+                                 uint32_t clock_speed_hz);
+
+/*!
+ *  @brief Releases the bus device created by bme69x_interface_init, a borrowed one is kept.
+ *
+ *  @param[in] bme      : Structure instance of bme69x_dev
+ *
+ *  @return esp_err_t.
+ */
+esp_err_t bme69x_interface_deinit(struct bme69x_dev *bme);
 
 /*!
  *  @brief Function for reading the sensor's registers through I2C bus.
@@ -52,6 +152,30 @@ BME69X_INTF_RET_TYPE bme69x_i2c_read(uint8_t reg_addr, uint8_t *reg_data, uint32
  */
 BME69X_INTF_RET_TYPE bme69x_i2c_write(uint8_t reg_addr, const uint8_t *reg_data, uint32_t len, void *intf_ptr);
 
+/*!
+ *  @brief Burst read of a sensor through the configured I2C backend.
+ *
+ *  @param[in] intf_info    : Interface context of the sensor
+ *  @param[in] reg_addr     : First register address.
+ *  @param[out] reg_data    : Pointer to the data buffer to store the read data.
+ *  @param[in] len          : No of bytes to read.
+ *
+ *  @return esp_err_t.
+ */
+esp_err_t bme69x_i2c_read_bytes(bme69x_intf_t *intf_info, uint8_t reg_addr, uint8_t *reg_data, uint32_t len);
+
+/*!
+ *  @brief Write of a register address followed by data through the configured I2C backend.
+ *
+ *  @param[in] intf_info    : Interface context of the sensor
+ *  @param[in] reg_addr     : Register address.
+ *  @param[in] reg_data     : Pointer to the data buffer whose value is to be written.
+ *  @param[in] len          : No of bytes to write.
+ *
+ *  @return esp_err_t.
+ */
+esp_err_t bme69x_i2c_write_bytes(bme69x_intf_t *intf_info, uint8_t reg_addr, const uint8_t *reg_data, uint32_t len);
+
 /*!
  *  @brief Function for reading the sensor's registers through SPI bus.
  *
@@ -95,21 +219,70 @@ BME69X_INTF_RET_TYPE bme69x_spi_write(uint8_t reg_addr, const uint8_t *reg_data,
 void bme69x_delay_us(uint32_t period, void *intf_ptr);
 
 /*!
- *  @brief Prints the execution status of the APIs.
+ * @brief This function returns the esp_timer time, used to timestamp measurements.
  *
- *  @param[in] api_name : Name of the API whose execution status has to be printed.
- *  @param[in] rslt     : Error code returned by the API whose execution status has to be printed.
+ *  @param[in] intf_ptr     : Interface pointer
+ *
+ *  @return Time since boot in microseconds.
+ */
+uint64_t bme69x_get_time_us(void *intf_ptr);
+
+/*!
+ * @brief This function takes the recursive mutex of a sensor, see bme69x_dev.lock.
+ *
+ *  @param[in] intf_ptr     : Interface pointer
  *
  *  @return void.
  */
-void bme69x_check_rslt(const char api_name[], int8_t rslt);
+void bme69x_lock(void *intf_ptr);
+
+/*!
+ * @brief This function gives the recursive mutex of a sensor back, see bme69x_dev.unlock.
+ *
+ *  @param[in] intf_ptr     : Interface pointer
+ *
+ *  @return void.
+ */
+void bme69x_unlock(void *intf_ptr);
+
+/*!
+ *  @brief Selects the strategy used by bme69x_delay_us for a sensor.
+ *
+ *  @param[in] bme      : Structure instance of bme69x_dev
+ *  @param[in] mode     : Delay strategy
+ *
+ *  @return esp_err_t.
+ */
+esp_err_t bme69x_delay_set_mode(struct bme69x_dev *bme, bme69x_delay_mode_t mode);
 
 /*!
- *  @brief Deinitializes coines platform
+ *  @brief Copies the delay accuracy statistics of a sensor.
+ *
+ *  @param[in] bme      : Structure instance of bme69x_dev
+ *  @param[out] stats   : Statistics since creation or the last reset
  *
  *  @return esp_err_t.
  */
-esp_err_t bme69x_i2c_deinit(void);
+esp_err_t bme69x_delay_get_stats(const struct bme69x_dev *bme, bme69x_delay_stats_t *stats);
+
+/*!
+ *  @brief Clears the delay accuracy statistics of a sensor.
+ *
+ *  @param[in] bme      : Structure instance of bme69x_dev
+ *
+ *  @return esp_err_t.
+ */
+esp_err_t bme69x_delay_reset_stats(struct bme69x_dev *bme);
+
+/*!
+ *  @brief Prints the execution status of the APIs.
+ *
+ *  @param[in] api_name : Name of the API whose execution status has to be printed.
+ *  @param[in] rslt     : Error code returned by the API whose execution status has to be printed.
+ *
+ *  @return void.
+ */
+void bme69x_check_rslt(const char api_name[], int8_t rslt);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,67 @@
+#ifndef BME69X_SPI_TRANS_H
+#define BME69X_SPI_TRANS_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include "driver/spi_master.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /*__cplusplus */
+
+/*!
+ * @brief Set up the transaction of a register read
+ *
+ * The address phase carries the register with its read bit, the driver has selected the page.
+ * The device is full duplex: length is the data phase and rxlength equals it, spi_master
+ * rejects a receive phase longer than length. Short reads use the inline rx_data.
+ *
+ * @param[out] trans    : Transaction to set up
+ * @param[in]  reg_addr : Register address with the read bit
+ * @param[in]  reg_data : Destination of a read longer than rx_data
+ * @param[in]  len      : Number of bytes to read
+ */
+static inline void bme69x_spi_read_trans(spi_transaction_t *trans, uint8_t reg_addr, uint8_t *reg_data, uint32_t len)
+{
+    memset(trans, 0, sizeof(*trans));
+    trans->addr = reg_addr;
+    trans->length = len * 8;
+    trans->rxlength = len * 8;
+
+    if (len <= sizeof(trans->rx_data))
+    {
+        trans->flags = SPI_TRANS_USE_RXDATA;
+    }
+    else
+    {
+        trans->rx_buffer = reg_data;
+    }
+}
+
+/*!
+ * @brief Set up the transaction of a register write
+ *
+ * The first register goes in the address phase, the following address and data pairs as data.
+ *
+ * @param[out] trans    : Transaction to set up
+ * @param[in]  reg_addr : First register address
+ * @param[in]  reg_data : Data, then the remaining address and data pairs
+ * @param[in]  len      : Number of bytes in reg_data
+ */
+static inline void bme69x_spi_write_trans(spi_transaction_t *trans,
+                                          uint8_t reg_addr,
+                                          const uint8_t *reg_data,
+                                          uint32_t len)
+{
+    memset(trans, 0, sizeof(*trans));
+    trans->addr = reg_addr;
+    trans->length = len * 8;
+    trans->tx_buffer = reg_data;
+}
+
+#ifdef __cplusplus
+}
+#endif /*__cplusplus */
+
+#endif /* BME69X_SPI_TRANS_H */
@@ -0,0 +1,219 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <inttypes.h>
+#include "bme69x_stream.h"
+#include "bme69x_stream_index.h"
+
+const static char *TAG = "bme69x_stream";
+
+/**
+ * @brief Parallel mode stream
+ *
+ * The ring indices run freely and are masked on access. head is only written by the
+ * reader task and tail only by the consumer, so plain atomic 32-bit loads and stores are
+ * enough and the ring stays lock-free on targets without atomic read-modify-write
+ * instructions. The counters follow the same single-writer rule.
+ */
+struct bme69x_stream {
+    struct bme69x_dev *dev;             /*!< Sensor drained by the reader task */
+    bme69x_stream_sample_t *ring;       /*!< capacity samples */
+    uint32_t mask;                      /*!< capacity - 1 */
+    _Atomic uint32_t head;              /*!< Next slot written by the reader task */
+    _Atomic uint32_t tail;              /*!< Next slot read by the consumer */
+    _Atomic uint32_t samples;           /*!< See bme69x_stream_stats_t */
+    _Atomic uint32_t lost;
+    _Atomic uint32_t dropped;
+    _Atomic uint32_t errors;
+    TickType_t poll_ticks;              /*!< Polling period of the reader task */
+    TaskHandle_t task;                  /*!< Reader task */
+    atomic_bool stop;                   /*!< Set by bme69x_stream_delete */
+    atomic_bool exited;                 /*!< Set by the reader task, which no longer touches the stream */
+    bool started;                       /*!< A field has been seen, seq is valid */
+    uint8_t last_index;                 /*!< meas_index of the last field pushed */
+    uint32_t seq;                       /*!< Sequence number of the last field pushed */
+};
+
+static inline void stream_count(_Atomic uint32_t *counter, uint32_t n)
+{
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + n, memory_order_relaxed);
+}
+
+static void stream_push(struct bme69x_stream *stream, const struct bme69x_data *data, int64_t now_us)
+{
+    uint8_t delta = 1;
+
+    if (stream->started) {
+        /* A field returned again by a later poll is behind or at the last one pushed */
+        delta = bme69x_stream_index_delta(stream->last_index, data->meas_index);
+        if (delta == 0) {
+            return;
+        }
+        stream_count(&stream->lost, delta - 1U);
+    }
+    stream->started = true;
+    stream->last_index = data->meas_index;
+    stream->seq += delta;
+
+    uint32_t head = atomic_load_explicit(&stream->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&stream->tail, memory_order_acquire);
+    if (head - tail > stream->mask) {
+        stream_count(&stream->dropped, 1);
+        return;
+    }
+
+    bme69x_stream_sample_t *sample = &stream->ring[head & stream->mask];
+    sample->data = *data;
+    sample->seq = stream->seq;
+    sample->timestamp_us = now_us;
+    atomic_store_explicit(&stream->head, head + 1, memory_order_release);
+    stream_count(&stream->samples, 1);
+}
+
+static void stream_task(void *arg)
+{
+    struct bme69x_stream *stream = (struct bme69x_stream *)arg;
+    struct bme69x_data data[3];
+    TickType_t wake = xTaskGetTickCount();
+    uint8_t n_fields;
+    int8_t rslt;
+
+    while (!atomic_load(&stream->stop)) {
+        n_fields = 0;
+        rslt = bme69x_get_data(BME69X_PARALLEL_MODE, data, &n_fields, stream->dev);
+        if (rslt < BME69X_OK) {
+            stream_count(&stream->errors, 1);
+        } else {
+            /* New fields come first, in measurement order */
+            int64_t now_us = esp_timer_get_time();
+            for (uint8_t i = 0; i < n_fields; i++) {
+                stream_push(stream, &data[i], now_us);
+            }
+        }
+
+        vTaskDelayUntil(&wake, stream->poll_ticks);
+    }
+
+    atomic_store(&stream->exited, true);
+    vTaskDelete(NULL);
+}
+
+static void stream_free(struct bme69x_stream *stream)
+{
+    free(stream->ring);
+    free(stream);
+}
+
+esp_err_t bme69x_stream_create(bme69x_handle_t handle, const bme69x_stream_config_t *config,
+                               bme69x_stream_handle_t *stream_ret)
+{
+    esp_err_t ret = ESP_OK;
+    struct bme69x_conf conf;
+    uint32_t period_us;
+    int8_t rslt;
+
+    ESP_RETURN_ON_FALSE(handle && config && stream_ret, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE((config->capacity >= 4) && ((config->capacity & (config->capacity - 1)) == 0),
+                        ESP_ERR_INVALID_ARG, TAG, "capacity must be a power of two of at least 4");
+
+    struct bme69x_stream *stream = (struct bme69x_stream *)calloc(1, sizeof(struct bme69x_stream));
+    ESP_RETURN_ON_FALSE(stream, ESP_ERR_NO_MEM, TAG, "memory allocation for stream failed");
+    stream->ring = (bme69x_stream_sample_t *)calloc(config->capacity, sizeof(bme69x_stream_sample_t));
+    ESP_GOTO_ON_FALSE(stream->ring, ESP_ERR_NO_MEM, err, TAG, "memory allocation for %" PRIu32 " samples failed",
+                      config->capacity);
+    stream->dev = handle;
+    stream->mask = config->capacity - 1;
+
+    period_us = config->poll_period_us;
+    if (period_us == 0) {
+        rslt = bme69x_get_conf(&conf, handle);
+        ESP_GOTO_ON_FALSE((rslt == BME69X_OK), ESP_ERR_INVALID_STATE, err, TAG, "bme69x_get_conf failed");
+        period_us = bme69x_get_meas_dur(BME69X_PARALLEL_MODE, &conf, handle);
+    }
+    stream->poll_ticks = (TickType_t)((period_us + portTICK_PERIOD_MS * 1000 - 1) / (portTICK_PERIOD_MS * 1000));
+    if (stream->poll_ticks == 0) {
+        stream->poll_ticks = 1;
+    }
+
+    rslt = bme69x_set_op_mode(BME69X_PARALLEL_MODE, handle);
+    bme69x_check_rslt("bme69x_set_op_mode", rslt);
+    ESP_GOTO_ON_FALSE((rslt == BME69X_OK), ESP_ERR_INVALID_STATE, err, TAG, "bme69x_set_op_mode failed");
+
+    if (xTaskCreatePinnedToCore(stream_task, "bme69x_stream", config->task_stack_size, stream,
+                                config->task_priority, &stream->task, config->task_core_id) != pdPASS) {
+        (void)bme69x_set_op_mode(BME69X_SLEEP_MODE, handle);
+        ESP_GOTO_ON_FALSE(false, ESP_ERR_NO_MEM, err, TAG, "reader task creation failed");
+    }
+
+    ESP_LOGI(TAG, "Streaming, polling every %" PRIu32 " ticks into %" PRIu32 " samples",
+             (uint32_t)stream->poll_ticks, config->capacity);
+
+    *stream_ret = stream;
+    return ret;
+
+    err:
+    stream_free(stream);
+    return ret;
+}
+
+esp_err_t bme69x_stream_delete(bme69x_stream_handle_t stream)
+{
+    ESP_RETURN_ON_FALSE(stream, ESP_ERR_INVALID_ARG, TAG, "invalid stream handle");
+
+    /* Polled rather than notified: a late notification would stay pending for the caller's next wait,
+     * and a call after a timeout still sees the task exit */
+    atomic_store(&stream->stop, true);
+    for (TickType_t waited = 0; !atomic_load(&stream->exited); waited++) {
+        ESP_RETURN_ON_FALSE(waited < 2 * stream->poll_ticks + pdMS_TO_TICKS(100),
+                            ESP_ERR_TIMEOUT, TAG, "reader task did not stop");
+        vTaskDelay(1);
+    }
+
+    (void)bme69x_set_op_mode(BME69X_SLEEP_MODE, stream->dev);
+    stream_free(stream);
+
+    return ESP_OK;
+}
+
+size_t bme69x_stream_read(bme69x_stream_handle_t stream, bme69x_stream_sample_t *samples, size_t max_samples)
+{
+    if (!stream || !samples) {
+        return 0;
+    }
+
+    uint32_t tail = atomic_load_explicit(&stream->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&stream->head, memory_order_acquire);
+    size_t n = head - tail;
+    if (n > max_samples) {
+        n = max_samples;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        samples[i] = stream->ring[(tail + i) & stream->mask];
+    }
+    atomic_store_explicit(&stream->tail, tail + (uint32_t)n, memory_order_release);
+
+    return n;
+}
+
+size_t bme69x_stream_available(bme69x_stream_handle_t stream)
+{
+    if (!stream) {
+        return 0;
+    }
+
+    return atomic_load_explicit(&stream->head, memory_order_acquire) -
+           atomic_load_explicit(&stream->tail, memory_order_relaxed);
+}
+
+esp_err_t bme69x_stream_get_stats(bme69x_stream_handle_t stream, bme69x_stream_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(stream && stats, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    stats->samples = atomic_load_explicit(&stream->samples, memory_order_relaxed);
+    stats->lost = atomic_load_explicit(&stream->lost, memory_order_relaxed);
+    stats->dropped = atomic_load_explicit(&stream->dropped, memory_order_relaxed);
+    stats->errors = atomic_load_explicit(&stream->errors, memory_order_relaxed);
+
+    return ESP_OK;
+}
@@ -0,0 +1,127 @@
+#ifndef BME69X_STREAM_H
+#define BME69X_STREAM_H
+
+#include "bme69x_i2c_esp_idf.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /*__cplusplus */
+
+/**
+ * @brief Handle of a parallel mode stream
+ */
+typedef struct bme69x_stream *bme69x_stream_handle_t;
+
+/**
+ * @brief Compensated sample delivered by a stream
+ */
+typedef struct {
+    struct bme69x_data data;    /*!< Compensated field, as returned by bme69x_get_data */
+    uint32_t seq;               /*!< Measurement sequence number, meas_index extended to 32 bits */
+    int64_t timestamp_us;       /*!< esp_timer time at which the field was drained from the sensor */
+} bme69x_stream_sample_t;
+
+/**
+ * @brief Stream configuration
+ */
+typedef struct {
+    uint32_t capacity;          /*!< Ring size in samples, a power of two of at least 4 */
+    uint32_t poll_period_us;    /*!< Field polling period, 0 to use the TPH duration of the current configuration */
+    uint32_t task_stack_size;   /*!< Stack size of the reader task in bytes */
+    UBaseType_t task_priority;  /*!< Priority of the reader task */
+    BaseType_t task_core_id;    /*!< Core the reader task is pinned to, or tskNO_AFFINITY */
+} bme69x_stream_config_t;
+
+/**
+ * @brief Default stream configuration: 256 samples, polling at the TPH duration
+ */
+#define BME69X_STREAM_DEFAULT_CONFIG() \
+    {                                  \
+        .capacity = 256,               \
+        .poll_period_us = 0,           \
+        .task_stack_size = 3072,       \
+        .task_priority = 5,            \
+        .task_core_id = tskNO_AFFINITY,\
+    }
+
+/**
+ * @brief Counters of a stream
+ */
+typedef struct {
+    uint32_t samples;           /*!< Samples pushed into the ring */
+    uint32_t lost;              /*!< Measurements overwritten in the sensor before they were drained, from meas_index gaps */
+    uint32_t dropped;           /*!< Samples discarded because the ring was full */
+    uint32_t errors;            /*!< Failed field reads */
+} bme69x_stream_stats_t;
+
+/**
+ * @brief Start parallel mode and a reader task draining its fields into a ring
+ *
+ * Configure the sensor with bme69x_set_conf and bme69x_set_heatr_conf(BME69X_PARALLEL_MODE, ...)
+ * first. The reader task polls the three field registers every poll period and pushes each new
+ * field, compensated and in measurement order, into a single-producer single-consumer ring.
+ * A TPHG cycle is never shorter than the TPH duration, so the default period sees at most one
+ * new field per poll and tolerates two late polls before the sensor overwrites a field.
+ *
+ * The sensor must not be accessed through other driver APIs while the stream runs.
+ *
+ * @param[in] handle Handle of the BME69X sensor object
+ * @param[in] config Stream configuration
+ * @param[out] stream_ret Pointer to a variable that will hold the stream handle
+ * @return
+ *      - ESP_OK: Stream running
+ *      - ESP_ERR_INVALID_ARG: Invalid arguments were provided
+ *      - ESP_ERR_NO_MEM: Ring or task allocation failed
+ *      - ESP_ERR_INVALID_STATE: The sensor could not be put in parallel mode
+ */
+esp_err_t bme69x_stream_create(bme69x_handle_t handle, const bme69x_stream_config_t *config,
+                               bme69x_stream_handle_t *stream_ret);
+
+/**
+ * @brief Stop the reader task, put the sensor to sleep and release the stream
+ *
+ * @param[in] stream Stream handle
+ * @return
+ *      - ESP_OK: Stream deleted
+ *      - ESP_ERR_INVALID_ARG: Invalid stream handle
+ *      - ESP_ERR_TIMEOUT: The reader task did not stop in time, the stream is not released. Call
+ *        again to release it once the task has stopped
+ */
+esp_err_t bme69x_stream_delete(bme69x_stream_handle_t stream);
+
+/**
+ * @brief Move up to max_samples samples out of the ring, oldest first
+ *
+ * Never blocks. Must only be called from one task at a time.
+ *
+ * @param[in] stream Stream handle
+ * @param[out] samples Destination array
+ * @param[in] max_samples Size of the destination array
+ * @return Number of samples copied
+ */
+size_t bme69x_stream_read(bme69x_stream_handle_t stream, bme69x_stream_sample_t *samples, size_t max_samples);
+
+/**
+ * @brief Number of samples waiting in the ring
+ *
+ * @param[in] stream Stream handle
+ * @return Number of samples that bme69x_stream_read can return
+ */
+size_t bme69x_stream_available(bme69x_stream_handle_t stream);
+
+/**
+ * @brief Copy the counters of a stream
+ *
+ * @param[in] stream Stream handle
+ * @param[out] stats Counters since the stream was created
+ * @return
+ *      - ESP_OK: Counters copied
+ *      - ESP_ERR_INVALID_ARG: Invalid arguments were provided
+ */
+esp_err_t bme69x_stream_get_stats(bme69x_stream_handle_t stream, bme69x_stream_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif /*__cplusplus */
+
+#endif // BME69X_STREAM_H
@@ -0,0 +1,32 @@
+#ifndef BME69X_STREAM_INDEX_H
+#define BME69X_STREAM_INDEX_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /*__cplusplus */
+
+/**
+ * @brief Number of measurements from the last field pushed to a field just read
+ *
+ * meas_index counts every field the sensor wrote, a delta above 1 means fields were overwritten.
+ * A field at or behind the last one pushed, such as a field the sensor still holds and returns
+ * again, gives 0. Gaps of 128 fields or more cannot be told from a field already pushed.
+ *
+ * @param[in] last_index meas_index of the last field pushed
+ * @param[in] meas_index meas_index of the field read
+ * @return Measurements advanced, 0 if the field must not be pushed
+ */
+static inline uint8_t bme69x_stream_index_delta(uint8_t last_index, uint8_t meas_index)
+{
+    int8_t delta = (int8_t)(meas_index - last_index);
+
+    return (delta > 0) ? (uint8_t)delta : 0;
+}
+
+#ifdef __cplusplus
+}
+#endif /*__cplusplus */
+
+#endif // BME69X_STREAM_INDEX_H
@@ -5,6 +5,7 @@
  */
 
 #include <stdio.h>
+#include <inttypes.h>
 #include "unity.h"
 #include "esp_system.h"
 #include "esp_log.h"
@@ -12,7 +13,11 @@
 #include "driver/gpio.h"
 
 #include "bme69x_i2c_esp_idf.h"
+#include "bme69x_stream.h"
+#include "bme69x_i2c_async.h"
+#if !CONFIG_BME69X_I2C_BACKEND_I2C_MASTER
 #include "driver/i2c.h"
+#endif
 
 // Settings
 
@@ -32,13 +37,25 @@
 #endif
 
 static bme69x_handle_t bme69x_handle = NULL;
-static i2c_bus_handle_t i2c_bus;
+static bme69x_i2c_bus_handle_t i2c_bus;
 
 /**
  * @brief i2c master initialization
  */
 static void i2c_sensor_bme69x_init(void)
 {
+#if CONFIG_BME69X_I2C_BACKEND_I2C_MASTER
+    const i2c_master_bus_config_t i2c_bus_conf = {
+        .i2c_port = I2C_MASTER_NUM,
+        .sda_io_num = I2C_MASTER_SDA_IO,
+        .scl_io_num = I2C_MASTER_SCL_IO,
+        .clk_source = I2C_CLK_SRC_DEFAULT,
+        .glitch_ignore_cnt = 7,
+        .flags.enable_internal_pullup = true,
+    };
+
+    TEST_ASSERT_EQUAL_MESSAGE(ESP_OK, i2c_new_master_bus(&i2c_bus_conf, &i2c_bus), "i2c_new_master_bus failed");
+#else
     const i2c_config_t i2c_bus_conf = {
         .mode = I2C_MODE_MASTER,
         .sda_io_num = I2C_MASTER_SDA_IO,
@@ -49,17 +66,31 @@ static void i2c_sensor_bme69x_init(void)
     };
 
     i2c_bus = i2c_bus_create(I2C_MASTER_NUM, &i2c_bus_conf);
+#endif
 
     TEST_ASSERT_NOT_NULL_MESSAGE(i2c_bus, "i2c_bus create returned NULL");
 
     bme69x_i2c_config_t i2c_bme69x_conf = {
         .i2c_handle = i2c_bus,
         .i2c_addr = BME69X_I2C_ADDR,
+        .scl_speed_hz = I2C_MASTER_FREQ_HZ,
     };
     bme69x_sensor_create(&i2c_bme69x_conf, &bme69x_handle);
     TEST_ASSERT_NOT_NULL_MESSAGE(bme69x_handle, "BME69X create returned NULL \n");
 }
 
+/**
+ * @brief i2c master release
+ */
+static void i2c_sensor_bus_delete(void)
+{
+#if CONFIG_BME69X_I2C_BACKEND_I2C_MASTER
+    i2c_del_master_bus(i2c_bus);
+#else
+    i2c_bus_delete(&i2c_bus);
+#endif
+}
+
 int8_t run_self_test(bme69x_handle_t bme)
 {
     int8_t rslt = bme69x_selftest_check(bme);
@@ -94,14 +125,125 @@ TEST_CASE("BME69X self_test", "[BME69X][self_test]")
     bme69x_check_rslt("after_run_self_test", rslt);
     TEST_ASSERT_EQUAL(BME69X_OK, rslt);
 
-    bme69x_sensor_del(bme69x_handle);
-    ret = bme69x_i2c_deinit();
-    i2c_bus_delete(i2c_bus);
+    ret = bme69x_sensor_del(bme69x_handle);
+    i2c_sensor_bus_delete();
     TEST_ASSERT_EQUAL(ESP_OK, ret);
     printf("DONE: TEST_CASE BME69X self_test\n");
 
 }
 
+TEST_CASE("BME69X multi_instance", "[BME69X][multi_instance]")
+{
+    printf("START: TEST_CASE BME69X multi_instance\n");
+
+    bme69x_handle_t second_handle = NULL;
+    uint8_t chip_id = 0;
+
+    i2c_sensor_bme69x_init();
+
+    bme69x_i2c_config_t i2c_bme69x_conf = {
+        .i2c_handle = i2c_bus,
+        .i2c_addr = BME69X_I2C_ADDR,
+    };
+    TEST_ASSERT_EQUAL(ESP_OK, bme69x_sensor_create(&i2c_bme69x_conf, &second_handle));
+    TEST_ASSERT_NOT_NULL(second_handle);
+    TEST_ASSERT_NOT_EQUAL(bme69x_handle->intf_ptr, second_handle->intf_ptr);
+
+    /* Deleting one handle must leave the bus device of the other intact */
+    TEST_ASSERT_EQUAL(ESP_OK, bme69x_sensor_del(second_handle));
+    TEST_ASSERT_EQUAL(BME69X_OK, bme69x_get_regs(BME69X_REG_CHIP_ID, &chip_id, 1, bme69x_handle));
+    TEST_ASSERT_EQUAL(BME69X_CHIP_ID, chip_id);
+
+    TEST_ASSERT_EQUAL(ESP_OK, bme69x_sensor_del(bme69x_handle));
+    i2c_sensor_bus_delete();
+    printf("DONE: TEST_CASE BME69X multi_instance\n");
+}
+
+TEST_CASE("BME69X create_static", "[BME69X][multi_instance]")
+{
+    printf("START: TEST_CASE BME69X create_static\n");
+
+    static bme69x_sensor_storage_t storage;
+    bme69x_i2c_dev_handle_t i2c_dev = NULL;
+    bme69x_handle_t handle = NULL;
+    uint8_t chip_id = 0;
+    size_t free_before;
+
+    i2c_sensor_bme69x_init();
+    TEST_ASSERT_EQUAL(ESP_OK, bme69x_sensor_del(bme69x_handle));
+
+    /* A bus device of the test, borrowed by the sensor */
+#if CONFIG_BME69X_I2C_BACKEND_I2C_MASTER
+    const i2c_device_config_t dev_conf = {
+        .dev_addr_length = I2C_ADDR_BIT_LEN_7,
+        .device_address = BME69X_I2C_ADDR,
+        .scl_speed_hz = I2C_MASTER_FREQ_HZ,
+    };
+    TEST_ASSERT_EQUAL(ESP_OK, i2c_master_bus_add_device(i2c_bus, &dev_conf, &i2c_dev));
+#else
+    i2c_dev = i2c_bus_device_create(i2c_bus, BME69X_I2C_ADDR, I2C_MASTER_FREQ_HZ);
+#endif
+    TEST_ASSERT_NOT_NULL(i2c_dev);
+
+    bme69x_i2c_config_t i2c_bme69x_conf = {
+        .i2c_handle = i2c_bus,
+        .i2c_addr = BME69X_I2C_ADDR,
+        .i2c_dev = i2c_dev,
+    };
+
+    /* Hot-plug detection: create and delete cycles allocate nothing */
+    free_before = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    for (int i = 0; i < 20; i++)
+    {
+        TEST_ASSERT_EQUAL(ESP_OK, bme69x_sensor_create_static(&i2c_bme69x_conf, &storage, &handle));
+        TEST_ASSERT_EQUAL_PTR(&storage, handle);
+        TEST_ASSERT_EQUAL(BME69X_OK, bme69x_get_regs(BME69X_REG_CHIP_ID, &chip_id, 1, handle));
+        TEST_ASSERT_EQUAL(BME69X_CHIP_ID, chip_id);
+        TEST_ASSERT_EQUAL(ESP_OK, bme69x_sensor_del(handle));
+    }
+    TEST_ASSERT_EQUAL(free_before, heap_caps_get_free_size(MALLOC_CAP_8BIT));
+
+    /* The borrowed device outlives the sensor */
+#if CONFIG_BME69X_I2C_BACKEND_I2C_MASTER
+    TEST_ASSERT_EQUAL(ESP_OK, i2c_master_bus_rm_device(i2c_dev));
+#else
+    TEST_ASSERT_EQUAL(ESP_OK, i2c_bus_device_delete(&i2c_dev));
+#endif
+    i2c_sensor_bus_delete();
+    printf("DONE: TEST_CASE BME69X create_static\n");
+}
+
+TEST_CASE("BME69X delay_accuracy", "[BME69X][delay]")
+{
+    printf("START: TEST_CASE BME69X delay_accuracy\n");
+
+    const bme69x_delay_mode_t modes[] = { BME69X_DELAY_TIMER, BME69X_DELAY_SPIN, BME69X_DELAY_HYBRID };
+    const uint32_t periods[] = { 200, 2500, BME69X_PERIOD_POLL };
+    bme69x_delay_stats_t stats;
+
+    i2c_sensor_bme69x_init();
+
+    for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++)
+    {
+        TEST_ASSERT_EQUAL(ESP_OK, bme69x_delay_set_mode(bme69x_handle, modes[m]));
+        TEST_ASSERT_EQUAL(ESP_OK, bme69x_delay_reset_stats(bme69x_handle));
+
+        for (size_t p = 0; p < sizeof(periods) / sizeof(periods[0]); p++)
+        {
+            bme69x_handle->delay_us(periods[p], bme69x_handle->intf_ptr);
+        }
+
+        TEST_ASSERT_EQUAL(ESP_OK, bme69x_delay_get_stats(bme69x_handle, &stats));
+        printf("mode %d: max overshoot %lu us\n", modes[m], (unsigned long)stats.max_overshoot_us);
+        TEST_ASSERT_EQUAL_UINT32(sizeof(periods) / sizeof(periods[0]), stats.count);
+        TEST_ASSERT_LESS_THAN_UINT32(1000, stats.max_overshoot_us);
+    }
+
+    TEST_ASSERT_EQUAL(ESP_OK, bme69x_sensor_del(bme69x_handle));
+    i2c_sensor_bus_delete();
+    printf("DONE: TEST_CASE BME69X delay_accuracy\n");
+}
+
 static size_t before_free_8bit;
 static size_t before_free_32bit;
 
@@ -144,6 +286,7 @@ TEST_CASE("BME69X forced_mode", "[BME69X][forced_mode]")
     struct bme69x_conf conf;
     struct bme69x_heatr_conf heatr_conf;
     struct bme69x_data data;
+    struct bme69x_timing timing;
     uint32_t del_period;
     uint32_t time_ms = 0;
     uint8_t n_fields;
@@ -179,8 +322,10 @@ TEST_CASE("BME69X forced_mode", "[BME69X][forced_mode]")
         bme69x_check_rslt("bme69x_set_op_mode", rslt);
         TEST_ASSERT_EQUAL(BME69X_OK, rslt);
 
-        /* Calculate delay period in microseconds */
-        del_period = bme69x_get_meas_dur(BME69X_FORCED_MODE, &conf, bme69x_handle) + (heatr_conf.heatr_dur * 1000);
+        /* Delay period in microseconds, with the heater duration as the sensor runs it */
+        rslt = bme69x_get_timing(BME69X_FORCED_MODE, &conf, &heatr_conf, &timing, bme69x_handle);
+        TEST_ASSERT_EQUAL(BME69X_OK, rslt);
+        del_period = timing.cycle_us;
         bme69x_handle->delay_us(del_period, bme69x_handle->intf_ptr);
 
         time_ms = esp_timer_get_time() / 1000;  // Convert to milliseconds
@@ -215,13 +360,216 @@ TEST_CASE("BME69X forced_mode", "[BME69X][forced_mode]")
         }
     }
 
-    bme69x_sensor_del(bme69x_handle);
-    ret = bme69x_i2c_deinit();
-    i2c_bus_delete(i2c_bus);
+    ret = bme69x_sensor_del(bme69x_handle);
+    i2c_sensor_bus_delete();
     TEST_ASSERT_EQUAL(ESP_OK, ret);
     printf("DONE: TEST_CASE BME69X forced_mode\n");
 }
 
+TEST_CASE("BME69X forced_mode_nonblocking", "[BME69X][forced_mode]")
+{
+    printf("START: TEST_CASE BME69X forced_mode_nonblocking\n");
+
+    int8_t rslt;
+    struct bme69x_conf conf;
+    struct bme69x_heatr_conf heatr_conf = { 0 };
+    struct bme69x_data data;
+    uint64_t ready_us;
+    uint8_t n_fields = 0;
+    uint16_t polls = 0;
+
+    i2c_sensor_bme69x_init();
+
+    conf.filter = BME69X_FILTER_OFF;
+    conf.odr = BME69X_ODR_NONE;
+    conf.os_hum = BME69X_OS_1X;
+    conf.os_pres = BME69X_OS_4X;
+    conf.os_temp = BME69X_OS_2X;
+    TEST_ASSERT_EQUAL(BME69X_OK, bme69x_set_conf(&conf, bme69x_handle));
+
+    heatr_conf.enable = BME69X_ENABLE;
+    heatr_conf.heatr_temp = 300;
+    heatr_conf.heatr_dur = 50;
+    TEST_ASSERT_EQUAL(BME69X_OK, bme69x_set_heatr_conf(BME69X_FORCED_MODE, &heatr_conf, bme69x_handle));
+
+    for (uint16_t sample = 0; sample < SAMPLE_COUNT; sample++)
+    {
+        TEST_ASSERT_EQUAL(BME69X_OK, bme69x_trigger_forced(&conf, &heatr_conf, &ready_us, bme69x_handle));
+        TEST_ASSERT_GREATER_THAN_UINT64(esp_timer_get_time(), ready_us);
+
+        while ((uint64_t)esp_timer_get_time() < ready_us)
+        {
+            vTaskDelay(1);
+        }
+
+        do
+        {
+            rslt = bme69x_try_collect(&data, &n_fields, bme69x_handle);
+            polls++;
+        } while (rslt == BME69X_W_NO_NEW_DATA);
+
+        TEST_ASSERT_EQUAL(BME69X_OK, rslt);
+        TEST_ASSERT_EQUAL(1, n_fields);
+    }
+
+    printf("%u samples collected with %u polls\n", SAMPLE_COUNT, polls);
+
+    TEST_ASSERT_EQUAL(ESP_OK, bme69x_sensor_del(bme69x_handle));
+    i2c_sensor_bus_delete();
+    printf("DONE: TEST_CASE BME69X forced_mode_nonblocking\n");
+}
+
+#define STREAM_SAMPLE_COUNT  UINT16_C(50)
+
+TEST_CASE("BME69X parallel_stream", "[BME69X][parallel_mode]")
+{
+    printf("START: TEST_CASE BME69X parallel_stream\n");
+
+    struct bme69x_conf conf;
+    struct bme69x_heatr_conf heatr_conf = { 0 };
+    uint16_t temp_prof[10] = { 320, 100, 100, 100, 200, 200, 200, 320, 320, 320 };
+    uint16_t mul_prof[10] = { 5, 2, 10, 30, 5, 5, 5, 5, 5, 5 };
+    bme69x_stream_config_t stream_conf = BME69X_STREAM_DEFAULT_CONFIG();
+    bme69x_stream_handle_t stream = NULL;
+    bme69x_stream_sample_t samples[16];
+    bme69x_stream_stats_t stats;
+    uint16_t received = 0;
+    uint32_t next_seq = 0;
+    int64_t deadline;
+
+    i2c_sensor_bme69x_init();
+
+    conf.filter = BME69X_FILTER_OFF;
+    conf.odr = BME69X_ODR_NONE;
+    conf.os_hum = BME69X_OS_1X;
+    conf.os_pres = BME69X_OS_16X;
+    conf.os_temp = BME69X_OS_2X;
+    TEST_ASSERT_EQUAL(BME69X_OK, bme69x_set_conf(&conf, bme69x_handle));
+
+    heatr_conf.enable = BME69X_ENABLE;
+    heatr_conf.heatr_temp_prof = temp_prof;
+    heatr_conf.heatr_dur_prof = mul_prof;
+    heatr_conf.shared_heatr_dur = (uint16_t)(140 - (bme69x_get_meas_dur(BME69X_PARALLEL_MODE, &conf, bme69x_handle) / 1000));
+    heatr_conf.profile_len = 10;
+    TEST_ASSERT_EQUAL(BME69X_OK, bme69x_set_heatr_conf(BME69X_PARALLEL_MODE, &heatr_conf, bme69x_handle));
+
+    TEST_ASSERT_EQUAL(ESP_OK, bme69x_stream_create(bme69x_handle, &stream_conf, &stream));
+
+    /* Drain in batches, far less often than the sensor produces fields */
+    deadline = esp_timer_get_time() + 60 * 1000 * 1000;
+    while ((received < STREAM_SAMPLE_COUNT) && (esp_timer_get_time() < deadline))
+    {
+        vTaskDelay(pdMS_TO_TICKS(1000));
+
+        size_t n = bme69x_stream_read(stream, samples, sizeof(samples) / sizeof(samples[0]));
+        for (size_t i = 0; i < n; i++)
+        {
+            if (received != 0) {
+                TEST_ASSERT_EQUAL_UINT32(next_seq, samples[i].seq);
+            }
+            TEST_ASSERT_TRUE(samples[i].data.status & BME69X_NEW_DATA_MSK);
+            next_seq = samples[i].seq + 1;
+            received++;
+        }
+    }
+
+    TEST_ASSERT_EQUAL(ESP_OK, bme69x_stream_get_stats(stream, &stats));
+    printf("%" PRIu32 " samples, %" PRIu32 " lost, %" PRIu32 " dropped, %" PRIu32 " errors\n",
+           stats.samples, stats.lost, stats.dropped, stats.errors);
+    TEST_ASSERT_EQUAL(ESP_OK, bme69x_stream_delete(stream));
+
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT16(STREAM_SAMPLE_COUNT, received);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.lost);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.dropped);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.errors);
+
+    TEST_ASSERT_EQUAL(ESP_OK, bme69x_sensor_del(bme69x_handle));
+    i2c_sensor_bus_delete();
+
+    /* Let the idle task free the reader task before the leak check */
+    vTaskDelay(pdMS_TO_TICKS(10));
+    printf("DONE: TEST_CASE BME69X parallel_stream\n");
+}
+
+static void async_count_cb(esp_err_t result, void *arg)
+{
+    if (result == ESP_OK) {
+        (*(volatile uint32_t *)arg)++;
+    }
+}
+
+TEST_CASE("BME69X i2c_async", "[BME69X][i2c_async]")
+{
+    printf("START: TEST_CASE BME69X i2c_async\n");
+
+    bme69x_i2c_async_config_t async_conf = BME69X_I2C_ASYNC_DEFAULT_CONFIG();
+    bme69x_i2c_async_bus_handle_t async_bus = NULL;
+    bme69x_i2c_async_future_t futures[2];
+    bme69x_handle_t second_handle = NULL;
+    uint8_t chip_id[2] = { 0 };
+    volatile uint32_t n_done = 0;
+    struct bme69x_conf conf = { 0 };
+    struct bme69x_heatr_conf heatr_conf = { 0 };
+    struct bme69x_data data;
+    uint8_t n_fields = 0;
+
+    i2c_sensor_bme69x_init();
+
+    bme69x_i2c_config_t i2c_bme69x_conf = {
+        .i2c_handle = i2c_bus,
+        .i2c_addr = BME69X_I2C_ADDR,
+    };
+    TEST_ASSERT_EQUAL(ESP_OK, bme69x_sensor_create(&i2c_bme69x_conf, &second_handle));
+    TEST_ASSERT_EQUAL(ESP_OK, bme69x_i2c_async_bus_create(&async_conf, &async_bus));
+
+    /* Both reads are queued before either completes */
+    const bme69x_handle_t handles[2] = { bme69x_handle, second_handle };
+    for (int i = 0; i < 2; i++)
+    {
+        bme69x_i2c_async_future_init(&futures[i]);
+        const bme69x_i2c_async_req_t req = {
+            .op = BME69X_I2C_ASYNC_READ,
+            .sensor = handles[i],
+            .reg_addr = BME69X_REG_CHIP_ID,
+            .data = &chip_id[i],
+            .len = 1,
+            .cb = async_count_cb,
+            .cb_arg = (void *)&n_done,
+            .future = &futures[i],
+        };
+        TEST_ASSERT_EQUAL(ESP_OK, bme69x_i2c_async_submit(async_bus, &req, portMAX_DELAY));
+    }
+    for (int i = 0; i < 2; i++)
+    {
+        TEST_ASSERT_EQUAL(ESP_OK, bme69x_i2c_async_future_wait(&futures[i], pdMS_TO_TICKS(100)));
+        bme69x_i2c_async_future_deinit(&futures[i]);
+        TEST_ASSERT_EQUAL_HEX8(BME69X_CHIP_ID, chip_id[i]);
+    }
+    TEST_ASSERT_EQUAL_UINT32(2, n_done);
+
+    /* The driver runs unchanged on top of the blocking adapters */
+    TEST_ASSERT_EQUAL(ESP_OK, bme69x_i2c_async_attach(bme69x_handle, async_bus));
+    conf.os_hum = BME69X_OS_1X;
+    conf.os_pres = BME69X_OS_1X;
+    conf.os_temp = BME69X_OS_1X;
+    TEST_ASSERT_EQUAL(BME69X_OK, bme69x_set_conf(&conf, bme69x_handle));
+    TEST_ASSERT_EQUAL(BME69X_OK, bme69x_set_heatr_conf(BME69X_FORCED_MODE, &heatr_conf, bme69x_handle));
+    TEST_ASSERT_EQUAL(BME69X_OK, bme69x_set_op_mode(BME69X_FORCED_MODE, bme69x_handle));
+    bme69x_handle->delay_us(bme69x_get_meas_dur(BME69X_FORCED_MODE, &conf, bme69x_handle), bme69x_handle->intf_ptr);
+    TEST_ASSERT_EQUAL(BME69X_OK, bme69x_get_data(BME69X_FORCED_MODE, &data, &n_fields, bme69x_handle));
+    TEST_ASSERT_EQUAL(1, n_fields);
+    TEST_ASSERT_EQUAL(ESP_OK, bme69x_i2c_async_detach(bme69x_handle));
+
+    TEST_ASSERT_EQUAL(ESP_OK, bme69x_i2c_async_bus_delete(async_bus));
+    TEST_ASSERT_EQUAL(ESP_OK, bme69x_sensor_del(second_handle));
+    TEST_ASSERT_EQUAL(ESP_OK, bme69x_sensor_del(bme69x_handle));
+    i2c_sensor_bus_delete();
+
+    /* Let the idle task free the worker task before the leak check */
+    vTaskDelay(pdMS_TO_TICKS(10));
+    printf("DONE: TEST_CASE BME69X i2c_async\n");
+}
+
 void app_main(void)
 {
     printf("BME69X TEST \n");
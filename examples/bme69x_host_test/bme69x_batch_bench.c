@@ -0,0 +1,121 @@
+/*
+ * Host-side benchmark of bme69x_compensate_records on a large archive of raw field records.
+ * The Makefile builds it with the default flags and block size, and once more with
+ * BATCH_CFLAGS, which let the compiler vectorise the per-quantity loops for the host CPU.
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "bme69x.c"
+#include "bme69x_test_nvm.h"
+
+/*! Records per run, runs per measurement */
+#define BENCH_N_RECORDS  (1u << 20)
+#define BENCH_N_RUNS     8
+
+static uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/* Records with readings around 25 degC, 1000 hPa and 45 %rH with some spread */
+static void bench_fill(uint8_t *records)
+{
+    uint32_t seed = 12345;
+    uint32_t adc_temp, adc_pres;
+    uint16_t adc_hum, adc_gas;
+    uint8_t *field;
+    uint32_t i;
+
+    for (i = 0; i < BENCH_N_RECORDS; i++)
+    {
+        field = &records[i * BME69X_LEN_FIELD];
+        seed = seed * 1664525u + 1013904223u;
+        adc_temp = 7500000 + (seed >> 12) % 400000;
+        adc_pres = 440000 + (seed >> 8) % 40000;
+        adc_hum = (uint16_t)(50000 + (seed >> 16) % 10000);
+        adc_gas = (uint16_t)((seed >> 4) % 1024);
+
+        field[0] = BME69X_NEW_DATA_MSK;
+        field[1] = (uint8_t)i;
+        field[2] = (uint8_t)(adc_pres >> 16);
+        field[3] = (uint8_t)(adc_pres >> 8);
+        field[4] = (uint8_t)adc_pres;
+        field[5] = (uint8_t)(adc_temp >> 16);
+        field[6] = (uint8_t)(adc_temp >> 8);
+        field[7] = (uint8_t)adc_temp;
+        field[8] = (uint8_t)(adc_hum >> 8);
+        field[9] = (uint8_t)adc_hum;
+        field[15] = (uint8_t)(adc_gas >> 2);
+        field[16] = (uint8_t)((adc_gas << 6) | BME69X_GASM_VALID_MSK | ((seed >> 24) % 16));
+    }
+}
+
+int main(void)
+{
+    struct bme69x_dev dev = { 0 };
+    uint8_t *records = calloc(BENCH_N_RECORDS, BME69X_LEN_FIELD);
+    struct bme69x_data *data = calloc(BENCH_N_RECORDS, sizeof(struct bme69x_data));
+    uint64_t start, best = UINT64_MAX;
+    double check = 0;
+    uint32_t run, i;
+
+    if (!records || !data)
+    {
+        printf("allocation failed\n");
+
+        return 1;
+    }
+
+    if (test_nvm_calib(&dev, test_nvm_coeff[0]) != BME69X_OK)
+    {
+        printf("get_calib_data failed\n");
+
+        return 1;
+    }
+
+    bench_fill(records);
+
+    /* Best of several runs, to keep scheduling noise out of the figure */
+    for (run = 0; run < BENCH_N_RUNS; run++)
+    {
+        start = bench_now_ns();
+        if (bme69x_compensate_records(records, BENCH_N_RECORDS, &dev.calib, data) != BME69X_OK)
+        {
+            printf("bme69x_compensate_records failed\n");
+
+            return 1;
+        }
+
+        start = bench_now_ns() - start;
+        best = (start < best) ? start : best;
+    }
+
+    for (i = 0; i < BENCH_N_RECORDS; i++)
+    {
+        check += (double)data[i].temperature + (double)data[i].pressure;
+    }
+
+#ifdef BME69X_USE_FPU
+    printf("floating point batch, block %3u: %.1f ns/record, %.0f records/s (checksum %.6g)\n",
+#else
+    printf("fixed point batch, block %3u:    %.1f ns/record, %.0f records/s (checksum %.6g)\n",
+#endif
+           (unsigned)BME69X_COMP_BLOCK,
+           (double)best / BENCH_N_RECORDS,
+           1e9 * BENCH_N_RECORDS / (double)best,
+           check);
+
+    free(records);
+    free(data);
+
+    return 0;
+}
@@ -0,0 +1,115 @@
+/*
+ * Host-side benchmark of the per-sample compensation cost: temperature, pressure, humidity
+ * and gas resistance of one field. Build it once with the floating point path and once with
+ * BME69X_DO_NOT_USE_FPU, see the Makefile.
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <time.h>
+
+#include "bme69x.c"
+#include "bme69x_test_nvm.h"
+
+/*! Samples per run, runs per measurement */
+#define BENCH_N_SAMPLES  4096
+#define BENCH_N_RUNS     512
+
+struct bench_sample
+{
+    uint32_t adc_temp;
+    uint32_t adc_pres;
+    uint16_t adc_hum;
+    uint16_t adc_gas;
+    uint8_t gas_range;
+};
+
+static struct bench_sample bench_samples[BENCH_N_SAMPLES];
+static struct bme69x_data bench_out[BENCH_N_SAMPLES];
+
+static uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/* Plausible readings around 25 degC, 1000 hPa and 45 %rH with some spread */
+static void bench_fill(void)
+{
+    uint32_t seed = 12345;
+    uint32_t i;
+
+    for (i = 0; i < BENCH_N_SAMPLES; i++)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        bench_samples[i].adc_temp = 7500000 + (seed >> 12) % 400000;
+        bench_samples[i].adc_pres = 440000 + (seed >> 8) % 40000;
+        bench_samples[i].adc_hum = (uint16_t)(50000 + (seed >> 16) % 10000);
+        bench_samples[i].adc_gas = (uint16_t)((seed >> 4) % 1024);
+        bench_samples[i].gas_range = (uint8_t)((seed >> 24) % 16);
+    }
+}
+
+/* Same compensation sequence as read_field_data */
+static void bench_compensate(const struct bench_sample *in, struct bme69x_data *data, const struct bme69x_dev *dev)
+{
+#ifndef BME69X_USE_FPU
+    data->temperature = calc_temperature(in->adc_temp, &dev->calib, &data->t_lin);
+    data->pressure = calc_pressure(in->adc_pres, data->t_lin, &dev->calib);
+    data->humidity = calc_humidity(in->adc_hum, data->t_lin, &dev->calib);
+#else
+    data->temperature = calc_temperature(in->adc_temp, &dev->calib);
+    data->pressure = calc_pressure(in->adc_pres, data->temperature, &dev->calib);
+    data->humidity = calc_humidity(in->adc_hum, data->temperature, &dev->calib);
+#endif
+    data->gas_resistance = calc_gas_resistance(in->adc_gas, in->gas_range);
+}
+
+int main(void)
+{
+    struct bme69x_dev dev = { 0 };
+    uint64_t start, best = UINT64_MAX;
+    uint32_t run, i;
+    double check = 0;
+
+    if (test_nvm_calib(&dev, test_nvm_coeff[0]) != BME69X_OK)
+    {
+        printf("get_calib_data failed\n");
+
+        return 1;
+    }
+
+    bench_fill();
+
+    /* Best of several runs, to keep scheduling noise out of the figure */
+    for (run = 0; run < BENCH_N_RUNS; run++)
+    {
+        start = bench_now_ns();
+        for (i = 0; i < BENCH_N_SAMPLES; i++)
+        {
+            bench_compensate(&bench_samples[i], &bench_out[i], &dev);
+        }
+
+        start = bench_now_ns() - start;
+        best = (start < best) ? start : best;
+    }
+
+    for (i = 0; i < BENCH_N_SAMPLES; i++)
+    {
+        check += (double)bench_out[i].temperature + (double)bench_out[i].pressure;
+    }
+
+#ifdef BME69X_USE_FPU
+    printf("floating point compensation: %.1f ns/sample (checksum %.6g)\n",
+#else
+    printf("fixed point compensation:    %.1f ns/sample (checksum %.6g)\n",
+#endif
+           (double)best / BENCH_N_SAMPLES,
+           check);
+
+    return 0;
+}
@@ -0,0 +1,433 @@
+/*
+ * Host-side sweep of the compensation formulas against a double precision reference.
+ *
+ * The driver is included as a translation unit so that the internal calc_* functions can be
+ * driven directly. Build it once with the floating point path and once with
+ * BME69X_DO_NOT_USE_FPU, see the Makefile.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bme69x.c"
+#include "bme69x_test_nvm.h"
+
+/*! Operating range the errors are reported over */
+#define TEST_MIN_T      (-40.0)
+#define TEST_MAX_T      (85.0)
+#define TEST_MIN_P      (30000.0)
+#define TEST_MAX_P      (110000.0)
+#define TEST_STEP_T     (25.0)
+
+/*! Error bounds: one output LSB of the fixed point path, rounding noise of the float path */
+#ifdef BME69X_USE_FPU
+#define TEST_MAX_ERR_T  (0.001)
+#define TEST_MAX_ERR_P  (0.05)
+#define TEST_MAX_ERR_H  (0.001)
+#define TEST_MAX_ERR_G  (1e-6)
+#else
+#define TEST_MAX_ERR_T  (0.0101)
+#define TEST_MAX_ERR_P  (1.5)
+#define TEST_MAX_ERR_H  (0.002)
+#define TEST_MAX_ERR_G  (1e-3)
+#endif
+#define TEST_MAX_ERR_RH (1)
+
+/*! Records of the batch compensation check, not a multiple of BME69X_COMP_BLOCK */
+#define TEST_N_RECORDS  1003
+
+#ifdef BME69X_USE_FPU
+typedef float test_temp_t;
+#define TEST_OUT_T(x)   ((double)(x))
+#define TEST_OUT_P(x)   ((double)(x))
+#define TEST_OUT_H(x)   ((double)(x))
+#else
+typedef int32_t test_temp_t;
+#define TEST_OUT_T(x)   ((double)(x) / 100.0)
+#define TEST_OUT_P(x)   ((double)(x))
+#define TEST_OUT_H(x)   ((double)(x) / 1000.0)
+#endif
+
+/* Datasheet temperature compensation in double precision */
+static double ref_temperature(uint32_t temp_adc, const struct bme69x_calib_data *c)
+{
+    double cf = (double)temp_adc - (double)c->par_t1 * 256.0;
+
+    return cf * ((double)c->par_t2 / 1073741824.0) + cf * cf * ((double)c->par_t3 / 281474976710656.0);
+}
+
+/* Temperature reference in the shape adc_lower_bound expects */
+static double ref_temperature_at(uint32_t temp_adc, double t, const struct bme69x_calib_data *c)
+{
+    (void)t;
+
+    return ref_temperature(temp_adc, c);
+}
+
+/* Datasheet pressure compensation in double precision */
+static double ref_pressure(uint32_t pres_adc, double t, const struct bme69x_calib_data *c)
+{
+    double p = (double)pres_adc;
+    double offset, sens, nls;
+
+    offset = (double)c->par_p1 * 8.0 + (double)c->par_p2 / 64.0 * t + (double)c->par_p3 / 256.0 * t * t +
+             (double)c->par_p4 / 32768.0 * t * t * t;
+    sens = ((double)c->par_p5 - 16384.0) / 1048576.0 + ((double)c->par_p6 - 16384.0) / 536870912.0 * t +
+           (double)c->par_p7 / 4294967296.0 * t * t + (double)c->par_p8 / 137438953472.0 * t * t * t;
+    nls = (double)c->par_p9 / 281474976710656.0 + (double)c->par_p10 / 281474976710656.0 * t;
+
+    return offset + p * sens + p * p * nls + p * p * p * ((double)c->par_p11 / 36893488147419103232.0);
+}
+
+/* Datasheet humidity compensation in double precision */
+static double ref_humidity(uint16_t hum_adc, double t, const struct bme69x_calib_data *c)
+{
+    double tc = t * 5120.0 - 76800.0;
+    double tk1sh = (double)c->par_h4 / 67108864.0;
+    double hoff, hsens;
+
+    hoff = (double)hum_adc - ((double)c->par_h1 * 64.0 + (double)c->par_h2 / 16384.0 * tc);
+    hsens = hoff * ((double)c->par_h5 / 65536.0) *
+            (1.0 + tk1sh * tc + tk1sh * ((double)c->par_h3 / 67108864.0) * tc * tc);
+
+    return hsens * (1.0 - (double)c->par_h6 / 524288.0 * hsens);
+}
+
+/* Datasheet heater resistance set-point in double precision */
+static double ref_res_heat(uint16_t temp, const struct bme69x_dev *dev)
+{
+    const struct bme69x_calib_data *c = &dev->calib;
+    double var4, var5;
+
+    var4 = ((double)c->par_g1 / 16.0 + 49.0) * (1.0 + ((double)c->par_g2 / 32768.0 * 0.0005 + 0.00235) * temp);
+    var5 = var4 + (double)c->par_g3 / 1024.0 * (double)dev->amb_temp;
+
+    return 3.4 * (var5 * (4.0 / (4.0 + (double)c->res_heat_range)) / (1.0 + (double)c->res_heat_val * 0.002) - 25.0);
+}
+
+/* Driver temperature, keeping what the pressure and humidity formulas of the build need */
+static double dut_temperature(uint32_t temp_adc, const struct bme69x_dev *dev, test_temp_t *t_state)
+{
+#ifdef BME69X_USE_FPU
+    *t_state = calc_temperature(temp_adc, &dev->calib);
+
+    return TEST_OUT_T(*t_state);
+#else
+
+    return TEST_OUT_T(calc_temperature(temp_adc, &dev->calib, t_state));
+#endif
+}
+
+/* Smallest ADC value of a rising reference compensating to at least target */
+static uint32_t adc_lower_bound(double (*ref)(uint32_t adc, double t, const struct bme69x_calib_data *c),
+                                double target,
+                                double t,
+                                const struct bme69x_calib_data *c)
+{
+    uint32_t lo = 0;
+    uint32_t hi = UINT32_C(1) << 24;
+    uint32_t mid;
+
+    while (lo < hi)
+    {
+        mid = lo + (hi - lo) / 2;
+        if (ref(mid, t, c) < target)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+/* Records whose batch compensation differs from compensating their field alone */
+static double batch_mismatches(const struct bme69x_dev *dev)
+{
+    static uint8_t records[TEST_N_RECORDS][BME69X_LEN_FIELD];
+    static struct bme69x_data batch[TEST_N_RECORDS];
+    struct bme69x_data single;
+    struct bme69x_data *single_ptr = &single;
+    uint32_t seed = 1;
+    uint32_t adc_temp, adc_pres;
+    uint16_t adc_hum, adc_gas;
+    double mismatches = 0;
+    uint32_t i;
+
+    for (i = 0; i < TEST_N_RECORDS; i++)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        adc_temp = 7000000 + (seed >> 8) % 1500000;
+        adc_pres = 300000 + (seed >> 4) % 300000;
+        adc_hum = (uint16_t)(seed >> 12);
+        adc_gas = (uint16_t)((seed >> 2) % 1024);
+
+        records[i][0] = (uint8_t)(BME69X_NEW_DATA_MSK | (i % 10));
+        records[i][1] = (uint8_t)i;
+        records[i][2] = (uint8_t)(adc_pres >> 16);
+        records[i][3] = (uint8_t)(adc_pres >> 8);
+        records[i][4] = (uint8_t)adc_pres;
+        records[i][5] = (uint8_t)(adc_temp >> 16);
+        records[i][6] = (uint8_t)(adc_temp >> 8);
+        records[i][7] = (uint8_t)adc_temp;
+        records[i][8] = (uint8_t)(adc_hum >> 8);
+        records[i][9] = (uint8_t)adc_hum;
+        records[i][15] = (uint8_t)(adc_gas >> 2);
+        records[i][16] = (uint8_t)((adc_gas << 6) | BME69X_GASM_VALID_MSK | ((seed >> 24) % 16));
+    }
+
+    if (bme69x_compensate_records(&records[0][0], TEST_N_RECORDS, &dev->calib, batch) != BME69X_OK)
+    {
+        return TEST_N_RECORDS;
+    }
+
+    for (i = 0; i < TEST_N_RECORDS; i++)
+    {
+        compensate_fields(records[i], 1, &single_ptr, &dev->calib);
+        if ((batch[i].status != single.status) || (batch[i].gas_index != single.gas_index) ||
+            (batch[i].meas_index != single.meas_index) || (batch[i].temperature != single.temperature) ||
+            (batch[i].pressure != single.pressure) || (batch[i].humidity != single.humidity) ||
+            (batch[i].gas_resistance != single.gas_resistance) || (batch[i].idac != 0))
+        {
+            mismatches++;
+        }
+    }
+
+    return mismatches;
+}
+
+/* Heater codes from the lookup table that differ from the code calculated at the ambient temperature of the table */
+static double heatr_lut_mismatches(struct bme69x_dev *dev)
+{
+    struct bme69x_heatr_lut lut = { { 0 }, 0, 0 };
+    double mismatches = 0;
+    int8_t amb_temp;
+    uint16_t temp;
+    uint8_t code;
+
+    dev->heatr_lut = &lut;
+    for (amb_temp = -20; amb_temp <= 60; amb_temp++)
+    {
+        for (temp = 0; temp <= 450; temp++)
+        {
+            dev->amb_temp = amb_temp;
+            code = get_res_heat(temp, dev);
+            if (temp >= BME69X_HEATR_LUT_MIN_TEMP)
+            {
+                if (!lut.valid || (abs(amb_temp - lut.amb_temp) > BME69X_HEATR_LUT_AMB_TOL))
+                {
+                    mismatches++;
+                }
+
+                dev->amb_temp = lut.amb_temp;
+            }
+
+            if (code != calc_res_heat(temp, dev))
+            {
+                mismatches++;
+            }
+        }
+    }
+
+    dev->heatr_lut = NULL;
+    dev->amb_temp = 0;
+
+    return mismatches;
+}
+
+/* Heater register loops of the original driver */
+static uint8_t ref_gas_wait(uint16_t dur)
+{
+    uint8_t factor = 0;
+
+    if (dur >= 0xfc0)
+    {
+        return 0xff;
+    }
+
+    while (dur > 0x3F)
+    {
+        dur = dur / 4;
+        factor += 1;
+    }
+
+    return (uint8_t)(dur + (factor * 64));
+}
+
+static uint8_t ref_heatr_dur_shared(uint16_t dur)
+{
+    uint8_t factor = 0;
+
+    if (dur >= 0x783)
+    {
+        return 0xff;
+    }
+
+    dur = (uint16_t)(((uint32_t)dur * 1000) / 477);
+    while (dur > 0x3F)
+    {
+        dur = dur >> 2;
+        factor += 1;
+    }
+
+    return (uint8_t)(dur + (factor * 64));
+}
+
+/* Heater encoders that differ from the loops, and decoders that do not give back a value encoding to the same code */
+static double heatr_code_mismatches(const struct bme69x_dev *dev)
+{
+    double mismatches = 0;
+    uint32_t dur;
+    uint16_t temp;
+    uint8_t code;
+
+    for (dur = 0; dur <= UINT16_MAX; dur++)
+    {
+        code = calc_gas_wait((uint16_t)dur);
+        if ((code != ref_gas_wait((uint16_t)dur)) || (calc_gas_wait(calc_gas_wait_ms(code)) != code) ||
+            ((dur < 0xfc0) && (calc_gas_wait_ms(code) > dur)))
+        {
+            mismatches++;
+        }
+
+        code = calc_heatr_dur_shared((uint16_t)dur);
+        if ((code != ref_heatr_dur_shared((uint16_t)dur)) ||
+            (calc_heatr_dur_shared(calc_heatr_dur_shared_ms(code)) != code))
+        {
+            mismatches++;
+        }
+    }
+
+    for (temp = 0; temp <= 400; temp++)
+    {
+        code = calc_res_heat(temp, dev);
+        if ((calc_res_heat(calc_heatr_temp(code, dev), dev) != code) || (calc_heatr_temp(code, dev) > temp))
+        {
+            mismatches++;
+        }
+    }
+
+    return mismatches;
+}
+
+static int check(const char *name, double max_err, double bound, const char *unit)
+{
+    int fail = !(max_err <= bound);
+
+    printf("  %-12s max error %.6g %s (bound %.6g) %s\n", name, max_err, unit, bound, fail ? "FAIL" : "ok");
+
+    return fail;
+}
+
+static int run_calibration(const uint8_t *nvm)
+{
+    struct bme69x_dev dev = { 0 };
+    const struct bme69x_calib_data *c = &dev.calib;
+    test_temp_t t_state;
+    double err_t = 0, err_p = 0, err_h = 0, err_g = 0, err_rh = 0;
+    double ref, e, t;
+    uint32_t adc, adc_end;
+    uint8_t range;
+    uint16_t temp;
+    int fail = 0;
+
+    if (test_nvm_calib(&dev, nvm) != BME69X_OK)
+    {
+        printf("  get_calib_data failed\n");
+
+        return 1;
+    }
+
+    /* Every temperature ADC code of the operating range */
+    for (adc = 0; adc < (UINT32_C(1) << 24); adc++)
+    {
+        ref = ref_temperature(adc, c);
+        if ((ref >= TEST_MIN_T) && (ref <= TEST_MAX_T))
+        {
+            e = fabs(dut_temperature(adc, &dev, &t_state) - ref);
+            err_t = (e > err_t) ? e : err_t;
+        }
+    }
+
+    /* Every pressure and humidity ADC code, at temperatures across the operating range */
+    for (t = TEST_MIN_T; t <= TEST_MAX_T; t += TEST_STEP_T)
+    {
+        adc = adc_lower_bound(ref_temperature_at, t, 0, c);
+        ref = ref_temperature(adc, c);
+        (void)dut_temperature(adc, &dev, &t_state);
+
+        /* Pressure rises with the ADC value, only walk the codes of the operating range */
+        adc_end = adc_lower_bound(ref_pressure, TEST_MAX_P, ref, c);
+        for (adc = adc_lower_bound(ref_pressure, TEST_MIN_P, ref, c); adc < adc_end; adc++)
+        {
+            e = fabs(TEST_OUT_P(calc_pressure(adc, t_state, &dev.calib)) - ref_pressure(adc, ref, c));
+            err_p = (e > err_p) ? e : err_p;
+        }
+
+        for (adc = 0; adc <= UINT16_MAX; adc++)
+        {
+            double h = ref_humidity((uint16_t)adc, ref, c);
+
+            if ((h >= 0.0) && (h <= 100.0))
+            {
+                e = fabs(TEST_OUT_H(calc_humidity((uint16_t)adc, t_state, &dev.calib)) - h);
+                err_h = (e > err_h) ? e : err_h;
+            }
+        }
+    }
+
+    /* Every gas ADC code and range, relative error */
+    for (range = 0; range < 16; range++)
+    {
+        for (adc = 0; adc < 1024; adc++)
+        {
+            ref = 1000000.0 * (double)(UINT32_C(262144) >> range) / (4096.0 + 3.0 * ((double)adc - 512.0));
+            e = fabs((double)calc_gas_resistance((uint16_t)adc, range) - ref) / ref;
+            err_g = (e > err_g) ? e : err_g;
+        }
+    }
+
+    /* Heater set-points, in register codes */
+    for (temp = 200; temp <= 400; temp++)
+    {
+        e = fabs((double)calc_res_heat(temp, &dev) - ref_res_heat(temp, &dev));
+        err_rh = (e > err_rh) ? e : err_rh;
+    }
+
+    fail |= check("temperature", err_t, TEST_MAX_ERR_T, "degC");
+    fail |= check("pressure", err_p, TEST_MAX_ERR_P, "Pa");
+    fail |= check("humidity", err_h, TEST_MAX_ERR_H, "%rH");
+    fail |= check("gas", err_g, TEST_MAX_ERR_G, "relative");
+    fail |= check("res_heat", err_rh, TEST_MAX_ERR_RH, "codes");
+    fail |= check("batch", batch_mismatches(&dev), 0, "mismatches");
+    fail |= check("heatr_lut", heatr_lut_mismatches(&dev), 0, "mismatches");
+    fail |= check("heatr_codes", heatr_code_mismatches(&dev), 0, "mismatches");
+
+    return fail;
+}
+
+int main(void)
+{
+    size_t i;
+    int fail = 0;
+
+#ifdef BME69X_USE_FPU
+    printf("Compensation sweep, floating point path\n");
+#else
+    printf("Compensation sweep, fixed point path\n");
+#endif
+
+    for (i = 0; i < TEST_NVM_COUNT; i++)
+    {
+        printf("Calibration set %u\n", (unsigned)i);
+        fail |= run_calibration(test_nvm_coeff[i]);
+    }
+
+    printf("%s\n", fail ? "FAILED" : "PASSED");
+
+    return fail;
+}
@@ -0,0 +1,190 @@
+/*
+ * Host-side benchmark of decoding and compensating the three data fields of a parallel mode
+ * read, from the raw 51 byte register block to struct bme69x_data. Compares compensate_fields
+ * run on one field at a time, the way the driver used to work, with the single pass over all
+ * three fields that read_all_field_data now makes, and checks that both agree.
+ *
+ * Unlike bme69x_compensation_bench this one is built with inlining enabled: what is measured
+ * is how well the compiler keeps the calibration in registers across the three fields.
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <time.h>
+
+#include "bme69x.c"
+#include "bme69x_test_nvm.h"
+
+/*! Register blocks per run, runs per measurement */
+#define BENCH_N_BLOCKS  1024
+#define BENCH_N_RUNS    512
+
+#define BENCH_LEN_BLOCK (BME69X_LEN_FIELD * BME69X_N_FIELDS)
+
+static uint8_t bench_blocks[BENCH_N_BLOCKS][BENCH_LEN_BLOCK];
+static uint8_t bench_set_val[30];
+static struct bme69x_data bench_out_field[BENCH_N_BLOCKS][BME69X_N_FIELDS];
+static struct bme69x_data bench_out_fused[BENCH_N_BLOCKS][BME69X_N_FIELDS];
+
+static uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/* Register blocks with readings around 25 degC, 1000 hPa and 45 %rH with some spread */
+static void bench_fill(void)
+{
+    uint32_t seed = 12345;
+    uint32_t adc_temp, adc_pres;
+    uint16_t adc_hum, adc_gas;
+    uint8_t *field;
+    uint32_t i, j;
+
+    for (i = 0; i < BENCH_N_BLOCKS; i++)
+    {
+        for (j = 0; j < BME69X_N_FIELDS; j++)
+        {
+            field = &bench_blocks[i][j * BME69X_LEN_FIELD_OFFSET];
+            seed = seed * 1664525u + 1013904223u;
+            adc_temp = 7500000 + (seed >> 12) % 400000;
+            adc_pres = 440000 + (seed >> 8) % 40000;
+            adc_hum = (uint16_t)(50000 + (seed >> 16) % 10000);
+            adc_gas = (uint16_t)((seed >> 4) % 1024);
+
+            field[0] = (uint8_t)(BME69X_NEW_DATA_MSK | ((seed >> 28) % 10));
+            field[1] = (uint8_t)(i * BME69X_N_FIELDS + j);
+            field[2] = (uint8_t)(adc_pres >> 16);
+            field[3] = (uint8_t)(adc_pres >> 8);
+            field[4] = (uint8_t)adc_pres;
+            field[5] = (uint8_t)(adc_temp >> 16);
+            field[6] = (uint8_t)(adc_temp >> 8);
+            field[7] = (uint8_t)adc_temp;
+            field[8] = (uint8_t)(adc_hum >> 8);
+            field[9] = (uint8_t)adc_hum;
+            field[15] = (uint8_t)(adc_gas >> 2);
+            field[16] = (uint8_t)((adc_gas << 6) | BME69X_GASM_VALID_MSK | BME69X_HEAT_STAB_MSK | ((seed >> 24) % 16));
+        }
+    }
+
+    for (i = 0; i < sizeof(bench_set_val); i++)
+    {
+        bench_set_val[i] = (uint8_t)(0x40 + i);
+    }
+}
+
+/* Heater set-point of the fields, as read_all_field_data fills it */
+static void bench_set_point(struct bme69x_data * const data[])
+{
+    uint8_t i;
+
+    for (i = 0; i < BME69X_N_FIELDS; i++)
+    {
+        data[i]->idac = bench_set_val[data[i]->gas_index];
+        data[i]->res_heat = bench_set_val[10 + data[i]->gas_index];
+        data[i]->gas_wait = bench_set_val[20 + data[i]->gas_index];
+    }
+}
+
+/* One field at a time, decoding and storing each result before compensating the next field */
+static void bench_field_by_field(const uint8_t *buff, struct bme69x_data * const data[], const struct bme69x_dev *dev)
+{
+    uint8_t i;
+
+    for (i = 0; i < BME69X_N_FIELDS; i++)
+    {
+        compensate_fields(&buff[i * BME69X_LEN_FIELD_OFFSET], 1, &data[i], &dev->calib);
+    }
+
+    bench_set_point(data);
+}
+
+/* All fields in one pass, as read_all_field_data does */
+static void bench_fused(const uint8_t *buff, struct bme69x_data * const data[], const struct bme69x_dev *dev)
+{
+    compensate_fields(buff, BME69X_N_FIELDS, data, &dev->calib);
+    bench_set_point(data);
+}
+
+/* Best time over the runs, in ns per field */
+static double bench_run(uint8_t fused, const struct bme69x_dev *dev)
+{
+    struct bme69x_data (*out)[BME69X_N_FIELDS] = fused ? bench_out_fused : bench_out_field;
+    struct bme69x_data *field_ptr[BME69X_N_FIELDS];
+    uint64_t start, best = UINT64_MAX;
+    uint32_t run, i;
+
+    for (run = 0; run < BENCH_N_RUNS; run++)
+    {
+        start = bench_now_ns();
+        for (i = 0; i < BENCH_N_BLOCKS; i++)
+        {
+            field_ptr[0] = &out[i][0];
+            field_ptr[1] = &out[i][1];
+            field_ptr[2] = &out[i][2];
+            if (fused)
+            {
+                bench_fused(bench_blocks[i], field_ptr, dev);
+            }
+            else
+            {
+                bench_field_by_field(bench_blocks[i], field_ptr, dev);
+            }
+        }
+
+        start = bench_now_ns() - start;
+        best = (start < best) ? start : best;
+    }
+
+    return (double)best / (BENCH_N_BLOCKS * BME69X_N_FIELDS);
+}
+
+int main(void)
+{
+    struct bme69x_dev dev = { 0 };
+    double field_ns, fused_ns;
+    uint32_t i, j;
+
+    if (test_nvm_calib(&dev, test_nvm_coeff[0]) != BME69X_OK)
+    {
+        printf("get_calib_data failed\n");
+
+        return 1;
+    }
+
+    bench_fill();
+
+    field_ns = bench_run(0, &dev);
+    fused_ns = bench_run(1, &dev);
+
+    for (i = 0; i < BENCH_N_BLOCKS; i++)
+    {
+        for (j = 0; j < BME69X_N_FIELDS; j++)
+        {
+            const struct bme69x_data *a = &bench_out_field[i][j];
+            const struct bme69x_data *b = &bench_out_fused[i][j];
+
+            if ((a->status != b->status) || (a->gas_index != b->gas_index) || (a->meas_index != b->meas_index) ||
+                (a->idac != b->idac) || (a->res_heat != b->res_heat) || (a->gas_wait != b->gas_wait) ||
+                (a->temperature != b->temperature) || (a->pressure != b->pressure) ||
+                (a->humidity != b->humidity) || (a->gas_resistance != b->gas_resistance))
+            {
+                printf("block %u field %u: fused result differs\n", (unsigned)i, (unsigned)j);
+
+                return 1;
+            }
+        }
+    }
+
+#ifdef BME69X_USE_FPU
+    printf("floating point fields: field by field %.1f ns/sample, fused %.1f ns/sample\n", field_ns, fused_ns);
+#else
+    printf("fixed point fields:    field by field %.1f ns/sample, fused %.1f ns/sample\n", field_ns, fused_ns);
+#endif
+
+    return 0;
+}
@@ -0,0 +1,137 @@
+/*
+ * Host-side benchmark of the heater resistance lookup table: the cost of filling it, and of
+ * building the heater register writes of bme69x_set_heatr_conf when an application cycles
+ * between four sequential mode profiles, with and without the table. Built like
+ * bme69x_compensation_bench, with calc_res_heat kept out of line.
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <time.h>
+
+#include "bme69x.c"
+#include "bme69x_test_nvm.h"
+
+/*! Configurations built per run, runs per measurement */
+#define BENCH_N_CONF    4096
+#define BENCH_N_RUNS    64
+
+/*! Heater profiles cycled through */
+#define BENCH_N_PROF    4
+
+static uint16_t bench_temp_prof[BENCH_N_PROF][10];
+static uint16_t bench_dur_prof[BENCH_N_PROF][10];
+static struct bme69x_heatr_conf bench_conf[BENCH_N_PROF];
+
+static uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/* Ten step profiles between 200 and 400 degC */
+static void bench_fill(void)
+{
+    uint8_t i, j;
+
+    for (i = 0; i < BENCH_N_PROF; i++)
+    {
+        for (j = 0; j < 10; j++)
+        {
+            bench_temp_prof[i][j] = (uint16_t)(200 + (i * 37 + j * 19) % 201);
+            bench_dur_prof[i][j] = (uint16_t)(100 + j * 10);
+        }
+
+        bench_conf[i].enable = BME69X_ENABLE;
+        bench_conf[i].heatr_temp_prof = bench_temp_prof[i];
+        bench_conf[i].heatr_dur_prof = bench_dur_prof[i];
+        bench_conf[i].profile_len = 10;
+    }
+}
+
+/* Best time over the runs, in ns per configuration, and the XOR of all register values in check */
+static double bench_run(struct bme69x_dev *dev, uint8_t *check)
+{
+    uint8_t reg_addr[BME69X_LEN_SHADOW];
+    uint8_t reg_data[BME69X_LEN_SHADOW];
+    uint8_t nb_conv, len, k;
+    uint64_t start, best = UINT64_MAX;
+    uint32_t run, i;
+
+    *check = 0;
+    for (run = 0; run < BENCH_N_RUNS; run++)
+    {
+        start = bench_now_ns();
+        for (i = 0; i < BENCH_N_CONF; i++)
+        {
+            (void)set_conf(&bench_conf[i % BENCH_N_PROF], BME69X_SEQUENTIAL_MODE, &nb_conv, reg_addr, reg_data,
+                           &len, dev);
+            for (k = 0; k < len; k++)
+            {
+                *check ^= reg_data[k];
+            }
+        }
+
+        start = bench_now_ns() - start;
+        best = (start < best) ? start : best;
+    }
+
+    return (double)best / BENCH_N_CONF;
+}
+
+int main(void)
+{
+    struct bme69x_dev dev = { 0 };
+    struct bme69x_heatr_lut lut = { { 0 }, 0, 0 };
+    uint64_t start, best = UINT64_MAX;
+    double calc_ns, lut_ns;
+    uint8_t calc_check, lut_check;
+    uint32_t run;
+
+    if (test_nvm_calib(&dev, test_nvm_coeff[0]) != BME69X_OK)
+    {
+        printf("get_calib_data failed\n");
+
+        return 1;
+    }
+
+    bench_fill();
+    dev.amb_temp = 25;
+
+    calc_ns = bench_run(&dev, &calc_check);
+
+    /* Table fill, forced by invalidating the table before each lookup */
+    dev.heatr_lut = &lut;
+    for (run = 0; run < BENCH_N_RUNS * 16; run++)
+    {
+        lut.valid = 0;
+        start = bench_now_ns();
+        (void)get_res_heat(300, &dev);
+        start = bench_now_ns() - start;
+        best = (start < best) ? start : best;
+    }
+
+    lut_ns = bench_run(&dev, &lut_check);
+
+    if (lut_check != calc_check)
+    {
+        printf("heater codes from the table differ\n");
+
+        return 1;
+    }
+
+#ifdef BME69X_USE_FPU
+    printf("floating point heater: table fill %.0f ns, 10 step profile %.1f ns calculated, %.1f ns from the table\n",
+#else
+    printf("fixed point heater:    table fill %.0f ns, 10 step profile %.1f ns calculated, %.1f ns from the table\n",
+#endif
+           (double)best,
+           calc_ns,
+           lut_ns);
+
+    return 0;
+}
@@ -0,0 +1,398 @@
+#include <string.h>
+
+#include "bme69x_sim.h"
+
+/******************************************************************************/
+/*!                 Macro definitions                                         */
+
+/*! Chip ID, variant and unique ID reported by the model */
+#define SIM_VARIANT_ID    BME690_VARIANT_GAS_HIGH
+#define SIM_REG_UNIQUE_ID BME69X_REG_UNIQUE_ID
+
+/*! Offset of the status, gas and meas_index bytes within a field */
+#define SIM_FIELD_STATUS  0
+#define SIM_FIELD_MEAS    1
+#define SIM_FIELD_GAS_L   16
+
+/*! Calibration coefficients of the model, in NVM order: 0x8a (23), 0xe1 (14), 0x00 (5) */
+static const uint8_t sim_coeff[BME69X_LEN_COEFF_ALL] = {
+    /* 0x8a: par_t2, par_t3, -, par_p5, par_p6, par_p7, par_p8, par_p1, par_p2, par_p3, par_p4 */
+    0x84, 0x67, 0x03, 0x00, 0x50, 0x44, 0xb0, 0x3f, 0x1e, 0xf6, 0xd4, 0x30, 0x2c, 0x01, 0x1a, 0x02,
+    /* -, -, par_p9, par_p10, par_p11, - */
+    0x00, 0x00, 0x48, 0x0d, 0x1c, 0xf8, 0x00,
+
+    /* 0xe1: par_h5 / par_h1 (12 bit each), par_h2, par_h4, par_h3, par_h6, - */
+    0x12, 0xc7, 0x2b, 0xfb, 0x0a, 0x1c, 0x3c, 0x00,
+    /* par_t1, par_g2, par_g1, par_g3 */
+    0x90, 0x65, 0xd0, 0xe8, 0xe2, 0x12,
+
+    /* 0x00: res_heat_val, -, res_heat_range, -, range_sw_err */
+    0x28, 0x00, 0x10, 0x00, 0x10
+};
+
+/*! Oversampling setting to measurement cycles */
+static const uint8_t sim_os_cycles[8] = { 0, 1, 2, 4, 8, 16, 16, 16 };
+
+/*! Standby time of the ODR settings in microseconds */
+static const uint32_t sim_odr_us[8] = { 590, 62500, 125000, 250000, 500000, 1000000, 10000, 20000 };
+
+/******************************************************************************/
+/*!                 Static functions                                          */
+
+/* Duration of the gas_wait register encoding in microseconds */
+static uint32_t sim_gas_wait_us(uint8_t code)
+{
+    return (uint32_t)(code & 0x3f) * (UINT32_C(1) << (2 * (code >> 6))) * 1000;
+}
+
+/* Duration of the shared heater duration register encoding in microseconds */
+static uint32_t sim_shd_heatr_us(uint8_t code)
+{
+    return (uint32_t)(code & 0x3f) * (UINT32_C(1) << (2 * (code >> 6))) * 477;
+}
+
+/* Temperature, pressure and humidity conversion time in microseconds */
+static uint32_t sim_tph_us(const struct bme69x_sim *sim, uint8_t mode)
+{
+    uint8_t ctrl_meas = sim->regs[BME69X_REG_CTRL_MEAS];
+    uint32_t cycles;
+    uint32_t dur;
+
+    cycles = sim_os_cycles[ctrl_meas >> 5];
+    cycles += sim_os_cycles[(ctrl_meas >> 2) & 0x07];
+    cycles += sim_os_cycles[sim->regs[BME69X_REG_CTRL_HUM] & 0x07];
+
+    dur = cycles * 1963 + 477 * 4 + 477 * 5;
+    if (mode != BME69X_PARALLEL_MODE)
+    {
+        dur += 1000;
+    }
+
+    return dur;
+}
+
+/* Heater enabled and gas conversion requested */
+static int sim_gas_on(const struct bme69x_sim *sim)
+{
+    return !(sim->regs[BME69X_REG_CTRL_GAS_0] & BME69X_HCTRL_MSK) &&
+           (sim->regs[BME69X_REG_CTRL_GAS_1] & (BME69X_ENABLE_GAS_MEAS << BME69X_RUN_GAS_POS));
+}
+
+/* Number of steps in the heater profile */
+static uint8_t sim_n_steps(const struct bme69x_sim *sim)
+{
+    uint8_t nb_conv = sim->regs[BME69X_REG_CTRL_GAS_1] & BME69X_NBCONV_MSK;
+
+    return (nb_conv == 0) ? 1 : nb_conv;
+}
+
+/* Standby time between two cycles of a sequential profile */
+static uint32_t sim_odr_standby_us(const struct bme69x_sim *sim)
+{
+    if (sim->regs[BME69X_REG_CTRL_GAS_1] & BME69X_ODR3_MSK)
+    {
+        return 0;
+    }
+
+    return sim_odr_us[sim->regs[BME69X_REG_CONFIG] >> 5];
+}
+
+/* Stores the result of the finished step in the next field slot */
+static void sim_store_field(struct bme69x_sim *sim)
+{
+    uint8_t *field = &sim->regs[BME69X_REG_FIELD0 + sim->slot * BME69X_LEN_FIELD_OFFSET];
+    uint8_t gas_range;
+
+    if (field[SIM_FIELD_STATUS] & BME69X_NEW_DATA_MSK)
+    {
+        sim->n_overwritten++;
+    }
+
+    memset(field, 0, BME69X_LEN_FIELD);
+    field[SIM_FIELD_STATUS] = BME69X_NEW_DATA_MSK | (sim->step & BME69X_GAS_INDEX_MSK);
+    field[SIM_FIELD_MEAS] = sim->meas_index;
+    field[2] = (uint8_t)(sim->adc_pres >> 16);
+    field[3] = (uint8_t)(sim->adc_pres >> 8);
+    field[4] = (uint8_t)sim->adc_pres;
+    field[5] = (uint8_t)(sim->adc_temp >> 16);
+    field[6] = (uint8_t)(sim->adc_temp >> 8);
+    field[7] = (uint8_t)sim->adc_temp;
+    field[8] = (uint8_t)(sim->adc_hum >> 8);
+    field[9] = (uint8_t)sim->adc_hum;
+    if (sim_gas_on(sim))
+    {
+        /* A cooler heater leaves the metal oxide at a higher resistance */
+        gas_range = sim->gas_range;
+        if ((sim->regs[BME69X_REG_RES_HEAT0 + sim->step] < sim->res_heat_cold) && (gas_range > 0))
+        {
+            gas_range--;
+        }
+
+        field[15] = (uint8_t)(sim->adc_gas >> 2);
+        field[SIM_FIELD_GAS_L] = (uint8_t)((sim->adc_gas & 0x03) << 6) | BME69X_GASM_VALID_MSK |
+                                 BME69X_HEAT_STAB_MSK | (gas_range & BME69X_GAS_RANGE_MSK);
+        sim->regs[BME69X_REG_IDAC_HEAT0 + sim->step] = sim->idac;
+    }
+
+    sim->done_log[sim->meas_index] = sim->done_us;
+    sim->meas_index++;
+    sim->slot = (uint8_t)((sim->slot + 1) % 3);
+    sim->n_fields++;
+}
+
+/* Switches the running mode and schedules the first step */
+static void sim_set_mode(struct bme69x_sim *sim, uint8_t mode)
+{
+    sim->mode = mode;
+    sim->step = 0;
+    sim->regs[BME69X_REG_CTRL_MEAS] = (uint8_t)((sim->regs[BME69X_REG_CTRL_MEAS] & ~BME69X_MODE_MSK) | mode);
+    if (mode == BME69X_FORCED_MODE)
+    {
+        /* A new forced measurement always lands in field 0 */
+        sim->slot = 0;
+        sim->regs[BME69X_REG_FIELD0] &= (uint8_t)~BME69X_NEW_DATA_MSK;
+    }
+
+    if (mode != BME69X_SLEEP_MODE)
+    {
+        sim->done_us = sim->now_us + bme69x_sim_step_dur(sim, mode, 0);
+    }
+}
+
+/* Applies a register write */
+static void sim_write_reg(struct bme69x_sim *sim, uint8_t reg, uint8_t val)
+{
+    if (reg == BME69X_REG_SOFT_RESET)
+    {
+        if (val == BME69X_SOFT_RESET_CMD)
+        {
+            memset(&sim->regs[BME69X_REG_FIELD0], 0, BME69X_REG_CONFIG + 1 - BME69X_REG_FIELD0);
+            sim->mode = BME69X_SLEEP_MODE;
+            sim->slot = 0;
+        }
+
+        return;
+    }
+
+    sim->regs[reg] = val;
+    if ((reg == BME69X_REG_CTRL_MEAS) && ((val & BME69X_MODE_MSK) != sim->mode))
+    {
+        sim_set_mode(sim, val & BME69X_MODE_MSK);
+    }
+}
+
+/* Register addressed by a transfer: on SPI the memory page selects the upper or lower half of the
+ * map, except for the status register which is visible on both */
+static uint32_t sim_reg(const struct bme69x_sim *sim, uint8_t addr)
+{
+    uint8_t addr7 = addr & BME69X_SPI_WR_MSK;
+
+    if (!sim->spi)
+    {
+        return addr;
+    }
+
+    if (addr7 == (BME69X_REG_MEM_PAGE & BME69X_SPI_WR_MSK))
+    {
+        return addr7;
+    }
+
+    return (sim->regs[BME69X_REG_MEM_PAGE & BME69X_SPI_WR_MSK] & BME69X_MEM_PAGE_MSK) ? addr7 : (addr7 | 0x80U);
+}
+
+/* Charges a transfer of len bytes to the virtual clock */
+static void sim_bus_time(struct bme69x_sim *sim, uint32_t len)
+{
+    if (sim->bus_hz)
+    {
+        /* 9 clocks per byte plus start and stop conditions */
+        bme69x_sim_advance(sim, ((uint64_t)(len * 9 + 2) * 1000000) / sim->bus_hz);
+    }
+}
+
+/******************************************************************************/
+/*!                 User interface functions                                  */
+
+void bme69x_sim_init(struct bme69x_sim *sim)
+{
+    memset(sim, 0, sizeof(*sim));
+    memcpy(&sim->regs[BME69X_REG_COEFF1], sim_coeff, BME69X_LEN_COEFF1);
+    memcpy(&sim->regs[BME69X_REG_COEFF2], &sim_coeff[BME69X_LEN_COEFF1], BME69X_LEN_COEFF2);
+    memcpy(&sim->regs[BME69X_REG_COEFF3], &sim_coeff[BME69X_LEN_COEFF1 + BME69X_LEN_COEFF2], BME69X_LEN_COEFF3);
+    sim->regs[BME69X_REG_CHIP_ID] = BME69X_CHIP_ID;
+    sim->regs[BME69X_REG_VARIANT_ID] = SIM_VARIANT_ID;
+    sim->regs[SIM_REG_UNIQUE_ID] = 0x5a;
+    sim->regs[SIM_REG_UNIQUE_ID + 1] = 0x17;
+    sim->regs[SIM_REG_UNIQUE_ID + 2] = 0x42;
+    sim->regs[SIM_REG_UNIQUE_ID + 3] = 0x69;
+
+    /* Roughly 25 degC, 1000 hPa, 45 %rH and a few 10 kOhm */
+    sim->adc_temp = 7680000;
+    sim->adc_pres = 460000;
+    sim->adc_hum = 55000;
+    sim->adc_gas = 600;
+    sim->gas_range = 4;
+    sim->idac = 0x40;
+}
+
+void bme69x_sim_attach(struct bme69x_sim *sim, struct bme69x_dev *dev)
+{
+    memset(dev, 0, sizeof(*dev));
+    dev->intf = sim->spi ? BME69X_SPI_INTF : BME69X_I2C_INTF;
+    dev->read = bme69x_sim_read;
+    dev->write = bme69x_sim_write;
+    dev->delay_us = bme69x_sim_delay_us;
+    dev->get_time_us = bme69x_sim_get_time_us;
+    dev->intf_ptr = sim;
+    dev->amb_temp = 25;
+}
+
+void bme69x_sim_reset_stats(struct bme69x_sim *sim)
+{
+    sim->n_reads = 0;
+    sim->n_writes = 0;
+    sim->bytes_read = 0;
+    sim->bytes_written = 0;
+}
+
+uint32_t bme69x_sim_step_dur(const struct bme69x_sim *sim, uint8_t mode, uint8_t step)
+{
+    uint32_t dur = sim_tph_us(sim, mode);
+    uint8_t gas_wait = sim->regs[BME69X_REG_GAS_WAIT0 + step];
+
+    switch (mode)
+    {
+        case BME69X_FORCED_MODE:
+        case BME69X_SEQUENTIAL_MODE:
+            if (sim_gas_on(sim))
+            {
+                dur += sim_gas_wait_us(gas_wait);
+            }
+
+            break;
+        case BME69X_PARALLEL_MODE:
+            /* The heater holds the step for gas_wait TPHG cycles of shared heater duration each */
+            dur += sim_shd_heatr_us(sim->regs[BME69X_REG_SHD_HEATR_DUR]);
+            dur *= (gas_wait == 0) ? 1 : gas_wait;
+            break;
+        default:
+            break;
+    }
+
+    return dur;
+}
+
+void bme69x_sim_advance(struct bme69x_sim *sim, uint64_t period_us)
+{
+    uint64_t target = sim->now_us + period_us;
+
+    while ((sim->mode != BME69X_SLEEP_MODE) && (sim->done_us <= target))
+    {
+        sim->now_us = sim->done_us;
+        sim_store_field(sim);
+
+        if (sim->mode == BME69X_FORCED_MODE)
+        {
+            sim->mode = BME69X_SLEEP_MODE;
+            sim->regs[BME69X_REG_CTRL_MEAS] &= (uint8_t)~BME69X_MODE_MSK;
+        }
+        else
+        {
+            sim->step = (uint8_t)((sim->step + 1) % sim_n_steps(sim));
+            sim->done_us = sim->now_us + bme69x_sim_step_dur(sim, sim->mode, sim->step);
+            if ((sim->mode == BME69X_SEQUENTIAL_MODE) && (sim->step == 0))
+            {
+                /* The sensor stands by after the last step, before it starts the profile again */
+                sim->done_us += sim_odr_standby_us(sim);
+            }
+        }
+    }
+
+    sim->now_us = target;
+}
+
+BME69X_INTF_RET_TYPE bme69x_sim_read(uint8_t reg_addr, uint8_t *reg_data, uint32_t len, void *intf_ptr)
+{
+    struct bme69x_sim *sim = (struct bme69x_sim *)intf_ptr;
+    uint32_t i;
+    uint32_t reg;
+    uint32_t start;
+
+    if (sim->spi && !(reg_addr & BME69X_SPI_RD_MSK))
+    {
+        /* SPI reads have the read bit set */
+        return -1;
+    }
+
+    start = sim_reg(sim, reg_addr);
+    sim_bus_time(sim, len + 3);
+    sim->n_reads++;
+    sim->bytes_read += len;
+
+    for (i = 0; i < len; i++)
+    {
+        reg = start + i;
+        if (reg >= BME69X_SIM_N_REGS)
+        {
+            return -1;
+        }
+
+        reg_data[i] = sim->regs[reg];
+    }
+
+    /* The new data flag of a field is cleared once its status byte has been read */
+    for (i = 0; i < 3; i++)
+    {
+        reg = BME69X_REG_FIELD0 + i * BME69X_LEN_FIELD_OFFSET;
+        if ((reg >= start) && (reg < start + len))
+        {
+            sim->regs[reg] &= (uint8_t)~BME69X_NEW_DATA_MSK;
+        }
+    }
+
+    return BME69X_INTF_RET_SUCCESS;
+}
+
+BME69X_INTF_RET_TYPE bme69x_sim_write(uint8_t reg_addr, const uint8_t *reg_data, uint32_t len, void *intf_ptr)
+{
+    struct bme69x_sim *sim = (struct bme69x_sim *)intf_ptr;
+    uint32_t i;
+
+    if ((len == 0) || ((len % 2) == 0))
+    {
+        /* Writes are register address and data pairs */
+        return -1;
+    }
+
+    sim_bus_time(sim, len + 2);
+    sim->n_writes++;
+    sim->bytes_written += len + 1;
+
+    for (i = 0; i < len; i += 2)
+    {
+        if (sim->spi && (((i == 0) ? reg_addr : reg_data[i - 1]) & BME69X_SPI_RD_MSK))
+        {
+            /* SPI writes have the read bit cleared */
+            return -1;
+        }
+    }
+
+    /* On SPI a write to the memory page register applies to the following pairs */
+    sim_write_reg(sim, (uint8_t)sim_reg(sim, reg_addr), reg_data[0]);
+    for (i = 1; i < len; i += 2)
+    {
+        sim_write_reg(sim, (uint8_t)sim_reg(sim, reg_data[i]), reg_data[i + 1]);
+    }
+
+    return BME69X_INTF_RET_SUCCESS;
+}
+
+void bme69x_sim_delay_us(uint32_t period, void *intf_ptr)
+{
+    bme69x_sim_advance((struct bme69x_sim *)intf_ptr, period);
+}
+
+uint64_t bme69x_sim_get_time_us(void *intf_ptr)
+{
+    return ((struct bme69x_sim *)intf_ptr)->now_us;
+}
@@ -0,0 +1,125 @@
+#ifndef BME69X_SIM_H_
+#define BME69X_SIM_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif /*__cplusplus */
+
+#include "bme69x.h"
+
+/*! Size of the simulated register map, both SPI pages flattened to the I2C address space */
+#define BME69X_SIM_N_REGS  256
+
+/*!
+ * @brief Register-level model of a BME690 with a virtual clock
+ *
+ * The model keeps the register map, the calibration NVM, the three field slots with their
+ * rolling meas_index and runs forced, parallel and sequential mode measurements against a
+ * virtual clock advanced by bus transfers and bme69x_sim_delay_us.
+ *
+ * It models the I2C interface, or the SPI interface with its two memory pages of 7 bit
+ * addresses when spi is set before bme69x_sim_attach. Conversion times follow the datasheet figures the driver
+ * uses. A parallel mode step holds its heater set-point for gas_wait TPHG cycles of the shared
+ * heater duration and stores one field at its end. Status bytes lose their new data flag once read.
+ */
+struct bme69x_sim
+{
+    /*! Register map */
+    uint8_t regs[BME69X_SIM_N_REGS];
+
+    /*! Virtual time in microseconds */
+    uint64_t now_us;
+
+    /*! Bus clock used to charge transfers to the virtual clock, 0 for free transfers */
+    uint32_t bus_hz;
+
+    /*! Non-zero to model the SPI interface */
+    uint8_t spi;
+
+    /*! Raw temperature, pressure and humidity ADC values reported by every measurement */
+    uint32_t adc_temp;
+    uint32_t adc_pres;
+    uint16_t adc_hum;
+
+    /*! Raw gas ADC value and range reported by every gas measurement */
+    uint16_t adc_gas;
+    uint8_t gas_range;
+
+    /*! Heater current the sensor settles at and stores in the idac register of the step, 0 for a broken heater */
+    uint8_t idac;
+
+    /*! Steps with a res_heat code below this read one gas range lower, twice the resistance. 0 to disable */
+    uint8_t res_heat_cold;
+
+    /*! Mode currently running, BME69X_SLEEP_MODE when idle */
+    uint8_t mode;
+
+    /*! Profile step of the measurement in progress */
+    uint8_t step;
+
+    /*! Field slot the next measurement is stored in */
+    uint8_t slot;
+
+    /*! Sub-measurement index of the next measurement */
+    uint8_t meas_index;
+
+    /*! Virtual time the measurement in progress completes */
+    uint64_t done_us;
+
+    /*! Completion time of every finished step, indexed by meas_index */
+    uint64_t done_log[256];
+
+    /*! Bus statistics */
+    uint32_t n_reads;
+    uint32_t n_writes;
+    uint32_t bytes_read;
+    uint32_t bytes_written;
+
+    /*! Fields completed and fields overwritten before being read */
+    uint32_t n_fields;
+    uint32_t n_overwritten;
+};
+
+/*!
+ * @brief Powers up the model: default calibration, reset register values and zeroed clock.
+ */
+void bme69x_sim_init(struct bme69x_sim *sim);
+
+/*!
+ * @brief Links a device structure to the model through its read, write, delay and time callbacks.
+ */
+void bme69x_sim_attach(struct bme69x_sim *sim, struct bme69x_dev *dev);
+
+/*!
+ * @brief Clears the bus statistics.
+ */
+void bme69x_sim_reset_stats(struct bme69x_sim *sim);
+
+/*!
+ * @brief Advances the virtual clock, completing any measurement that ends before the new time.
+ */
+void bme69x_sim_advance(struct bme69x_sim *sim, uint64_t period_us);
+
+/*!
+ * @brief Duration of one profile step in microseconds, as the model runs it. A sequential profile
+ * stands by for the ODR time on top of it before starting the next cycle.
+ */
+uint32_t bme69x_sim_step_dur(const struct bme69x_sim *sim, uint8_t mode, uint8_t step);
+
+/*! bme69x_read_fptr_t of the model, intf_ptr is the struct bme69x_sim */
+BME69X_INTF_RET_TYPE bme69x_sim_read(uint8_t reg_addr, uint8_t *reg_data, uint32_t len, void *intf_ptr);
+
+/*! bme69x_write_fptr_t of the model, intf_ptr is the struct bme69x_sim */
+BME69X_INTF_RET_TYPE bme69x_sim_write(uint8_t reg_addr, const uint8_t *reg_data, uint32_t len, void *intf_ptr);
+
+/*! bme69x_delay_us_fptr_t of the model, advances the virtual clock */
+void bme69x_sim_delay_us(uint32_t period, void *intf_ptr);
+
+/*! bme69x_get_time_us_fptr_t of the model, returns the virtual clock */
+uint64_t bme69x_sim_get_time_us(void *intf_ptr);
+
+#ifdef __cplusplus
+}
+#endif /*__cplusplus */
+
+#endif /* BME69X_SIM_H_ */
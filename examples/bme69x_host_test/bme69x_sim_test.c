@@ -0,0 +1,1145 @@
+/*
+ * Regression tests of the driver against the register-level model: results, bus
+ * transaction counts and latency of the main use cases.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "bme69x.h"
+#include "bme69x_sim.h"
+
+/*! I2C fast mode, used to charge the transfers to the virtual clock */
+#define TEST_BUS_HZ  UINT32_C(400000)
+
+#define CHECK(cond)                                                    \
+    do                                                                 \
+    {                                                                  \
+        if (!(cond))                                                   \
+        {                                                              \
+            printf("  %s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            test_failed++;                                             \
+        }                                                              \
+    } while (0)
+
+#define CHECK_BUS(reads, writes)                                       \
+    do                                                                 \
+    {                                                                  \
+        CHECK(sim.n_reads == (uint32_t)(reads));                       \
+        CHECK(sim.n_writes == (uint32_t)(writes));                     \
+        bme69x_sim_reset_stats(&sim);                                  \
+    } while (0)
+
+static struct bme69x_sim sim;
+static struct bme69x_dev dev;
+
+/*! Sensors sharing one bus in the scheduler test */
+#define TEST_SCHED_N  8
+
+/*! Sensors on a shared bus: every model follows one virtual clock, and a transfer of any of them takes bus time */
+static struct bme69x_sim bus_sim[TEST_SCHED_N];
+static struct bme69x_dev bus_dev[TEST_SCHED_N];
+static uint64_t bus_now_us;
+static int test_failed;
+
+static void test_setup(void)
+{
+    bme69x_sim_init(&sim);
+    sim.bus_hz = TEST_BUS_HZ;
+    bme69x_sim_attach(&sim, &dev);
+}
+
+/* Forced mode configuration of the examples */
+static void test_forced_conf(struct bme69x_conf *conf, struct bme69x_heatr_conf *heatr_conf)
+{
+    conf->filter = BME69X_FILTER_OFF;
+    conf->odr = BME69X_ODR_NONE;
+    conf->os_hum = BME69X_OS_16X;
+    conf->os_pres = BME69X_OS_1X;
+    conf->os_temp = BME69X_OS_2X;
+
+    heatr_conf->enable = BME69X_ENABLE;
+    heatr_conf->heatr_temp = 300;
+    heatr_conf->heatr_dur = 100;
+}
+
+static void test_init(void)
+{
+    CHECK(bme69x_init(&dev) == BME69X_OK);
+    CHECK(dev.chip_id == BME69X_CHIP_ID);
+    CHECK(dev.variant_id == BME690_VARIANT_GAS_HIGH);
+    CHECK(dev.calib.par_t1 == 26000);
+    CHECK(dev.calib.par_t2 == 26500);
+    CHECK(dev.calib.par_p1 == 12500);
+    CHECK(dev.calib.par_h1 == 695);
+    CHECK(dev.calib.par_h5 == 300);
+    CHECK(dev.calib.par_g2 == -5936);
+
+    /* Soft reset, chip ID, variant ID, three calibration blocks and the control registers */
+    CHECK_BUS(6, 1);
+}
+
+static void test_forced(void)
+{
+    struct bme69x_conf conf = { 0 };
+    struct bme69x_heatr_conf heatr_conf = { 0 };
+    struct bme69x_heatr_conf readback = { 0 };
+    struct bme69x_data data = { 0 };
+    uint8_t n_data = 0;
+    uint32_t period;
+    uint64_t start;
+    int i;
+
+    CHECK(bme69x_init(&dev) == BME69X_OK);
+    test_forced_conf(&conf, &heatr_conf);
+    bme69x_sim_reset_stats(&sim);
+
+    /* The sensor is known to be asleep, no read-back */
+    CHECK(bme69x_set_conf(&conf, &dev) == BME69X_OK);
+    CHECK_BUS(0, 1);
+    CHECK(bme69x_set_heatr_conf(BME69X_FORCED_MODE, &heatr_conf, &dev) == BME69X_OK);
+    CHECK_BUS(0, 1);
+
+    /* Unchanged configurations are not written again */
+    CHECK(bme69x_set_conf(&conf, &dev) == BME69X_OK);
+    CHECK(bme69x_set_heatr_conf(BME69X_FORCED_MODE, &heatr_conf, &dev) == BME69X_OK);
+    CHECK_BUS(0, 0);
+
+    /* Read back in degC and ms from the shadow registers, one heater code covers about 4 degC */
+    readback.heatr_temp = 0;
+    readback.heatr_dur = 0;
+    CHECK(bme69x_get_heatr_conf(BME69X_FORCED_MODE, &readback, &dev) == BME69X_OK);
+    CHECK_BUS(0, 0);
+    CHECK(readback.enable == BME69X_ENABLE);
+    CHECK((readback.heatr_temp <= 300) && (readback.heatr_temp > 295));
+    CHECK(readback.heatr_dur == 100);
+
+    period = bme69x_get_meas_dur(BME69X_FORCED_MODE, &conf, &dev) + (uint32_t)heatr_conf.heatr_dur * 1000;
+    CHECK(period == bme69x_sim_step_dur(&sim, BME69X_FORCED_MODE, 0));
+
+    for (i = 0; i < 10; i++)
+    {
+        start = sim.now_us;
+        CHECK(bme69x_set_op_mode(BME69X_FORCED_MODE, &dev) == BME69X_OK);
+        dev.delay_us(period, dev.intf_ptr);
+        CHECK(bme69x_get_data(BME69X_FORCED_MODE, &data, &n_data, &dev) == BME69X_OK);
+
+        /* One write to trigger, one burst read of the field and its heater set-points */
+        CHECK_BUS(1, 1);
+        CHECK(n_data == 1);
+        CHECK(data.status == (BME69X_NEW_DATA_MSK | BME69X_GASM_VALID_MSK | BME69X_HEAT_STAB_MSK));
+        CHECK(data.meas_index == i);
+        CHECK(sim.done_log[i] - start < period + 1000);
+    }
+
+#ifdef BME69X_USE_FPU
+    CHECK((data.temperature > 20) && (data.temperature < 30));
+    CHECK((data.pressure > 95000) && (data.pressure < 105000));
+    CHECK((data.humidity > 20) && (data.humidity < 80));
+#else
+    CHECK((data.temperature > 2000) && (data.temperature < 3000));
+    CHECK((data.pressure > 95000) && (data.pressure < 105000));
+    CHECK((data.humidity > 20000) && (data.humidity < 80000));
+#endif
+    CHECK(data.res_heat == sim.regs[BME69X_REG_RES_HEAT0]);
+    CHECK(data.gas_wait == sim.regs[BME69X_REG_GAS_WAIT0]);
+    CHECK(sim.n_overwritten == 0);
+}
+
+static void test_forced_nonblocking(void)
+{
+    struct bme69x_conf conf = { 0 };
+    struct bme69x_heatr_conf heatr_conf = { 0 };
+    struct bme69x_data data = { 0 };
+    uint8_t n_data = 0;
+    uint64_t ready_us = 0;
+
+    CHECK(bme69x_init(&dev) == BME69X_OK);
+    test_forced_conf(&conf, &heatr_conf);
+    CHECK(bme69x_set_conf(&conf, &dev) == BME69X_OK);
+    CHECK(bme69x_set_heatr_conf(BME69X_FORCED_MODE, &heatr_conf, &dev) == BME69X_OK);
+    bme69x_sim_reset_stats(&sim);
+
+    CHECK(bme69x_trigger_forced(&conf, &heatr_conf, &ready_us, &dev) == BME69X_OK);
+    CHECK_BUS(0, 1);
+
+    /* The predicted ready time is exact */
+    CHECK(ready_us == sim.done_us);
+
+    CHECK(bme69x_try_collect(&data, &n_data, &dev) == BME69X_W_NO_NEW_DATA);
+    CHECK(n_data == 0);
+    CHECK_BUS(1, 0);
+
+    bme69x_sim_advance(&sim, ready_us - sim.now_us);
+    CHECK(bme69x_try_collect(&data, &n_data, &dev) == BME69X_OK);
+    CHECK(n_data == 1);
+    CHECK_BUS(1, 0);
+
+    /* The sensor went back to sleep by itself, the next trigger needs no read-back */
+    CHECK(bme69x_trigger_forced(&conf, &heatr_conf, &ready_us, &dev) == BME69X_OK);
+    CHECK_BUS(0, 1);
+}
+
+/* Runs a profile mode for a while and checks that every step is read in order */
+static void test_profile(uint8_t op_mode)
+{
+    struct bme69x_conf conf = { 0 };
+    struct bme69x_heatr_conf heatr_conf = { 0 };
+    struct bme69x_data data[3];
+    uint16_t temp_prof[10] = { 320, 100, 100, 100, 200, 200, 200, 320, 320, 320 };
+    uint16_t dur_prof[10] = { 5, 2, 10, 30, 5, 5, 5, 5, 5, 5 };
+    uint16_t temp_back[10] = { 0 };
+    uint16_t dur_back[10] = { 0 };
+    struct bme69x_heatr_conf readback = { 0 };
+    uint8_t n_data, i;
+    uint8_t next_index = 0;
+    uint32_t n_fields = 0;
+    uint32_t poll;
+    int loop;
+
+    CHECK(bme69x_init(&dev) == BME69X_OK);
+    test_forced_conf(&conf, &heatr_conf);
+    if (op_mode == BME69X_SEQUENTIAL_MODE)
+    {
+        for (i = 0; i < 10; i++)
+        {
+            dur_prof[i] *= 20;
+        }
+    }
+
+    CHECK(bme69x_set_conf(&conf, &dev) == BME69X_OK);
+    heatr_conf.heatr_temp_prof = temp_prof;
+    heatr_conf.heatr_dur_prof = dur_prof;
+    heatr_conf.profile_len = 10;
+    heatr_conf.shared_heatr_dur =
+        (uint16_t)(140 - (bme69x_get_meas_dur(BME69X_PARALLEL_MODE, &conf, &dev) / 1000));
+    bme69x_sim_reset_stats(&sim);
+    CHECK(bme69x_set_heatr_conf(op_mode, &heatr_conf, &dev) == BME69X_OK);
+
+    /* The whole profile, the shared heater duration and CTRL_GAS_0/1 go in one write */
+    CHECK_BUS(0, 1);
+
+    /* Read back in the units of the set call, durations are rounded down to the register step */
+    readback.heatr_temp_prof = temp_back;
+    readback.heatr_dur_prof = dur_back;
+    readback.profile_len = 10;
+    CHECK(bme69x_get_heatr_conf(op_mode, &readback, &dev) == BME69X_OK);
+    CHECK_BUS(0, 0);
+    CHECK(readback.enable == BME69X_ENABLE);
+    for (i = 0; i < 10; i++)
+    {
+        CHECK((temp_back[i] <= temp_prof[i]) && (temp_back[i] + 5 > temp_prof[i]));
+        CHECK((dur_back[i] <= dur_prof[i]) && (dur_back[i] + dur_prof[i] / 16 >= dur_prof[i]));
+    }
+
+    if (op_mode == BME69X_PARALLEL_MODE)
+    {
+        CHECK((readback.shared_heatr_dur <= heatr_conf.shared_heatr_dur) &&
+              (readback.shared_heatr_dur + 8 > heatr_conf.shared_heatr_dur));
+    }
+
+    CHECK(bme69x_set_op_mode(op_mode, &dev) == BME69X_OK);
+
+    /* Poll faster than the shortest step so that no field is overwritten */
+    poll = bme69x_sim_step_dur(&sim, op_mode, 1) / 2;
+    for (loop = 0; loop < 200; loop++)
+    {
+        dev.delay_us(poll, dev.intf_ptr);
+        CHECK(bme69x_get_data(op_mode, data, &n_data, &dev) >= BME69X_OK);
+        for (i = 0; i < n_data; i++)
+        {
+            CHECK(data[i].meas_index == next_index);
+            CHECK(data[i].gas_index == next_index % 10);
+            CHECK(data[i].res_heat == sim.regs[BME69X_REG_RES_HEAT0 + data[i].gas_index]);
+            next_index++;
+        }
+
+        n_fields += n_data;
+    }
+
+    CHECK(n_fields > 10);
+    CHECK(n_fields + 1 >= sim.n_fields);
+    CHECK(sim.n_overwritten == 0);
+
+    CHECK(bme69x_set_op_mode(BME69X_SLEEP_MODE, &dev) == BME69X_OK);
+    CHECK(sim.mode == BME69X_SLEEP_MODE);
+}
+
+static void test_parallel(void)
+{
+    test_profile(BME69X_PARALLEL_MODE);
+}
+
+static void test_sequential(void)
+{
+    test_profile(BME69X_SEQUENTIAL_MODE);
+}
+
+static void test_soft_reset(void)
+{
+    struct bme69x_conf conf = { 0 };
+    struct bme69x_heatr_conf heatr_conf = { 0 };
+    struct bme69x_conf read_conf = { 0 };
+
+    CHECK(bme69x_init(&dev) == BME69X_OK);
+    test_forced_conf(&conf, &heatr_conf);
+    CHECK(bme69x_set_conf(&conf, &dev) == BME69X_OK);
+    CHECK(bme69x_soft_reset(&dev) == BME69X_OK);
+    bme69x_sim_reset_stats(&sim);
+
+    /* The cached registers are stale after a reset, the configuration is read from the device */
+    CHECK(bme69x_get_conf(&read_conf, &dev) == BME69X_OK);
+    CHECK(sim.n_reads > 0);
+    CHECK(read_conf.os_hum == BME69X_OS_NONE);
+    CHECK(bme69x_set_conf(&conf, &dev) == BME69X_OK);
+    CHECK(sim.regs[BME69X_REG_CTRL_HUM] == BME69X_OS_16X);
+}
+
+static void test_stats(void)
+{
+    struct bme69x_stats stats;
+    struct bme69x_stats snap;
+    struct bme69x_conf conf = { 0 };
+    struct bme69x_heatr_conf heatr_conf = { 0 };
+    struct bme69x_data data = { 0 };
+    uint8_t n_data = 0;
+    uint32_t period;
+    uint32_t reads = 0, writes = 0, bytes_read = 0, bytes_written = 0;
+    uint8_t i;
+
+    CHECK(bme69x_get_stats(&snap, &dev) == BME69X_E_NULL_PTR);
+    dev.stats = &stats;
+    CHECK(bme69x_reset_stats(&dev) == BME69X_OK);
+
+    CHECK(bme69x_init(&dev) == BME69X_OK);
+    test_forced_conf(&conf, &heatr_conf);
+    CHECK(bme69x_set_conf(&conf, &dev) == BME69X_OK);
+    CHECK(bme69x_set_heatr_conf(BME69X_FORCED_MODE, &heatr_conf, &dev) == BME69X_OK);
+    period = bme69x_get_meas_dur(BME69X_FORCED_MODE, &conf, &dev) + (uint32_t)heatr_conf.heatr_dur * 1000;
+    CHECK(bme69x_set_op_mode(BME69X_FORCED_MODE, &dev) == BME69X_OK);
+    dev.delay_us(period, dev.intf_ptr);
+    CHECK(bme69x_get_data(BME69X_FORCED_MODE, &data, &n_data, &dev) == BME69X_OK);
+    CHECK(bme69x_get_stats(&snap, &dev) == BME69X_OK);
+
+    /* The nested soft reset is accounted to init, with its 10 ms wait */
+    CHECK(snap.api[BME69X_STATS_API_INIT].calls == 1);
+    CHECK(snap.api[BME69X_STATS_API_INIT].reads == 6);
+    CHECK(snap.api[BME69X_STATS_API_INIT].writes == 1);
+    CHECK(snap.api[BME69X_STATS_API_INIT].sleep_time_us == BME69X_PERIOD_RESET);
+    CHECK(snap.api[BME69X_STATS_API_SOFT_RESET].calls == 0);
+    CHECK(snap.api[BME69X_STATS_API_SET_CONF].writes == 1);
+    CHECK(snap.api[BME69X_STATS_API_SET_HEATR_CONF].writes == 1);
+    CHECK(snap.api[BME69X_STATS_API_SET_OP_MODE].writes == 1);
+    CHECK(snap.api[BME69X_STATS_API_GET_DATA].calls == 1);
+    CHECK(snap.api[BME69X_STATS_API_GET_DATA].reads == 1);
+    CHECK(snap.api[BME69X_STATS_API_GET_DATA].writes == 0);
+    CHECK(snap.api[BME69X_STATS_API_GET_DATA].bus_time_us > 0);
+
+    /* Everything the bus saw is accounted to some API, nothing else sleeps through the driver */
+    for (i = 0; i < BME69X_STATS_N_API; i++)
+    {
+        reads += snap.api[i].reads;
+        writes += snap.api[i].writes;
+        bytes_read += snap.api[i].bytes_read;
+        bytes_written += snap.api[i].bytes_written;
+        CHECK(snap.api[i].errors == 0);
+    }
+
+    CHECK(reads == sim.n_reads);
+    CHECK(writes == sim.n_writes);
+    CHECK(bytes_read == sim.bytes_read);
+    CHECK(bytes_written == sim.bytes_written);
+
+    CHECK(bme69x_reset_stats(&dev) == BME69X_OK);
+    CHECK(bme69x_get_stats(&snap, &dev) == BME69X_OK);
+    CHECK(snap.api[BME69X_STATS_API_INIT].calls == 0);
+}
+
+static void test_spi(void)
+{
+    struct bme69x_conf conf = { 0 };
+    struct bme69x_heatr_conf heatr_conf = { 0 };
+    struct bme69x_data data = { 0 };
+    const uint8_t addr[3] = { BME69X_REG_RES_HEAT0, BME69X_REG_SOFT_RESET, BME69X_REG_RES_HEAT0 + 1 };
+    const uint8_t val[3] = { 0x11, 0x00, 0x22 };
+    uint8_t calib = 0;
+    uint8_t n_data = 0;
+    uint32_t period;
+    int i;
+
+    sim.spi = 1;
+    bme69x_sim_attach(&sim, &dev);
+    CHECK(bme69x_init(&dev) == BME69X_OK);
+    CHECK(dev.chip_id == BME69X_CHIP_ID);
+    CHECK(dev.calib.par_t1 == 26000);
+    CHECK(dev.calib.par_g2 == -5936);
+
+    /* A write spanning both memory pages is split, each register lands on its own page */
+    calib = sim.regs[BME69X_REG_RES_HEAT0 | 0x80];
+    bme69x_sim_reset_stats(&sim);
+    CHECK(bme69x_set_regs(addr, val, 3, &dev) == BME69X_OK);
+    CHECK(sim.regs[BME69X_REG_RES_HEAT0] == 0x11);
+    CHECK(sim.regs[BME69X_REG_RES_HEAT0 + 1] == 0x22);
+    CHECK(sim.regs[BME69X_REG_RES_HEAT0 | 0x80] == calib);
+
+    /* Two page switches and three data writes, the page register is never read back */
+    CHECK_BUS(0, 5);
+
+    test_forced_conf(&conf, &heatr_conf);
+    CHECK(bme69x_set_conf(&conf, &dev) == BME69X_OK);
+    CHECK(bme69x_set_heatr_conf(BME69X_FORCED_MODE, &heatr_conf, &dev) == BME69X_OK);
+    period = bme69x_get_meas_dur(BME69X_FORCED_MODE, &conf, &dev) + (uint32_t)heatr_conf.heatr_dur * 1000;
+    bme69x_sim_reset_stats(&sim);
+
+    for (i = 0; i < 3; i++)
+    {
+        CHECK(bme69x_set_op_mode(BME69X_FORCED_MODE, &dev) == BME69X_OK);
+        dev.delay_us(period, dev.intf_ptr);
+        CHECK(bme69x_get_data(BME69X_FORCED_MODE, &data, &n_data, &dev) == BME69X_OK);
+
+        /* Control and data registers share a page, a cycle costs what it costs on I2C */
+        CHECK_BUS(1, 1);
+        CHECK(n_data == 1);
+    }
+
+#ifdef BME69X_USE_FPU
+    CHECK((data.temperature > 20) && (data.temperature < 30));
+#else
+    CHECK((data.temperature > 2000) && (data.temperature < 3000));
+#endif
+}
+
+/* Lets the model's gas readings pass the self-test: steps heated below 250 degC read a higher resistance */
+static void test_selftest_heater(void)
+{
+    struct bme69x_heatr_conf heatr_conf = { 0 };
+
+    heatr_conf.enable = BME69X_ENABLE;
+    heatr_conf.heatr_temp = 250;
+    heatr_conf.heatr_dur = 100;
+    CHECK(bme69x_set_heatr_conf(BME69X_FORCED_MODE, &heatr_conf, &dev) == BME69X_OK);
+    sim.res_heat_cold = sim.regs[BME69X_REG_RES_HEAT0];
+}
+
+/* The self-test reconfigures the sensor through a copy of dev, the earlier settings must be written again */
+static void test_selftest_conf(void)
+{
+    struct bme69x_conf conf = { 0 };
+    struct bme69x_heatr_conf heatr_conf = { 0 };
+
+    /* The idac registers are written by the sensor, only the registers of the driver are compared */
+    const uint8_t first = BME69X_REG_RES_HEAT0 - BME69X_REG_IDAC_HEAT0;
+    uint8_t regs[BME69X_LEN_SHADOW];
+
+    CHECK(bme69x_init(&dev) == BME69X_OK);
+    test_selftest_heater();
+    test_forced_conf(&conf, &heatr_conf);
+    CHECK(bme69x_set_conf(&conf, &dev) == BME69X_OK);
+    CHECK(bme69x_set_heatr_conf(BME69X_FORCED_MODE, &heatr_conf, &dev) == BME69X_OK);
+    memcpy(regs, &sim.regs[BME69X_REG_IDAC_HEAT0], BME69X_LEN_SHADOW);
+
+    CHECK(bme69x_selftest_check(&dev) == BME69X_OK);
+    CHECK(memcmp(&regs[first], &sim.regs[BME69X_REG_RES_HEAT0], BME69X_LEN_SHADOW - first) != 0);
+
+    CHECK(bme69x_set_conf(&conf, &dev) == BME69X_OK);
+    CHECK(bme69x_set_heatr_conf(BME69X_FORCED_MODE, &heatr_conf, &dev) == BME69X_OK);
+    CHECK(memcmp(&regs[first], &sim.regs[BME69X_REG_RES_HEAT0], BME69X_LEN_SHADOW - first) == 0);
+    CHECK(memcmp(dev.shadow, &sim.regs[BME69X_REG_IDAC_HEAT0], BME69X_LEN_SHADOW) == 0);
+}
+
+static void test_selftest(void)
+{
+    test_selftest_conf();
+
+    bme69x_sim_init(&sim);
+    sim.bus_hz = TEST_BUS_HZ;
+    sim.spi = 1;
+    bme69x_sim_attach(&sim, &dev);
+    test_selftest_conf();
+
+    /* A heater that draws no current fails on the idac the sensor reports after the first measurement */
+    bme69x_sim_init(&sim);
+    sim.bus_hz = TEST_BUS_HZ;
+    sim.idac = 0;
+    bme69x_sim_attach(&sim, &dev);
+    CHECK(bme69x_init(&dev) == BME69X_OK);
+    test_selftest_heater();
+    CHECK(bme69x_selftest_check(&dev) == BME69X_E_SELF_TEST);
+}
+
+/* Other bits of the SPI memory page register, which a page switch must keep */
+#define TEST_MEM_PAGE_OTHER  UINT8_C(0x01)
+
+/* Register of the model holding the SPI memory page */
+#define TEST_MEM_PAGE_REG  (BME69X_REG_MEM_PAGE & BME69X_SPI_WR_MSK)
+
+/* Runs a test on I2C, then on SPI with the sensor left on the page dev does not expect */
+static void test_both_intf(void (*test)(void))
+{
+    test();
+
+    bme69x_sim_init(&sim);
+    sim.bus_hz = TEST_BUS_HZ;
+    sim.spi = 1;
+    bme69x_sim_attach(&sim, &dev);
+    test();
+}
+
+static void test_calib_snapshot_intf(void)
+{
+    struct bme69x_conf conf = { 0 };
+    struct bme69x_heatr_conf heatr_conf = { 0 };
+    struct bme69x_calib_data calib;
+    struct bme69x_stats stats;
+    struct bme69x_stats snap;
+    uint8_t blob[BME69X_LEN_CALIB_BLOB];
+    uint8_t bad[BME69X_LEN_CALIB_BLOB];
+    uint64_t start_us;
+    uint32_t unique_id = 0;
+
+    CHECK(bme69x_export_calib(blob, &dev) == BME69X_E_DEV_NOT_FOUND);
+    CHECK(bme69x_init(&dev) == BME69X_OK);
+    CHECK(bme69x_get_unique_id(&unique_id, &dev) == BME69X_OK);
+    CHECK(unique_id == UINT32_C(0x5a174269));
+    CHECK(bme69x_export_calib(blob, &dev) == BME69X_OK);
+    CHECK(blob[0] == BME69X_CALIB_BLOB_VERSION);
+    calib = dev.calib;
+
+    /* The sensor keeps its configuration while the host sleeps */
+    test_forced_conf(&conf, &heatr_conf);
+    CHECK(bme69x_set_conf(&conf, &dev) == BME69X_OK);
+
+    /* Warm boot: the unique ID and the control registers, no reset and no wait. On SPI the sensor is
+     * left on the page of the control registers, the page is read first and switched twice */
+    bme69x_sim_attach(&sim, &dev);
+    sim.regs[TEST_MEM_PAGE_REG] |= TEST_MEM_PAGE_OTHER;
+    dev.stats = &stats;
+    CHECK(bme69x_reset_stats(&dev) == BME69X_OK);
+    bme69x_sim_reset_stats(&sim);
+    start_us = sim.now_us;
+    CHECK(bme69x_import_calib(blob, &dev) == BME69X_OK);
+    CHECK_BUS(2 + sim.spi, 2 * sim.spi);
+    CHECK(bme69x_get_stats(&snap, &dev) == BME69X_OK);
+    CHECK(snap.api[BME69X_STATS_API_IMPORT_CALIB].calls == 1);
+    CHECK(snap.api[BME69X_STATS_API_IMPORT_CALIB].reads == 2U + sim.spi);
+    CHECK(snap.api[BME69X_STATS_API_INIT].calls == 0);
+    CHECK(sim.now_us - start_us < 2000);
+    CHECK(dev.chip_id == BME69X_CHIP_ID);
+    CHECK(dev.variant_id == BME690_VARIANT_GAS_HIGH);
+    CHECK(memcmp(&dev.calib, &calib, sizeof(calib)) == 0);
+    CHECK(dev.shadow_valid);
+    CHECK(dev.shadow[BME69X_REG_CTRL_HUM - BME69X_REG_IDAC_HEAT0] == BME69X_OS_16X);
+    CHECK(sim.regs[TEST_MEM_PAGE_REG] & TEST_MEM_PAGE_OTHER);
+
+    /* Corrupt snapshot */
+    memcpy(bad, blob, sizeof(bad));
+    bad[10] ^= 0x01;
+    CHECK(bme69x_import_calib(bad, &dev) == BME69X_E_CALIB_BLOB);
+    CHECK_BUS(0, 0);
+    CHECK(!dev.shadow_valid);
+
+    /* Another sensor */
+    sim.regs[BME69X_REG_UNIQUE_ID + 3]++;
+    CHECK(bme69x_import_calib(blob, &dev) == BME69X_E_DEV_NOT_FOUND);
+    CHECK_BUS(1 + sim.spi, sim.spi);
+}
+
+static void test_calib_snapshot(void)
+{
+    test_both_intf(test_calib_snapshot_intf);
+}
+
+static void test_resume_intf(void)
+{
+    struct bme69x_conf conf = { 0 };
+    struct bme69x_heatr_conf heatr_conf = { 0 };
+    struct bme69x_data data = { 0 };
+    struct bme69x_stats stats;
+    struct bme69x_stats snap;
+    uint8_t state[BME69X_LEN_STATE_BLOB];
+    uint8_t n_data = 0;
+    uint32_t period;
+
+    /* First boot: configure, measure once and save the state before deep sleep */
+    CHECK(bme69x_export_state(state, &dev) == BME69X_E_DEV_NOT_FOUND);
+    CHECK(bme69x_init(&dev) == BME69X_OK);
+    test_forced_conf(&conf, &heatr_conf);
+    CHECK(bme69x_set_conf(&conf, &dev) == BME69X_OK);
+    CHECK(bme69x_set_heatr_conf(BME69X_FORCED_MODE, &heatr_conf, &dev) == BME69X_OK);
+    period = bme69x_get_meas_dur(BME69X_FORCED_MODE, &conf, &dev) + (uint32_t)heatr_conf.heatr_dur * 1000;
+    CHECK(bme69x_set_op_mode(BME69X_FORCED_MODE, &dev) == BME69X_OK);
+    bme69x_sim_advance(&sim, period);
+    CHECK(bme69x_get_data(BME69X_FORCED_MODE, &data, &n_data, &dev) == BME69X_OK);
+    CHECK(bme69x_export_state(state, &dev) == BME69X_OK);
+
+    /* Wake: chip ID, start of the measurement, one field read. On SPI the sensor is still on the page
+     * of the data registers, the page is read first and switched for the chip ID and back */
+    bme69x_sim_attach(&sim, &dev);
+    sim.regs[TEST_MEM_PAGE_REG] |= TEST_MEM_PAGE_OTHER;
+    bme69x_sim_advance(&sim, 60000000);
+    dev.stats = &stats;
+    CHECK(bme69x_reset_stats(&dev) == BME69X_OK);
+    bme69x_sim_reset_stats(&sim);
+    CHECK(bme69x_resume(state, &dev) == BME69X_OK);
+    CHECK_BUS(1 + sim.spi, sim.spi);
+    CHECK(bme69x_get_stats(&snap, &dev) == BME69X_OK);
+    CHECK(snap.api[BME69X_STATS_API_RESUME].calls == 1);
+    CHECK(snap.api[BME69X_STATS_API_RESUME].reads == 1U + sim.spi);
+    CHECK(snap.api[BME69X_STATS_API_INIT].calls == 0);
+    CHECK(bme69x_set_op_mode(BME69X_FORCED_MODE, &dev) == BME69X_OK);
+    CHECK_BUS(0, 1 + sim.spi);
+    CHECK(sim.regs[TEST_MEM_PAGE_REG] & TEST_MEM_PAGE_OTHER);
+    bme69x_sim_advance(&sim, period);
+    n_data = 0;
+    CHECK(bme69x_get_data(BME69X_FORCED_MODE, &data, &n_data, &dev) == BME69X_OK);
+    CHECK_BUS(1, 0);
+    CHECK(n_data == 1);
+    CHECK(data.status & BME69X_GASM_VALID_MSK);
+    CHECK(data.res_heat == sim.regs[BME69X_REG_RES_HEAT0]);
+#ifdef BME69X_USE_FPU
+    CHECK((data.temperature > 20) && (data.temperature < 30));
+#else
+    CHECK((data.temperature > 2000) && (data.temperature < 3000));
+#endif
+
+    /* Corrupt state, then no sensor */
+    state[20] ^= 0x80;
+    CHECK(bme69x_resume(state, &dev) == BME69X_E_CALIB_BLOB);
+    CHECK_BUS(0, 0);
+    state[20] ^= 0x80;
+    sim.regs[BME69X_REG_CHIP_ID] = 0;
+    CHECK(bme69x_resume(state, &dev) == BME69X_E_DEV_NOT_FOUND);
+    CHECK_BUS(1 + sim.spi, sim.spi);
+    CHECK(!dev.shadow_valid);
+}
+
+static void test_resume(void)
+{
+    test_both_intf(test_resume_intf);
+}
+
+/* Brings a model of the shared bus up to the bus time before it is accessed */
+static struct bme69x_sim *bus_sync(void *intf_ptr)
+{
+    struct bme69x_sim *model = (struct bme69x_sim *)intf_ptr;
+
+    if (bus_now_us > model->now_us)
+    {
+        bme69x_sim_advance(model, bus_now_us - model->now_us);
+    }
+
+    return model;
+}
+
+static BME69X_INTF_RET_TYPE bus_read(uint8_t reg_addr, uint8_t *reg_data, uint32_t len, void *intf_ptr)
+{
+    struct bme69x_sim *model = bus_sync(intf_ptr);
+    BME69X_INTF_RET_TYPE rslt = bme69x_sim_read(reg_addr, reg_data, len, model);
+
+    bus_now_us = model->now_us;
+
+    return rslt;
+}
+
+static BME69X_INTF_RET_TYPE bus_write(uint8_t reg_addr, const uint8_t *reg_data, uint32_t len, void *intf_ptr)
+{
+    struct bme69x_sim *model = bus_sync(intf_ptr);
+    BME69X_INTF_RET_TYPE rslt = bme69x_sim_write(reg_addr, reg_data, len, model);
+
+    bus_now_us = model->now_us;
+
+    return rslt;
+}
+
+static void bus_delay_us(uint32_t period, void *intf_ptr)
+{
+    (void)intf_ptr;
+    bus_now_us += period;
+}
+
+static uint64_t bus_get_time_us(void *intf_ptr)
+{
+    (void)intf_ptr;
+
+    return bus_now_us;
+}
+
+static void test_sched_cb(uint8_t sensor, const struct bme69x_data *data, uint64_t time_us, void *arg)
+{
+    uint32_t *n_samples = (uint32_t *)arg;
+
+    CHECK(sensor < TEST_SCHED_N);
+    CHECK(data->status & BME69X_GASM_VALID_MSK);
+    CHECK((time_us <= bus_now_us) && (time_us + 1000 > bus_now_us));
+    n_samples[sensor]++;
+}
+
+/* Aggregate rate in millihertz of n_sensors sensors scheduled for 10 s, with their period checked against it */
+static uint32_t test_sched_rate(uint8_t n_sensors, uint32_t period_us)
+{
+    struct bme69x_conf conf = { 0 };
+    struct bme69x_heatr_conf heatr_conf = { 0 };
+    struct bme69x_sched sched;
+    struct bme69x_sched_sensor sensors[TEST_SCHED_N];
+    uint32_t n_samples[TEST_SCHED_N] = { 0 };
+    uint32_t rate_mhz = 0;
+    uint32_t sensor_mhz;
+    uint8_t i;
+
+    bus_now_us = 0;
+    test_forced_conf(&conf, &heatr_conf);
+    memset(sensors, 0, sizeof(sensors));
+    for (i = 0; i < n_sensors; i++)
+    {
+        bme69x_sim_init(&bus_sim[i]);
+        bus_sim[i].bus_hz = TEST_BUS_HZ;
+        bme69x_sim_attach(&bus_sim[i], &bus_dev[i]);
+        bus_dev[i].read = bus_read;
+        bus_dev[i].write = bus_write;
+        bus_dev[i].delay_us = bus_delay_us;
+        bus_dev[i].get_time_us = bus_get_time_us;
+        CHECK(bme69x_init(&bus_dev[i]) == BME69X_OK);
+        CHECK(bme69x_set_conf(&conf, &bus_dev[i]) == BME69X_OK);
+        CHECK(bme69x_set_heatr_conf(BME69X_FORCED_MODE, &heatr_conf, &bus_dev[i]) == BME69X_OK);
+
+        sensors[i].dev = &bus_dev[i];
+        sensors[i].conf = &conf;
+        sensors[i].heatr_conf = &heatr_conf;
+        sensors[i].period_us = period_us;
+    }
+
+    CHECK(bme69x_sched_init(&sched, sensors, n_sensors, test_sched_cb, n_samples) == BME69X_OK);
+    CHECK(bme69x_sched_run(&sched, 10000000) == BME69X_OK);
+    CHECK(bme69x_sched_get_rate(&sched, BME69X_SCHED_ALL, &rate_mhz) == BME69X_OK);
+    CHECK(bme69x_sched_get_rate(&sched, n_sensors, &sensor_mhz) == BME69X_E_INVALID_LENGTH);
+
+    for (i = 0; i < n_sensors; i++)
+    {
+        CHECK(sensors[i].samples == n_samples[i]);
+        CHECK(sensors[i].errors == 0);
+        CHECK(sensors[i].overruns == 0);
+        CHECK(bus_sim[i].n_overwritten == 0);
+        CHECK(bme69x_sched_get_rate(&sched, i, &sensor_mhz) == BME69X_OK);
+        if (period_us != 0)
+        {
+            /* One sample per period, give or take the first one */
+            CHECK((sensor_mhz <= 1000000000 / period_us + 100) && (sensor_mhz + 100 >= 1000000000 / period_us));
+        }
+    }
+
+    return rate_mhz;
+}
+
+static void test_sched(void)
+{
+    uint32_t one_mhz = test_sched_rate(1, 0);
+    uint32_t all_mhz = test_sched_rate(TEST_SCHED_N, 0);
+
+    printf("  back to back: 1 sensor %.2f samples/s, %d sensors %.2f samples/s\n",
+           one_mhz / 1000.0,
+           TEST_SCHED_N,
+           all_mhz / 1000.0);
+
+    /* Heating overlaps, only the bus accesses are serialised */
+    CHECK((uint64_t)all_mhz * 100 >= (uint64_t)one_mhz * TEST_SCHED_N * 95);
+
+    all_mhz = test_sched_rate(TEST_SCHED_N, 250000);
+    printf("  250 ms period: %d sensors %.2f samples/s\n", TEST_SCHED_N, all_mhz / 1000.0);
+    CHECK((all_mhz <= TEST_SCHED_N * 4000 + 100) && (all_mhz + 1000 >= TEST_SCHED_N * 4000));
+}
+
+/* Steps delivered by the profile engine, and the largest distance of their time to the end of the step in the model
+ * once the engine has seen a whole cycle */
+static uint32_t seq_n_steps;
+static uint64_t seq_max_err_us;
+
+static void test_seq_cb(const struct bme69x_data *data, uint32_t seq, uint64_t time_us, void *arg)
+{
+    uint64_t done_us = sim.done_log[data->meas_index];
+    uint64_t err_us = (time_us > done_us) ? time_us - done_us : done_us - time_us;
+
+    (void)arg;
+
+    /* The model numbers its steps from 0 as well, on 8 bits */
+    CHECK((uint8_t)seq == data->meas_index);
+    CHECK(data->gas_index == seq % 10);
+    CHECK(time_us <= sim.now_us);
+    seq_n_steps++;
+    if ((seq >= 10) && (err_us > seq_max_err_us))
+    {
+        seq_max_err_us = err_us;
+    }
+}
+
+static void test_seq(void)
+{
+    struct bme69x_conf conf = { 0 };
+    struct bme69x_heatr_conf heatr_conf = { 0 };
+    struct bme69x_seq seq;
+    uint16_t temp_prof[10] = { 320, 100, 100, 100, 200, 200, 200, 320, 320, 320 };
+    uint16_t dur_prof[10] = { 100, 40, 200, 60, 100, 100, 100, 100, 100, 100 };
+    uint32_t cycle_us;
+    uint32_t n_fields;
+    uint32_t scale;
+    uint8_t i;
+
+    CHECK(bme69x_init(&dev) == BME69X_OK);
+    test_forced_conf(&conf, &heatr_conf);
+    conf.odr = BME69X_ODR_20_MS;
+    CHECK(bme69x_set_conf(&conf, &dev) == BME69X_OK);
+    heatr_conf.heatr_temp_prof = temp_prof;
+    heatr_conf.heatr_dur_prof = dur_prof;
+    heatr_conf.profile_len = 10;
+    CHECK(bme69x_set_heatr_conf(BME69X_SEQUENTIAL_MODE, &heatr_conf, &dev) == BME69X_OK);
+
+    cycle_us = 20000;
+    for (i = 0; i < 10; i++)
+    {
+        cycle_us += bme69x_sim_step_dur(&sim, BME69X_SEQUENTIAL_MODE, i);
+    }
+
+    /* 30 cycles, 300 steps: meas_index wraps around */
+    seq_n_steps = 0;
+    seq_max_err_us = 0;
+    bme69x_sim_reset_stats(&sim);
+    CHECK(bme69x_seq_start(&seq, test_seq_cb, NULL, &dev) == BME69X_OK);
+    CHECK_BUS(0, 1);
+    CHECK(bme69x_seq_run(&seq, 30 * cycle_us) == BME69X_OK);
+    printf("  30 cycles: %u steps in %u reads, timestamps within %u us\n",
+           (unsigned)seq.samples,
+           (unsigned)seq.polls,
+           (unsigned)seq_max_err_us);
+
+    /* Every step once, read three at a time but for the first reads, which narrow down the timing */
+    CHECK(seq.samples == seq_n_steps);
+    CHECK((seq.samples <= sim.n_fields) && (seq.samples + 3 > sim.n_fields));
+    CHECK(seq.polls <= seq.samples / 3 + 3);
+    CHECK(sim.n_reads == seq.polls);
+    CHECK((seq.lost == 0) && (seq.errors == 0));
+    CHECK(sim.n_overwritten == 0);
+    CHECK(seq_max_err_us < 10);
+
+    /* The host is busy for a whole cycle: the numbering skips the overwritten steps */
+    dev.delay_us(cycle_us, dev.intf_ptr);
+    CHECK(bme69x_seq_run(&seq, 2 * cycle_us) == BME69X_OK);
+    CHECK(seq.lost == sim.n_overwritten);
+    CHECK(seq.lost >= 7);
+    CHECK(seq.samples + seq.lost + 3 > sim.n_fields);
+    CHECK(seq.errors == 0);
+
+    n_fields = sim.n_fields;
+    CHECK(bme69x_set_op_mode(BME69X_SLEEP_MODE, &dev) == BME69X_OK);
+    dev.delay_us(cycle_us, dev.intf_ptr);
+    CHECK(sim.n_fields == n_fields);
+
+    /* A sensor 3 % faster or slower than its datasheet timing: the reads adapt and miss no step */
+    for (scale = 97; scale <= 103; scale += 6)
+    {
+        test_setup();
+        CHECK(bme69x_init(&dev) == BME69X_OK);
+        CHECK(bme69x_set_conf(&conf, &dev) == BME69X_OK);
+        CHECK(bme69x_set_heatr_conf(BME69X_SEQUENTIAL_MODE, &heatr_conf, &dev) == BME69X_OK);
+        CHECK(bme69x_seq_start(&seq, test_seq_cb, NULL, &dev) == BME69X_OK);
+        for (i = 0; i < seq.timing.n_steps; i++)
+        {
+            seq.timing.step_us[i] = seq.timing.step_us[i] * scale / 100;
+        }
+
+        seq_max_err_us = 0;
+        CHECK(bme69x_seq_run(&seq, 30 * cycle_us) == BME69X_OK);
+        printf("  model at %u %%: %u steps in %u reads, timestamps within %u us\n",
+               (unsigned)scale,
+               (unsigned)seq.samples,
+               (unsigned)seq.polls,
+               (unsigned)seq_max_err_us);
+        CHECK((seq.lost == 0) && (seq.errors == 0));
+        CHECK(sim.n_overwritten == 0);
+        CHECK(seq.samples + 3 > sim.n_fields);
+        CHECK(seq.polls <= seq.samples / 3 + 6);
+        CHECK(seq_max_err_us < 3000);
+    }
+}
+
+/* Checks a timing against the step durations of the model, configured for the same mode */
+static void test_timing_check(uint8_t op_mode, const struct bme69x_timing *timing, uint32_t standby_us)
+{
+    uint32_t cycle_us = standby_us;
+    uint8_t i;
+
+    for (i = 0; i < timing->n_steps; i++)
+    {
+        CHECK(timing->step_us[i] == bme69x_sim_step_dur(&sim, op_mode, i));
+        cycle_us += timing->step_us[i];
+    }
+
+    CHECK(timing->standby_us == standby_us);
+    CHECK(timing->cycle_us == cycle_us);
+}
+
+static void test_timing(void)
+{
+    struct bme69x_conf conf = { 0 };
+    struct bme69x_heatr_conf heatr_conf = { 0 };
+    struct bme69x_timing timing;
+    struct bme69x_data data[3];
+    uint16_t temp_prof[10] = { 320, 100, 100, 100, 200, 200, 200, 320, 320, 320 };
+    uint16_t dur_prof[10] = { 1, 63, 64, 65, 150, 600, 1000, 2000, 3000, 4000 };
+    uint16_t mul_prof[10] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+    const uint8_t os[5][3] = {
+        { BME69X_OS_16X, BME69X_OS_1X, BME69X_OS_2X }, { BME69X_OS_NONE, BME69X_OS_NONE, BME69X_OS_1X },
+        { BME69X_OS_16X, BME69X_OS_16X, BME69X_OS_16X }, { BME69X_OS_1X, BME69X_OS_4X, BME69X_OS_8X },
+        { BME69X_OS_2X, BME69X_OS_NONE, BME69X_OS_NONE }
+    };
+    const uint16_t heatr_dur[5] = { 100, 150, 600, 4000, 1 };
+    const uint32_t odr_us[8] = { 590, 62500, 125000, 250000, 500000, 1000000, 10000, 20000 };
+    uint64_t ready_us = 0;
+    uint32_t n_fields;
+    uint8_t meas_index;
+    uint8_t n_data;
+    uint8_t i, j;
+
+    CHECK(bme69x_init(&dev) == BME69X_OK);
+    test_forced_conf(&conf, &heatr_conf);
+
+    /* Forced mode: durations that the heater register cannot hold exactly, and no heating */
+    for (i = 0; i < 5; i++)
+    {
+        conf.os_hum = os[i][0];
+        conf.os_pres = os[i][1];
+        conf.os_temp = os[i][2];
+        conf.filter = (i & 1) ? BME69X_FILTER_SIZE_127 : BME69X_FILTER_OFF;
+        heatr_conf.enable = (i == 4) ? BME69X_DISABLE : BME69X_ENABLE;
+        heatr_conf.heatr_dur = heatr_dur[i];
+        CHECK(bme69x_set_conf(&conf, &dev) == BME69X_OK);
+        CHECK(bme69x_set_heatr_conf(BME69X_FORCED_MODE, &heatr_conf, &dev) == BME69X_OK);
+        bme69x_sim_reset_stats(&sim);
+        CHECK(bme69x_get_timing(BME69X_FORCED_MODE, &conf, &heatr_conf, &timing, &dev) == BME69X_OK);
+        CHECK_BUS(0, 0);
+        CHECK(timing.n_steps == 1);
+        test_timing_check(BME69X_FORCED_MODE, &timing, 0);
+
+        /* The field is there after exactly one cycle and not a microsecond earlier */
+        CHECK(bme69x_trigger_forced(&conf, &heatr_conf, &ready_us, &dev) == BME69X_OK);
+        CHECK(ready_us == sim.done_us);
+        bme69x_sim_advance(&sim, ready_us - 1 - sim.now_us);
+        CHECK(sim.mode == BME69X_FORCED_MODE);
+        bme69x_sim_advance(&sim, 1);
+        CHECK(sim.mode == BME69X_SLEEP_MODE);
+        CHECK(bme69x_get_data(BME69X_FORCED_MODE, data, &n_data, &dev) == BME69X_OK);
+        CHECK(n_data == 1);
+    }
+
+    test_forced_conf(&conf, &heatr_conf);
+    heatr_conf.heatr_temp_prof = temp_prof;
+    heatr_conf.profile_len = 10;
+
+    /* Sequential mode, with every ODR standby and without */
+    heatr_conf.heatr_dur_prof = dur_prof;
+    for (j = BME69X_ODR_0_59_MS; j <= BME69X_ODR_NONE; j++)
+    {
+        conf.odr = j;
+        CHECK(bme69x_set_conf(&conf, &dev) == BME69X_OK);
+        CHECK(bme69x_set_heatr_conf(BME69X_SEQUENTIAL_MODE, &heatr_conf, &dev) == BME69X_OK);
+        CHECK(bme69x_get_timing(BME69X_SEQUENTIAL_MODE, &conf, &heatr_conf, &timing, &dev) == BME69X_OK);
+        CHECK(timing.n_steps == 10);
+        test_timing_check(BME69X_SEQUENTIAL_MODE, &timing, (j == BME69X_ODR_NONE) ? 0 : odr_us[j]);
+    }
+
+    /* The model's cycles last as long as predicted */
+    conf.odr = BME69X_ODR_20_MS;
+    heatr_conf.profile_len = 3;
+    CHECK(bme69x_set_conf(&conf, &dev) == BME69X_OK);
+    CHECK(bme69x_set_heatr_conf(BME69X_SEQUENTIAL_MODE, &heatr_conf, &dev) == BME69X_OK);
+    CHECK(bme69x_get_timing(BME69X_SEQUENTIAL_MODE, &conf, &heatr_conf, &timing, &dev) == BME69X_OK);
+    test_timing_check(BME69X_SEQUENTIAL_MODE, &timing, 20000);
+    n_fields = sim.n_fields;
+    meas_index = sim.meas_index;
+    CHECK(bme69x_set_op_mode(BME69X_SEQUENTIAL_MODE, &dev) == BME69X_OK);
+    dev.delay_us(4 * timing.cycle_us, dev.intf_ptr);
+    n_fields = sim.n_fields - n_fields;
+    CHECK(n_fields >= 9);
+    for (i = 3; i < n_fields; i++)
+    {
+        CHECK(sim.done_log[(uint8_t)(meas_index + i)] - sim.done_log[(uint8_t)(meas_index + i - 3)] ==
+              timing.cycle_us);
+    }
+
+    CHECK(bme69x_set_op_mode(BME69X_SLEEP_MODE, &dev) == BME69X_OK);
+
+    /* Parallel mode, a shared heater duration that the register rounds */
+    conf.odr = BME69X_ODR_NONE;
+    heatr_conf.profile_len = 10;
+    heatr_conf.heatr_dur_prof = mul_prof;
+    heatr_conf.shared_heatr_dur = 130;
+    CHECK(bme69x_set_conf(&conf, &dev) == BME69X_OK);
+    CHECK(bme69x_set_heatr_conf(BME69X_PARALLEL_MODE, &heatr_conf, &dev) == BME69X_OK);
+    CHECK(bme69x_get_timing(BME69X_PARALLEL_MODE, &conf, &heatr_conf, &timing, &dev) == BME69X_OK);
+    CHECK(timing.n_steps == 10);
+    test_timing_check(BME69X_PARALLEL_MODE, &timing, 0);
+
+    CHECK(bme69x_get_timing(BME69X_SLEEP_MODE, &conf, &heatr_conf, &timing, &dev) == BME69X_W_DEFINE_OP_MODE);
+    heatr_conf.profile_len = 11;
+    CHECK(bme69x_get_timing(BME69X_PARALLEL_MODE, &conf, &heatr_conf, &timing, &dev) == BME69X_E_INVALID_LENGTH);
+}
+
+/*! Recursive lock of the lock test: nesting depth, takes, and bus accesses made without the lock */
+static int lock_depth;
+static uint32_t lock_takes;
+static uint32_t lock_unlocked_io;
+
+static void test_lock_take(void *intf_ptr)
+{
+    (void)intf_ptr;
+    lock_depth++;
+    lock_takes++;
+}
+
+static void test_lock_give(void *intf_ptr)
+{
+    (void)intf_ptr;
+    lock_depth--;
+}
+
+static BME69X_INTF_RET_TYPE test_lock_read(uint8_t reg_addr, uint8_t *reg_data, uint32_t len, void *intf_ptr)
+{
+    lock_unlocked_io += (lock_depth == 0);
+
+    return bme69x_sim_read(reg_addr, reg_data, len, intf_ptr);
+}
+
+static BME69X_INTF_RET_TYPE test_lock_write(uint8_t reg_addr, const uint8_t *reg_data, uint32_t len, void *intf_ptr)
+{
+    lock_unlocked_io += (lock_depth == 0);
+
+    return bme69x_sim_write(reg_addr, reg_data, len, intf_ptr);
+}
+
+static void test_lock(void)
+{
+    struct bme69x_conf conf = { 0 };
+    struct bme69x_heatr_conf heatr_conf = { 0 };
+    struct bme69x_latest latest;
+    struct bme69x_data data[3];
+    struct bme69x_data newest = { 0 };
+    struct bme69x_seq seq;
+    uint16_t temp_prof[10] = { 320, 100, 100, 100, 200, 200, 200, 320, 320, 320 };
+    uint16_t mul_prof[10] = { 5, 2, 10, 30, 5, 5, 5, 5, 5, 5 };
+    uint8_t state[BME69X_LEN_STATE_BLOB];
+    uint64_t ready_us = 0;
+    uint64_t time_us = 0;
+    uint32_t count = 0;
+    uint8_t n_data = 0;
+    uint8_t i;
+
+    memset(&latest, 0, sizeof(latest));
+    dev.lock = test_lock_take;
+    dev.unlock = test_lock_give;
+    dev.read = test_lock_read;
+    dev.write = test_lock_write;
+    dev.latest = &latest;
+    lock_depth = 0;
+    lock_takes = 0;
+    lock_unlocked_io = 0;
+
+    /* No sample before the first read */
+    CHECK(bme69x_get_latest(&newest, &count, &time_us, &dev) == BME69X_W_NO_NEW_DATA);
+    CHECK(lock_takes == 0);
+
+    /* Every bus access is made holding the lock, which is given back as often as it was taken */
+    CHECK(bme69x_init(&dev) == BME69X_OK);
+    test_forced_conf(&conf, &heatr_conf);
+    CHECK(bme69x_set_conf(&conf, &dev) == BME69X_OK);
+    CHECK(bme69x_set_heatr_conf(BME69X_FORCED_MODE, &heatr_conf, &dev) == BME69X_OK);
+    CHECK(bme69x_trigger_forced(&conf, &heatr_conf, &ready_us, &dev) == BME69X_OK);
+    bme69x_sim_advance(&sim, ready_us - sim.now_us);
+    CHECK(bme69x_get_data(BME69X_FORCED_MODE, data, &n_data, &dev) == BME69X_OK);
+    CHECK(bme69x_export_state(state, &dev) == BME69X_OK);
+    CHECK(lock_depth == 0);
+    CHECK(lock_takes > 0);
+
+    /* The newest sample is copied without taking the lock */
+    lock_takes = 0;
+    CHECK(bme69x_get_latest(&newest, &count, &time_us, &dev) == BME69X_OK);
+    CHECK(lock_takes == 0);
+    CHECK(count == 1);
+    CHECK(time_us == sim.now_us);
+    CHECK(memcmp(&newest, &data[0], sizeof(newest)) == 0);
+
+    /* The non-blocking forced path publishes as well */
+    CHECK(bme69x_trigger_forced(&conf, &heatr_conf, &ready_us, &dev) == BME69X_OK);
+    bme69x_sim_advance(&sim, ready_us - sim.now_us);
+    CHECK(bme69x_try_collect(data, &n_data, &dev) == BME69X_OK);
+    CHECK(n_data == 1);
+    CHECK(bme69x_get_latest(&newest, &count, &time_us, &dev) == BME69X_OK);
+    CHECK(count == 2);
+    CHECK(time_us == sim.now_us);
+    CHECK(memcmp(&newest, &data[0], sizeof(newest)) == 0);
+
+    /* In parallel mode the newest of the fields read is kept */
+    heatr_conf.heatr_temp_prof = temp_prof;
+    heatr_conf.heatr_dur_prof = mul_prof;
+    heatr_conf.profile_len = 10;
+    heatr_conf.shared_heatr_dur = 100;
+    CHECK(bme69x_set_heatr_conf(BME69X_PARALLEL_MODE, &heatr_conf, &dev) == BME69X_OK);
+    CHECK(bme69x_set_op_mode(BME69X_PARALLEL_MODE, &dev) == BME69X_OK);
+    for (i = 0; i < 5; i++)
+    {
+        dev.delay_us(bme69x_sim_step_dur(&sim, BME69X_PARALLEL_MODE, 1) * 3 / 2, dev.intf_ptr);
+        if (bme69x_get_data(BME69X_PARALLEL_MODE, data, &n_data, &dev) == BME69X_OK)
+        {
+            CHECK(bme69x_get_latest(&newest, NULL, NULL, &dev) == BME69X_OK);
+            CHECK(newest.meas_index == data[n_data - 1].meas_index);
+        }
+    }
+
+    CHECK(bme69x_get_latest(&newest, &count, NULL, &dev) == BME69X_OK);
+    CHECK(count > 1);
+
+    /* The sequential profile engine holds the lock while it reads and starts the profile */
+    CHECK(bme69x_set_op_mode(BME69X_SLEEP_MODE, &dev) == BME69X_OK);
+    heatr_conf.heatr_dur_prof = temp_prof;
+    CHECK(bme69x_set_heatr_conf(BME69X_SEQUENTIAL_MODE, &heatr_conf, &dev) == BME69X_OK);
+    CHECK(bme69x_seq_start(&seq, test_seq_cb, NULL, &dev) == BME69X_OK);
+    CHECK(bme69x_set_op_mode(BME69X_SLEEP_MODE, &dev) == BME69X_OK);
+
+    /* The self-test works on a copy of the device, under the lock of the device. The gas readings of the
+     * model do not pass it, only the locking is checked */
+    (void)bme69x_selftest_check(&dev);
+    CHECK(lock_depth == 0);
+    CHECK(lock_unlocked_io == 0);
+}
+
+static void run(const char *name, void (*test)(void))
+{
+    int failed = test_failed;
+
+    test_setup();
+    test();
+    printf("%-24s %s (%.1f ms virtual time)\n",
+           name,
+           (test_failed == failed) ? "ok" : "FAIL",
+           (double)sim.now_us / 1000.0);
+}
+
+int main(void)
+{
+    run("init", test_init);
+    run("forced", test_forced);
+    run("forced_nonblocking", test_forced_nonblocking);
+    run("parallel", test_parallel);
+    run("sequential", test_sequential);
+    run("soft_reset", test_soft_reset);
+    run("stats", test_stats);
+    run("spi", test_spi);
+    run("selftest", test_selftest);
+    run("calib_snapshot", test_calib_snapshot);
+    run("resume", test_resume);
+    run("sched", test_sched);
+    run("seq", test_seq);
+    run("timing", test_timing);
+    run("lock", test_lock);
+
+    printf("%s\n", test_failed ? "FAILED" : "PASSED");
+
+    return test_failed != 0;
+}
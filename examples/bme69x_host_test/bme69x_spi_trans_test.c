@@ -0,0 +1,77 @@
+/*
+ * Checks the SPI transactions of bme69x_i2c_helper.c against the rules spi_master applies
+ * to a full duplex device before it queues a transaction.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "bme69x_spi_trans.h"
+
+static int test_failed;
+
+#define CHECK(cond)                                                    \
+    do                                                                 \
+    {                                                                  \
+        if (!(cond))                                                   \
+        {                                                              \
+            printf("  %s:%d: CHECK(%s) failed (len %u)\n", __FILE__, __LINE__, #cond, (unsigned)len); \
+            test_failed++;                                             \
+        }                                                              \
+    } while (0)
+
+/* Full duplex checks of spi_master: a receive phase no longer than the transmit phase, data in one place */
+static bool full_duplex_valid(const spi_transaction_t *trans)
+{
+    size_t rxlength = trans->rxlength ? trans->rxlength : trans->length;
+    bool rx_inline = (trans->flags & SPI_TRANS_USE_RXDATA) != 0;
+    bool tx_inline = (trans->flags & SPI_TRANS_USE_TXDATA) != 0;
+
+    if (rxlength > trans->length)
+    {
+        return false;
+    }
+
+    if ((rx_inline && (rxlength > 32)) || (tx_inline && (trans->length > 32)))
+    {
+        return false;
+    }
+
+    return true;
+}
+
+int main(void)
+{
+    uint8_t data[64] = { 0 };
+    spi_transaction_t trans;
+
+    for (uint32_t len = 1; len <= sizeof(data); len++)
+    {
+        bme69x_spi_read_trans(&trans, 0x80 | 0x1d, data, len);
+        CHECK(full_duplex_valid(&trans));
+        CHECK(trans.addr == (0x80 | 0x1d));
+        CHECK(trans.length == len * 8);
+        CHECK((trans.rxlength == 0) || (trans.rxlength == len * 8));
+        if (len <= sizeof(trans.rx_data))
+        {
+            CHECK(trans.flags == SPI_TRANS_USE_RXDATA);
+        }
+        else
+        {
+            CHECK(trans.flags == 0);
+            CHECK(trans.rx_buffer == data);
+        }
+
+        bme69x_spi_write_trans(&trans, 0x74, data, len);
+        CHECK(full_duplex_valid(&trans));
+        CHECK(trans.addr == 0x74);
+        CHECK(trans.length == len * 8);
+        CHECK(trans.rxlength == 0);
+        CHECK(trans.flags == 0);
+        CHECK(trans.tx_buffer == data);
+    }
+
+    printf("spi_trans %s\n", test_failed ? "FAILED" : "PASSED");
+
+    return test_failed != 0;
+}
@@ -0,0 +1,90 @@
+/*
+ * Checks how the stream of bme69x_stream.c tells new fields from fields it already pushed,
+ * on the meas_index sequences that successive parallel mode polls return.
+ */
+
+#include <stdio.h>
+
+#include "bme69x_stream_index.h"
+
+static int test_failed;
+
+#define CHECK(cond)                                                    \
+    do                                                                 \
+    {                                                                  \
+        if (!(cond))                                                   \
+        {                                                              \
+            printf("  %s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            test_failed++;                                             \
+        }                                                              \
+    } while (0)
+
+/* Push rule of the reader task: fields behind or at the last one are skipped, gaps are lost fields */
+struct stream_model
+{
+    int started;
+    uint8_t last_index;
+    uint32_t seq;
+    uint32_t samples;
+    uint32_t lost;
+    uint32_t pushed[16];
+};
+
+static void model_poll(struct stream_model *stream, const uint8_t *meas_index, size_t n_fields)
+{
+    uint8_t delta;
+
+    for (size_t i = 0; i < n_fields; i++)
+    {
+        delta = 1;
+        if (stream->started)
+        {
+            delta = bme69x_stream_index_delta(stream->last_index, meas_index[i]);
+            if (delta == 0)
+            {
+                continue;
+            }
+
+            stream->lost += delta - 1U;
+        }
+
+        stream->started = 1;
+        stream->last_index = meas_index[i];
+        stream->seq += delta;
+        stream->pushed[stream->samples++] = stream->seq;
+    }
+}
+
+int main(void)
+{
+    struct stream_model stream = { 0 };
+
+    CHECK(bme69x_stream_index_delta(10, 11) == 1);
+    CHECK(bme69x_stream_index_delta(10, 13) == 3);
+    CHECK(bme69x_stream_index_delta(255, 0) == 1);
+    CHECK(bme69x_stream_index_delta(250, 4) == 10);
+    CHECK(bme69x_stream_index_delta(10, 137) == 127);
+    CHECK(bme69x_stream_index_delta(10, 10) == 0);
+    CHECK(bme69x_stream_index_delta(10, 9) == 0);
+    CHECK(bme69x_stream_index_delta(0, 254) == 0);
+
+    /* Two new fields, then the older one again, then it again next to a new one */
+    model_poll(&stream, (const uint8_t[]){ 254, 255 }, 2);
+    model_poll(&stream, (const uint8_t[]){ 254 }, 1);
+    model_poll(&stream, (const uint8_t[]){ 255, 0 }, 2);
+    model_poll(&stream, (const uint8_t[]){ 0 }, 1);
+
+    /* One field overwritten in the sensor */
+    model_poll(&stream, (const uint8_t[]){ 2 }, 1);
+
+    CHECK(stream.samples == 4);
+    CHECK(stream.lost == 1);
+    CHECK(stream.pushed[0] == 1);
+    CHECK(stream.pushed[1] == 2);
+    CHECK(stream.pushed[2] == 3);
+    CHECK(stream.pushed[3] == 5);
+
+    printf("stream_index %s\n", test_failed ? "FAILED" : "PASSED");
+
+    return test_failed != 0;
+}
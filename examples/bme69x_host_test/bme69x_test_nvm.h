@@ -0,0 +1,90 @@
+/*
+ * Calibration NVM images for the host tests, served through a read-only interface so that
+ * the driver's own get_calib_data parses them. Include after bme69x.c.
+ */
+
+#ifndef BME69X_TEST_NVM_H_
+#define BME69X_TEST_NVM_H_
+
+/*! Calibration NVM images in driver order: 0x8a (23), 0xe1 (14), 0x00 (5) */
+static const uint8_t test_nvm_coeff[][BME69X_LEN_COEFF_ALL] = {
+    {
+        0x84, 0x67, 0x03, 0x00, 0x50, 0x44, 0xb0, 0x3f, 0x1e, 0xf6, 0xd4, 0x30, 0x2c, 0x01, 0x1a, 0x02,
+        0x00, 0x00, 0x48, 0x0d, 0x1c, 0xf8, 0x00,
+        0x12, 0xc7, 0x2b, 0xfb, 0x0a, 0x1c, 0x3c, 0x00, 0x90, 0x65, 0xd0, 0xe8, 0xe2, 0x12,
+        0x28, 0x00, 0x10, 0x00, 0x10
+    },
+    {
+        0x10, 0x69, 0xfd, 0x00, 0x38, 0x43, 0xe8, 0x3f, 0x07, 0xfa, 0xa5, 0x30, 0x01, 0x03, 0x0e, 0xfe,
+        0x00, 0x00, 0x2c, 0x0e, 0x10, 0x04, 0x00,
+        0x3e, 0xc2, 0x2a, 0x00, 0x2d, 0x14, 0x78, 0x00, 0x2c, 0x66, 0x8a, 0xe9, 0xed, 0x12,
+        0x31, 0x00, 0x20, 0x00, 0xf0
+    }
+};
+
+static const uint8_t *test_nvm;
+
+static BME69X_INTF_RET_TYPE test_nvm_read(uint8_t reg_addr, uint8_t *reg_data, uint32_t len, void *intf_ptr)
+{
+    uint32_t i;
+    uint8_t reg;
+
+    (void)intf_ptr;
+
+    for (i = 0; i < len; i++)
+    {
+        reg = (uint8_t)(reg_addr + i);
+        if ((reg >= BME69X_REG_COEFF1) && (reg < BME69X_REG_COEFF1 + BME69X_LEN_COEFF1))
+        {
+            reg_data[i] = test_nvm[reg - BME69X_REG_COEFF1];
+        }
+        else if ((reg >= BME69X_REG_COEFF2) && (reg < BME69X_REG_COEFF2 + BME69X_LEN_COEFF2))
+        {
+            reg_data[i] = test_nvm[BME69X_LEN_COEFF1 + reg - BME69X_REG_COEFF2];
+        }
+        else if (reg < BME69X_REG_COEFF3 + BME69X_LEN_COEFF3)
+        {
+            reg_data[i] = test_nvm[BME69X_LEN_COEFF1 + BME69X_LEN_COEFF2 + reg];
+        }
+        else
+        {
+            reg_data[i] = 0;
+        }
+    }
+
+    return BME69X_INTF_RET_SUCCESS;
+}
+
+static BME69X_INTF_RET_TYPE test_nvm_write(uint8_t reg_addr, const uint8_t *reg_data, uint32_t len, void *intf_ptr)
+{
+    (void)reg_addr;
+    (void)reg_data;
+    (void)len;
+    (void)intf_ptr;
+
+    return BME69X_INTF_RET_SUCCESS;
+}
+
+static void test_nvm_delay_us(uint32_t period, void *intf_ptr)
+{
+    (void)period;
+    (void)intf_ptr;
+}
+
+/*! Number of calibration images */
+#define TEST_NVM_COUNT  (sizeof(test_nvm_coeff) / sizeof(test_nvm_coeff[0]))
+
+/* Loads the calibration of an NVM image into a zeroed device */
+static int8_t test_nvm_calib(struct bme69x_dev *dev, const uint8_t *nvm)
+{
+    test_nvm = nvm;
+    dev->intf = BME69X_I2C_INTF;
+    dev->read = test_nvm_read;
+    dev->write = test_nvm_write;
+    dev->delay_us = test_nvm_delay_us;
+    dev->amb_temp = 25;
+
+    return get_calib_data(dev);
+}
+
+#endif /* BME69X_TEST_NVM_H_ */
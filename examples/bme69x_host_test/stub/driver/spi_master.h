@@ -0,0 +1,32 @@
+/*
+ * The parts of the ESP-IDF spi_master.h used by bme69x_spi_trans.h, so that the
+ * transaction setup can be checked on the host. Same members as the IDF type.
+ */
+
+#ifndef SPI_MASTER_H
+#define SPI_MASTER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SPI_TRANS_USE_RXDATA  (1 << 2)
+#define SPI_TRANS_USE_TXDATA  (1 << 3)
+
+typedef struct {
+    uint32_t flags;
+    uint16_t cmd;
+    uint64_t addr;
+    size_t length;
+    size_t rxlength;
+    void *user;
+    union {
+        const void *tx_buffer;
+        uint8_t tx_data[4];
+    };
+    union {
+        void *rx_buffer;
+        uint8_t rx_data[4];
+    };
+} spi_transaction_t;
+
+#endif /* SPI_MASTER_H */